@@ -1,54 +1,2178 @@
+// Item hooks for ImGuiEx::UiDriver, only built into test builds
+#ifdef IMGUI_EX_UI_DRIVER
+#define IMGUI_ENABLE_TEST_ENGINE
+#endif
 #include <imgui/imgui.cpp>
 #include <imgui/imgui_draw.cpp>
 #include <imgui/imgui_tables.cpp>
 #include <imgui/imgui_widgets.cpp>
 
-#include <imgui/backends/imgui_impl_dx11.cpp>
-#include <imgui/backends/imgui_impl_win32.cpp>
+#include <imgui/backends/imgui_impl_dx11.cpp>
+#include <imgui/backends/imgui_impl_win32.cpp>
+
+#include <d3d11.h>
+#include <dxgi1_5.h>
+#include <dwmapi.h>
+#include <shellapi.h>
+#pragma comment(lib, "D3D11.lib")
+#pragma comment(lib, "dwmapi.lib")
+#pragma comment(lib, "shell32.lib")
+
+#define IMGUI_EX_CPP
+#include <imgui_ex/imgui_ex_win32.h>
+
+// Dear ImGui: standalone example application for DirectX 11
+// If you are new to Dear ImGui, read documentation from the docs/ folder + read the top of imgui.cpp.
+// Read online: https://github.com/ocornut/imgui/tree/master/docs
+
+#include <tchar.h>
+#include <chrono>
+#include <limits>
+
+#ifdef IMGUI_EX_UI_DRIVER
+// Test engine hooks, only items of a context driven by ImGuiEx::UiDriver are reported
+void ImGuiTestEngineHook_ItemAdd(ImGuiContext* ctx, ImGuiID id, const ImRect& bb, const ImGuiLastItemData* item_data)
+{
+    if (ctx->TestEngine != nullptr)
+        ((ImGuiEx::UiDriver*)ctx->TestEngine)->ItemAdd(id, bb);
+}
+
+void ImGuiTestEngineHook_ItemInfo(ImGuiContext* ctx, ImGuiID id, const char* label, ImGuiItemStatusFlags flags)
+{
+    if (ctx->TestEngine != nullptr)
+        ((ImGuiEx::UiDriver*)ctx->TestEngine)->ItemInfo(id, label);
+}
+
+void ImGuiTestEngineHook_Log(ImGuiContext* ctx, const char* fmt, ...)
+{
+}
+
+const char* ImGuiTestEngine_FindItemDebugLabel(ImGuiContext* ctx, ImGuiID id)
+{
+    return nullptr;
+}
+#endif
+
+static bool gs_exit_application = false;
+
+static bool gs_input_coalescing = true;
+static ImGuiEx::internal::InputCoalescer gs_input_coalescer;
+
+static ImGuiEx::internal::FrameArena gs_frame_arena;
+
+#ifdef IMGUI_EX_MEMORY_STATS
+// Every ImGui allocation carries this header, live blocks are linked for the leak report
+struct MemoryBlock {
+    MemoryBlock* prev;
+    MemoryBlock* next;
+    uint64_t magic;
+    uint64_t frame;
+    size_t size;
+    ImGuiEx::MemoryTag tag;
+};
+
+static const size_t kMemoryHeaderSize = (sizeof(MemoryBlock) + 15) & ~(size_t)15;
+static const uint64_t kMemoryMagic = 0x494d4755494d454dull;
+
+static std::mutex gs_memory_mutex;
+static MemoryBlock gs_memory_live = { &gs_memory_live, &gs_memory_live };
+static ImGuiEx::MemoryTag gs_memory_tag = ImGuiEx::MemoryTag_Core;
+static ImGuiEx::MemoryStats gs_memory_current = {};
+static ImGuiEx::MemoryStats gs_memory_last = {};
+
+static void* MemoryAlloc(size_t size, void* user_data)
+{
+    (void)user_data;
+    auto block = (MemoryBlock*)malloc(kMemoryHeaderSize + size);
+    if (block == nullptr)
+        return nullptr;
+    std::lock_guard<std::mutex> lock(gs_memory_mutex);
+    block->magic = kMemoryMagic;
+    block->frame = gs_memory_current.frame;
+    block->size = size;
+    block->tag = gs_memory_tag;
+    block->prev = &gs_memory_live;
+    block->next = gs_memory_live.next;
+    gs_memory_live.next->prev = block;
+    gs_memory_live.next = block;
+
+    ImGuiEx::MemoryTagStats& stats = gs_memory_current.tags[block->tag];
+    stats.frame_allocations++;
+    stats.frame_bytes += size;
+    stats.live_allocations++;
+    stats.live_bytes += size;
+    stats.peak_live_bytes = (std::max)(stats.peak_live_bytes, stats.live_bytes);
+    return (char*)block + kMemoryHeaderSize;
+}
+
+static void MemoryFree(void* ptr, void* user_data)
+{
+    (void)user_data;
+    if (ptr == nullptr)
+        return;
+    auto block = (MemoryBlock*)((char*)ptr - kMemoryHeaderSize);
+    // gs_memory_hooks installs the hooks before anything allocates through ImGui, every block has a header
+    IM_ASSERT(block->magic == kMemoryMagic && "Block was not allocated by MemoryAlloc");
+    std::lock_guard<std::mutex> lock(gs_memory_mutex);
+    block->magic = 0;
+    block->prev->next = block->next;
+    block->next->prev = block->prev;
+
+    ImGuiEx::MemoryTagStats& stats = gs_memory_current.tags[block->tag];
+    stats.frame_frees++;
+    stats.live_allocations--;
+    stats.live_bytes -= block->size;
+    free(block);
+}
+
+static void EndMemoryFrame()
+{
+    std::lock_guard<std::mutex> lock(gs_memory_mutex);
+    gs_memory_last = gs_memory_current;
+    gs_memory_last.enabled = true;
+    gs_memory_current.frame++;
+    for (auto& stats : gs_memory_current.tags)
+    {
+        stats.frame_allocations = 0;
+        stats.frame_frees = 0;
+        stats.frame_bytes = 0;
+    }
+}
+
+// Widget blocks belong to widgets that live until static destruction, they are reported apart from the rest
+static void ReportMemoryLeaks(bool widgets)
+{
+    auto leaks = ImGuiEx::GetMemoryLeaks();
+    leaks.erase(std::remove_if(leaks.begin(), leaks.end(), [&](const ImGuiEx::MemoryLeak& leak) {
+        return (leak.tag == ImGuiEx::MemoryTag_Widgets) != widgets;
+    }), leaks.end());
+    char text[256];
+    size_t bytes = 0;
+    for (size_t i = 0; i < leaks.size(); i++)
+    {
+        bytes += leaks[i].size;
+        if (i < 32)
+        {
+            snprintf(text, sizeof(text), "ImGuiEx: leaked %zu bytes (%s), allocated in frame %llu\n", leaks[i].size, ImGuiEx::GetMemoryTagName(leaks[i].tag), (unsigned long long)leaks[i].frame);
+            ::OutputDebugStringA(text);
+        }
+    }
+    if (!leaks.empty())
+    {
+        snprintf(text, sizeof(text), "ImGuiEx: %zu allocations (%zu bytes) leaked\n", leaks.size(), bytes);
+        ::OutputDebugStringA(text);
+    }
+}
+
+// Installed during static initialization, before any ImGui allocation, so MemoryFree only ever sees its own blocks.
+// Destroyed after the static widgets constructed later, which is when their blocks have to be gone too.
+struct MemoryHooks
+{
+    MemoryHooks()
+    {
+        IM_ASSERT(ImGui::GetCurrentContext() == nullptr);
+        ImGui::SetAllocatorFunctions(MemoryAlloc, MemoryFree);
+    }
+
+    ~MemoryHooks()
+    {
+        ReportMemoryLeaks(true);
+    }
+};
+
+static MemoryHooks gs_memory_hooks;
+#endif
+
+
+namespace ImGuiEx {
+
+void ExitApplication() {
+    gs_exit_application = true;
+}
+
+void SlowDown() {
+    // d3d11֡ķSleepȻ
+    Sleep(10);
+}
+
+void SetInputCoalescing(bool enable) {
+    gs_input_coalescing = enable;
+}
+
+InputStats GetInputStats() {
+    return gs_input_coalescer.GetStats();
+}
+
+internal::WorkerPool& GetWorkerPool() {
+    // Leave one core to the UI thread
+    static internal::WorkerPool pool(std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 1);
+    return pool;
+}
+
+StateRegistry& GetStateRegistry() {
+    static StateRegistry registry;
+    return registry;
+}
+
+internal::FrameArena& GetFrameArena() {
+    return gs_frame_arena;
+}
+
+FrameArenaStats GetFrameArenaStats() {
+    return gs_frame_arena.GetStats();
+}
+
+const char* FrameFormat(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    const char* text = gs_frame_arena.FormatV(fmt, args);
+    va_end(args);
+    return text;
+}
+
+const char* FrameString(std::string_view text) {
+    return gs_frame_arena.CopyString(text);
+}
+
+MemoryTag SetMemoryTag(MemoryTag tag) {
+#ifdef IMGUI_EX_MEMORY_STATS
+    std::lock_guard<std::mutex> lock(gs_memory_mutex);
+    const MemoryTag previous = gs_memory_tag;
+    gs_memory_tag = tag;
+    return previous;
+#else
+    return tag;
+#endif
+}
+
+const char* GetMemoryTagName(MemoryTag tag) {
+    static const char* names[MemoryTag_COUNT] = { "ImGui core", "Draw lists", "ImGuiEx widgets", "Fonts" };
+    return tag >= 0 && tag < MemoryTag_COUNT ? names[tag] : "";
+}
+
+MemoryStats GetMemoryStats() {
+#ifdef IMGUI_EX_MEMORY_STATS
+    std::lock_guard<std::mutex> lock(gs_memory_mutex);
+    return gs_memory_last;
+#else
+    return MemoryStats{};
+#endif
+}
+
+std::vector<MemoryLeak> GetMemoryLeaks() {
+    std::vector<MemoryLeak> leaks;
+#ifdef IMGUI_EX_MEMORY_STATS
+    std::lock_guard<std::mutex> lock(gs_memory_mutex);
+    for (MemoryBlock* block = gs_memory_live.next; block != &gs_memory_live; block = block->next) {
+        leaks.push_back({ block->tag, block->size, block->frame });
+    }
+#endif
+    return leaks;
+}
+
+internal::Profiler& GetProfiler() {
+    static internal::Profiler profiler;
+    return profiler;
+}
+
+std::vector<ProfileEntry> GetProfileEntries() {
+    return GetProfiler().GetEntries();
+}
+
+bool ExportFlameGraph(const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    const std::string folded = GetProfiler().GetFoldedStacks();
+    const bool written = fwrite(folded.data(), 1, folded.size(), file) == folded.size();
+    fclose(file);
+    return written;
+}
+
+void ShowProfilerWindow(bool* open) {
+    if (!ImGui::Begin("ImGuiEx Profiler", open)) {
+        ImGui::End();
+        return;
+    }
+#ifndef IMGUI_EX_PROFILER
+    ImGui::TextDisabled("Build with IMGUI_EX_PROFILER to time widgets");
+#else
+    static bool top_level_only = false;
+    static char status[128] = "";
+    ImGui::Text("%llu frames", (unsigned long long)GetProfiler().GetFrameCount());
+    ImGui::SameLine();
+    if (ImGui::Button("Reset")) {
+        GetProfiler().Reset();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Export flame graph")) {
+        const char* path = "imgui_ex_profile.folded";
+        snprintf(status, sizeof(status), ExportFlameGraph(path) ? "Saved %s" : "Failed to write %s", path);
+    }
+    ImGui::SameLine();
+    ImGui::Checkbox("Windows only", &top_level_only);
+    if (status[0] != '\0') {
+        ImGui::TextDisabled("%s", status);
+    }
+
+    std::vector<ProfileEntry> entries = GetProfileEntries();
+    if (top_level_only) {
+        entries.erase(std::remove_if(entries.begin(), entries.end(), [](const ProfileEntry& entry) { return !entry.top_level; }), entries.end());
+    }
+    const ImGuiTableFlags flags = ImGuiTableFlags_Sortable | ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_ScrollY | ImGuiTableFlags_SizingFixedFit;
+    if (ImGui::BeginTable("##profile", 5, flags)) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Widget", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Calls/frame");
+        ImGui::TableSetupColumn("Inclusive ms");
+        ImGui::TableSetupColumn("Exclusive ms", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_PreferSortDescending);
+        ImGui::TableSetupColumn("Max ms");
+        ImGui::TableHeadersRow();
+
+        ImGuiTableSortSpecs* specs = ImGui::TableGetSortSpecs();
+        if (specs && specs->SpecsCount > 0) {
+            const ImGuiTableColumnSortSpecs& spec = specs->Specs[0];
+            internal::SortProfileEntries(entries, spec.ColumnIndex, spec.SortDirection == ImGuiSortDirection_Ascending);
+        }
+
+        ImGuiListClipper clipper;
+        clipper.Begin((int)entries.size());
+        while (clipper.Step()) {
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+                const ProfileEntry& entry = entries[i];
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn(); ImGui::TextUnformatted(entry.label.c_str());
+                ImGui::TableNextColumn(); ImGui::Text("%.1f", entry.calls);
+                ImGui::TableNextColumn(); ImGui::Text("%.3f", entry.inclusive_ms);
+                ImGui::TableNextColumn(); ImGui::Text("%.3f", entry.exclusive_ms);
+                ImGui::TableNextColumn(); ImGui::Text("%.3f", entry.max_inclusive_ms);
+            }
+        }
+        ImGui::EndTable();
+    }
+#endif
+    ImGui::End();
+}
+
+void ShowMemoryStatsWindow(bool* open) {
+    if (!ImGui::Begin("ImGuiEx Memory", open)) {
+        ImGui::End();
+        return;
+    }
+    const MemoryStats stats = GetMemoryStats();
+    if (!stats.enabled) {
+        ImGui::TextDisabled("Build with IMGUI_EX_MEMORY_STATS to collect allocation statistics");
+        ImGui::End();
+        return;
+    }
+    ImGui::Text("Frame %llu", (unsigned long long)stats.frame);
+    if (ImGui::BeginTable("##memory", 7, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit)) {
+        ImGui::TableSetupColumn("Subsystem");
+        ImGui::TableSetupColumn("Allocs/frame");
+        ImGui::TableSetupColumn("Frees/frame");
+        ImGui::TableSetupColumn("Bytes/frame");
+        ImGui::TableSetupColumn("Live");
+        ImGui::TableSetupColumn("Live bytes");
+        ImGui::TableSetupColumn("Peak bytes");
+        ImGui::TableHeadersRow();
+        MemoryTagStats total = {};
+        for (int tag = 0; tag <= MemoryTag_COUNT; tag++) {
+            const MemoryTagStats& row = tag < MemoryTag_COUNT ? stats.tags[tag] : total;
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(tag < MemoryTag_COUNT ? GetMemoryTagName((MemoryTag)tag) : "Total");
+            ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)row.frame_allocations);
+            ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)row.frame_frees);
+            ImGui::TableNextColumn(); ImGui::Text("%zu", row.frame_bytes);
+            ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)row.live_allocations);
+            ImGui::TableNextColumn(); ImGui::Text("%zu", row.live_bytes);
+            ImGui::TableNextColumn(); ImGui::Text("%zu", row.peak_live_bytes);
+            if (tag < MemoryTag_COUNT) {
+                total.frame_allocations += row.frame_allocations;
+                total.frame_frees += row.frame_frees;
+                total.frame_bytes += row.frame_bytes;
+                total.live_allocations += row.live_allocations;
+                total.live_bytes += row.live_bytes;
+                total.peak_live_bytes += row.peak_live_bytes;
+            }
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
+
+} // namespace ImGuiEx
+
+static ImGuiEx::InputMessageKind ClassifyInputMessage(UINT message)
+{
+    switch (message)
+    {
+    case WM_MOUSEMOVE:
+    case WM_NCMOUSEMOVE:
+        return ImGuiEx::InputMessageKind_MouseMove;
+    case WM_MOUSEWHEEL:
+        return ImGuiEx::InputMessageKind_MouseWheel;
+    case WM_MOUSEHWHEEL:
+        return ImGuiEx::InputMessageKind_MouseHWheel;
+    }
+    return ImGuiEx::InputMessageKind_Other;
+}
+
+
+// Data
+static ID3D11Device* g_pd3dDevice = nullptr;
+static ID3D11DeviceContext* g_pd3dDeviceContext = nullptr;
+static IDXGISwapChain* g_pSwapChain = nullptr;
+static UINT                     g_ResizeWidth = 0, g_ResizeHeight = 0;
+static ID3D11RenderTargetView* g_mainRenderTargetView = nullptr;
+static UINT                     g_SwapChainFlags = 0;
+static HANDLE                   g_FrameLatencyWaitable = nullptr;
+
+// Forward declarations of helper functions
+static bool CreateDeviceD3D(HWND hWnd);
+static void CleanupDeviceD3D();
+static bool CreateSwapChain(HWND hWnd);
+static void CleanupSwapChain();
+static void SetSwapChainSourceSize(UINT width, UINT height);
+static ImDrawData* GetMainDrawData();
+static void CreateRenderTarget();
+static void CleanupRenderTarget();
+static LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
+
+
+// The main swap chain as seen by PresentPacer
+struct MainSwapChain {
+    IDXGISwapChain* swap_chain = nullptr;   // nullptr: g_pSwapChain at the time of the call
+
+    bool WaitForFrame(unsigned timeout_ms) {
+        if (g_FrameLatencyWaitable == nullptr) {
+            return true;
+        }
+        return ::WaitForSingleObjectEx(g_FrameLatencyWaitable, timeout_ms, TRUE) == WAIT_OBJECT_0;
+    }
+
+    bool Present(unsigned sync_interval, bool tearing) {
+        IDXGISwapChain* target = swap_chain ? swap_chain : g_pSwapChain;
+        return SUCCEEDED(target->Present(sync_interval, tearing ? DXGI_PRESENT_ALLOW_TEARING : 0));
+    }
+};
+
+static MainSwapChain gs_main_swap_chain;
+static ImGuiEx::internal::PresentPacer<MainSwapChain> gs_present_pacer(gs_main_swap_chain);
+static ImGuiEx::PresentConfig gs_present_config;
+static bool gs_present_config_dirty = false;
+
+static ImGuiEx::internal::ResizePolicy gs_resize_policy;
+
+static bool IsInputMessage(UINT message)
+{
+    return (message >= WM_MOUSEFIRST && message <= WM_MOUSELAST) || (message >= WM_KEYFIRST && message <= WM_KEYLAST) || (message >= WM_NCMOUSEMOVE && message <= WM_NCXBUTTONDBLCLK) || message == WM_INPUT;
+}
+
+
+// Render thread for pipelined mode.
+// The UI thread copies the frame into one of two slots while the render thread draws the other,
+// everything touching the device context is done by the render thread while it runs.
+class RenderPipeline {
+public:
+    RenderPipeline() {
+        pending_ = -1;
+        active_ = -1;
+        stop_ = false;
+        stats_ = {};
+        second_presented_ = 0;
+    }
+
+    bool IsRunning() {
+        return thread_.joinable();
+    }
+
+    void SetEnabled(bool enable) {
+        if (enable && !IsRunning()) {
+            stop_ = false;
+            thread_ = std::thread([this]() { Run(); });
+        }
+        else if (!enable && IsRunning()) {
+            Stop();
+        }
+    }
+
+    void Stop() {
+        if (!IsRunning()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        thread_.join();
+
+        // Nothing keeps the copies of the last frames once the thread is gone
+        for (auto& frame : frames_) {
+            frame.main.draw_data.Clear();
+            frame.windows.clear();
+            frame.window_count = 0;
+        }
+    }
+
+    // Blocks until the render thread has nothing queued or in flight
+    void WaitIdle() {
+        if (!IsRunning()) {
+            return;
+        }
+        const auto wait_start = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return pending_ == -1 && active_ == -1; });
+        wait_ms_ += Elapsed(wait_start);
+    }
+
+    // Copies the draw data of the main and platform viewports and queues them
+    void Submit(const float clear_color[4], std::chrono::steady_clock::time_point frame_start, bool viewports) {
+        const auto wait_start = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return pending_ == -1; });
+        const int slot = active_ == 0 ? 1 : 0;
+        wait_ms_ += Elapsed(wait_start);
+        lock.unlock();
+
+        Frame& frame = frames_[slot];
+        memcpy(frame.clear_color, clear_color, sizeof(frame.clear_color));
+        frame.start = frame_start;
+        frame.main.Capture(GetMainDrawData(), g_mainRenderTargetView, g_pSwapChain, true);
+        frame.window_count = 0;
+        if (viewports) {
+            ImGuiPlatformIO& platform_io = ImGui::GetPlatformIO();
+            for (int i = 1; i < platform_io.Viewports.Size; i++) {
+                ImGuiViewport* viewport = platform_io.Viewports[i];
+                auto vd = (ImGui_ImplDX11_ViewportData*)viewport->RendererUserData;
+                if ((viewport->Flags & ImGuiViewportFlags_IsMinimized) || vd == nullptr || viewport->DrawData == nullptr) {
+                    continue;
+                }
+                if (frame.window_count == (int)frame.windows.size()) {
+                    frame.windows.push_back(std::make_unique<Target>());
+                }
+                frame.windows[frame.window_count++]->Capture(viewport->DrawData, vd->RTView, vd->SwapChain, !(viewport->Flags & ImGuiViewportFlags_NoRendererClear));
+            }
+        }
+
+        lock.lock();
+        pending_ = slot;
+        lock.unlock();
+        cv_.notify_all();
+    }
+
+    // Serial mode reports through the same counters
+    void RecordFrame(std::chrono::steady_clock::time_point frame_start, std::chrono::steady_clock::time_point render_start) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Record(frame_start, render_start);
+    }
+
+    ImGuiEx::RenderStats GetStats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ImGuiEx::RenderStats stats = stats_;
+        stats.pipelined = thread_.joinable();
+        return stats;
+    }
+
+private:
+    struct Target {
+        Target() : rtv(nullptr), swap_chain(nullptr), clear(true) {
+        }
+
+        void Capture(ImDrawData* src, ID3D11RenderTargetView* target_view, IDXGISwapChain* target_swap_chain, bool target_clear) {
+            draw_data.Copy(src);
+            // Held until presented, so a viewport closed meanwhile stays valid for this frame
+            rtv = target_view;
+            swap_chain = target_swap_chain;
+            rtv->AddRef();
+            swap_chain->AddRef();
+            clear = target_clear;
+        }
+
+        void Release() {
+            if (rtv) { rtv->Release(); rtv = nullptr; }
+            if (swap_chain) { swap_chain->Release(); swap_chain = nullptr; }
+        }
+
+        ImGuiEx::internal::DrawDataSnapshot draw_data;
+        ID3D11RenderTargetView* rtv;
+        IDXGISwapChain* swap_chain;
+        bool clear;
+    };
+
+    struct Frame {
+        Target main;
+        std::vector<std::unique_ptr<Target>> windows;
+        int window_count = 0;
+        float clear_color[4];
+        std::chrono::steady_clock::time_point start;
+    };
+
+    static double Elapsed(std::chrono::steady_clock::time_point since) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+    }
+
+    void Run() {
+        for (;;) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return stop_ || pending_ != -1; });
+            if (pending_ == -1) {
+                return;
+            }
+            active_ = pending_;
+            pending_ = -1;
+            lock.unlock();
+            cv_.notify_all();
+
+            Frame& frame = frames_[active_];
+            const auto render_start = std::chrono::steady_clock::now();
+            Draw(frame);
+
+            lock.lock();
+            Record(frame.start, render_start);
+            active_ = -1;
+            lock.unlock();
+            cv_.notify_all();
+        }
+    }
+
+    static void Draw(Frame& frame) {
+        static const float transparent[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        g_pd3dDeviceContext->OMSetRenderTargets(1, &frame.main.rtv, nullptr);
+        g_pd3dDeviceContext->ClearRenderTargetView(frame.main.rtv, frame.clear_color);
+        ImGui_ImplDX11_RenderDrawData(frame.main.draw_data.Get());
+        for (int i = 0; i < frame.window_count; i++) {
+            Target& target = *frame.windows[i];
+            g_pd3dDeviceContext->OMSetRenderTargets(1, &target.rtv, nullptr);
+            if (target.clear) {
+                g_pd3dDeviceContext->ClearRenderTargetView(target.rtv, transparent);
+            }
+            ImGui_ImplDX11_RenderDrawData(target.draw_data.Get());
+        }
+        for (int i = 0; i < frame.window_count; i++) {
+            frame.windows[i]->swap_chain->Present(0, 0);
+            frame.windows[i]->Release();
+        }
+        // The swap chain captured with the frame, g_pSwapChain may have been recreated by the UI thread since
+        MainSwapChain main;
+        main.swap_chain = frame.main.swap_chain;
+        gs_present_pacer.Present(main);
+        frame.main.Release();
+    }
+
+    void Record(std::chrono::steady_clock::time_point frame_start, std::chrono::steady_clock::time_point render_start) {
+        const auto now = std::chrono::steady_clock::now();
+        const double alpha = 0.1;
+        auto average = [alpha](double& value, double sample) { value += (sample - value) * alpha; };
+        average(stats_.frame_latency_ms, std::chrono::duration<double, std::milli>(now - frame_start).count());
+        average(stats_.render_ms, std::chrono::duration<double, std::milli>(now - render_start).count());
+        average(stats_.wait_ms, wait_ms_);
+        wait_ms_ = 0.0;
+        stats_.frames_presented++;
+        if (now - second_start_ >= std::chrono::seconds(1)) {
+            stats_.frames_per_second = (double)(stats_.frames_presented - second_presented_) / std::chrono::duration<double>(now - second_start_).count();
+            second_start_ = now;
+            second_presented_ = stats_.frames_presented;
+        }
+    }
+
+private:
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    Frame frames_[2];
+    int pending_;
+    int active_;
+    bool stop_;
+
+    ImGuiEx::RenderStats stats_;
+    double wait_ms_ = 0.0;
+    std::chrono::steady_clock::time_point second_start_;
+    uint64_t second_presented_;
+};
+
+static bool gs_pipelined_rendering = false;
+static RenderPipeline gs_render_pipeline;
+
+static ImGuiEx::internal::PlatformWindowPool gs_platform_window_pool;
+
+static bool gs_overlay_mode = false;
+static bool gs_overlay_active = false;
+static bool gs_overlay_click_through = true;
+static ImGuiEx::internal::OverlayRegions gs_overlay_regions;
+static uint64_t gs_overlay_toggles = 0;
+static uint64_t gs_overlay_presented = 0;
+static uint64_t gs_overlay_skipped = 0;
+
+// The overlay covers the monitor of the window and is composed with per pixel alpha
+static void ApplyOverlayMode(HWND hwnd, bool enable)
+{
+    if (enable)
+    {
+        MONITORINFO monitor = { sizeof(monitor) };
+        ::GetMonitorInfo(::MonitorFromWindow(hwnd, MONITOR_DEFAULTTOPRIMARY), &monitor);
+        const RECT& rc = monitor.rcMonitor;
+        ::SetLayeredWindowAttributes(hwnd, 0, 255, LWA_ALPHA);
+        MARGINS margins = { -1, -1, -1, -1 };
+        ::DwmExtendFrameIntoClientArea(hwnd, &margins);
+        ::SetWindowPos(hwnd, HWND_TOPMOST, rc.left, rc.top, rc.right - rc.left, rc.bottom - rc.top, SWP_NOACTIVATE | SWP_SHOWWINDOW);
+    }
+    else
+    {
+        MARGINS margins = { 0, 0, 0, 0 };
+        ::DwmExtendFrameIntoClientArea(hwnd, &margins);
+        ::SetWindowPos(hwnd, HWND_TOPMOST, 0, 0, 0, 0, SWP_NOACTIVATE);
+    }
+    ::SetWindowLongPtr(hwnd, GWL_EXSTYLE, ::GetWindowLongPtr(hwnd, GWL_EXSTYLE) | WS_EX_TRANSPARENT);
+    gs_overlay_click_through = true;
+    gs_overlay_active = enable;
+    gs_overlay_regions.Invalidate();
+}
+
+// Mouse input only reaches the overlay over an ImGui window, the style only changes when the cursor crosses a region
+static void UpdateOverlayClickThrough(HWND hwnd)
+{
+    ImGuiContext& g = *ImGui::GetCurrentContext();
+    POINT cursor;
+    ::GetCursorPos(&cursor);
+    // A drag keeps the input even when the cursor leaves the window
+    const bool interactive = gs_overlay_regions.HitTest(ImVec2((float)cursor.x, (float)cursor.y)) || g.ActiveId != 0 || g.MovingWindow != nullptr;
+    if (interactive != gs_overlay_click_through)
+        return;
+    gs_overlay_click_through = !interactive;
+    LONG_PTR style = ::GetWindowLongPtr(hwnd, GWL_EXSTYLE);
+    style = gs_overlay_click_through ? (style | WS_EX_TRANSPARENT) : (style & ~(LONG_PTR)WS_EX_TRANSPARENT);
+    ::SetWindowLongPtr(hwnd, GWL_EXSTYLE, style);
+    gs_overlay_toggles++;
+}
+
+// Message ring in named shared memory between a tool and its viewer
+struct SharedRing
+{
+    HANDLE mapping = nullptr;
+    void* view = nullptr;
+    bool producer = false;
+    ImGuiEx::internal::StateRing ring;
+    std::vector<uint8_t> message;
+
+    bool Create(const char* name, uint32_t capacity)
+    {
+        Close();
+        uint32_t ring_capacity = 16;
+        while (ring_capacity < capacity && ring_capacity < (1u << 31))
+            ring_capacity <<= 1;
+        const size_t size = ImGuiEx::internal::StateRing::GetMemorySize(ring_capacity);
+        if (!Map(::CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32), (DWORD)size, name)))
+            return false;
+        ring.Create(view, ring_capacity);
+        producer = true;
+        return true;
+    }
+
+    bool Open(const char* name)
+    {
+        Close();
+        if (!Map(::OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name)) || !ring.Attach(view))
+        {
+            Close();
+            return false;
+        }
+        producer = false;
+        return true;
+    }
+
+    void Close()
+    {
+        ring.Detach();
+        if (view) { ::UnmapViewOfFile(view); view = nullptr; }
+        if (mapping) { ::CloseHandle(mapping); mapping = nullptr; }
+    }
+
+    bool IsProducer() { return ring.IsAttached() && producer; }
+    bool IsConsumer() { return ring.IsAttached() && !producer; }
+
+private:
+    bool Map(HANDLE handle)
+    {
+        if (handle == nullptr)
+            return false;
+        mapping = handle;
+        view = ::MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+        if (view == nullptr)
+            Close();
+        return view != nullptr;
+    }
+};
+
+static SharedRing gs_state_mirror;
+
+// The viewer applies the tool's changes before its own update so they fire as regular events
+static void ReceiveStateMirror()
+{
+    if (!gs_state_mirror.IsConsumer())
+        return;
+    while (gs_state_mirror.ring.Pop(gs_state_mirror.message))
+        ImGuiEx::GetStateRegistry().ApplyDelta(gs_state_mirror.message.data(), gs_state_mirror.message.size());
+}
+
+// A dropped message or a new viewer makes the next message carry every widget
+static void SendStateMirror()
+{
+    if (!gs_state_mirror.IsProducer())
+        return;
+    ImGuiEx::StateRegistry& registry = ImGuiEx::GetStateRegistry();
+    if (gs_state_mirror.ring.TakeResync())
+        registry.ResetDelta();
+    if (registry.SaveDelta(gs_state_mirror.message) && !gs_state_mirror.ring.Push(gs_state_mirror.message.data(), (uint32_t)gs_state_mirror.message.size()))
+        registry.ResetDelta();
+}
+
+static SharedRing gs_draw_stream;
+static ImGuiEx::internal::DrawStreamEncoder gs_draw_encoder;
+static ImGuiEx::internal::DrawStreamDecoder gs_draw_decoder;
+
+// Encodes the main viewport's draw data, a dropped message or a new viewer makes the next one self-contained
+static void SendDrawStream()
+{
+    if (!gs_draw_stream.IsProducer())
+        return;
+    if (gs_draw_stream.ring.TakeResync())
+        gs_draw_encoder.Reset();
+    gs_draw_encoder.Encode(ImGui::GetDrawData(), ImGui::GetIO().Fonts->TexID, gs_draw_stream.message);
+    if (!gs_draw_stream.ring.Push(gs_draw_stream.message.data(), (uint32_t)gs_draw_stream.message.size()))
+        gs_draw_encoder.Reset();
+}
+
+static void ReceiveDrawStream()
+{
+    if (!gs_draw_stream.IsConsumer())
+        return;
+    gs_draw_decoder.SetFontTexture(ImGui::GetIO().Fonts->TexID);
+    while (gs_draw_stream.ring.Pop(gs_draw_stream.message))
+    {
+        if (!gs_draw_decoder.Decode(gs_draw_stream.message.data(), gs_draw_stream.message.size()))
+            gs_draw_stream.ring.RequestResync();
+    }
+}
+
+// A viewer replays the tool's frame in its main window
+static ImDrawData* GetMainDrawData()
+{
+    ImDrawData* draw_data = gs_draw_stream.IsConsumer() ? gs_draw_decoder.Get() : nullptr;
+    return draw_data ? draw_data : ImGui::GetDrawData();
+}
+
+// Every operator new of the process while a benchmark counts, the standard containers and strings of the widgets.
+// new[] and the nothrow forms go through this one.
+static std::atomic<bool> gs_count_heap_allocations(false);
+static std::atomic<uint64_t> gs_heap_allocations(0);
+
+void* operator new(size_t size)
+{
+    if (gs_count_heap_allocations.load(std::memory_order_relaxed))
+        gs_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    void* ptr = malloc(size != 0 ? size : 1);
+    if (ptr == nullptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+// Allocations made by ImGui while a benchmark runs, forwarded to the allocator installed before it
+static ImGuiMemAllocFunc gs_benchmark_alloc = nullptr;
+static ImGuiMemFreeFunc gs_benchmark_free = nullptr;
+static void* gs_benchmark_user_data = nullptr;
+static uint64_t gs_benchmark_allocations = 0;
+
+static void* BenchmarkAlloc(size_t size, void* user_data)
+{
+    gs_benchmark_allocations++;
+    return gs_benchmark_alloc(size, gs_benchmark_user_data);
+}
+
+static void BenchmarkFree(void* ptr, void* user_data)
+{
+    gs_benchmark_free(ptr, gs_benchmark_user_data);
+}
+
+struct BenchmarkWindows
+{
+    std::vector<std::unique_ptr<ImGuiEx::Window>> windows;
+    std::vector<std::unique_ptr<ImGuiEx::Button>> buttons;
+    std::vector<std::unique_ptr<ImGuiEx::CheckBox>> checks;
+
+    BenchmarkWindows(const ImGuiEx::BenchmarkConfig& config)
+    {
+        for (int w = 0; w < config.windows; w++)
+        {
+            windows.push_back(std::make_unique<ImGuiEx::Window>("Window " + std::to_string(w)));
+            for (int b = 0; b < config.buttons; b++)
+            {
+                buttons.push_back(std::make_unique<ImGuiEx::Button>("Button " + std::to_string(b)));
+                checks.push_back(std::make_unique<ImGuiEx::CheckBox>("Check " + std::to_string(b), b % 2 == 0));
+            }
+        }
+    }
+
+    void Frame()
+    {
+        const size_t per_window = windows.empty() ? 0 : buttons.size() / windows.size();
+        for (size_t w = 0; w < windows.size(); w++)
+        {
+            ImGui::SetNextWindowPos(ImVec2((float)(w % 4) * 480.0f, (float)(w / 4 % 4) * 270.0f));
+            ImGui::SetNextWindowSize(ImVec2(460.0f, 250.0f));
+            windows[w]->Begin();
+            windows[w]->ExpandUpdate([&]() {
+                for (size_t i = w * per_window; i < (w + 1) * per_window; i++)
+                {
+                    buttons[i]->Begin();
+                    buttons[i]->End();
+                    ImGui::SameLine();
+                    checks[i]->Begin();
+                    checks[i]->End();
+                }
+            });
+            windows[w]->End();
+        }
+    }
+};
+
+struct BenchmarkLists
+{
+    ImGuiEx::Window window;
+    ImGuiEx::ListBox<> list_box;
+    ImGuiEx::Combo<> combo;
+
+    BenchmarkLists(const ImGuiEx::BenchmarkConfig& config) : window("Lists"), list_box("##list"), combo("Combo")
+    {
+        std::vector<std::string> items;
+        for (int i = 0; i < config.list_items; i++)
+            items.push_back("Item " + std::to_string(i));
+        std::vector<std::string> copy = items;
+        list_box.SetList(std::move(items));
+        combo.SetList(std::move(copy));
+        list_box.SetLabelFunc([](std::string& item) { return item; });
+        combo.SetLabelFunc([](std::string& item) { return item; });
+        list_box.SetSelectIndex(config.list_items / 2);
+        combo.SetSelectIndex(config.list_items / 2);
+    }
+
+    void Frame()
+    {
+        ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+        ImGui::SetNextWindowSize(ImVec2(600.0f, 1000.0f));
+        window.Begin();
+        window.ExpandUpdate([&]() {
+            // Keeps the popup of BeginCombo open so its rows are laid out every frame
+            const ImGuiID popup_id = ImHashStr("##ComboPopup", 0, ImGui::GetID(combo.GetLabel().c_str()));
+            if (!ImGui::IsPopupOpen(popup_id, ImGuiPopupFlags_None))
+                ImGui::OpenPopupEx(popup_id);
+            combo.Begin();
+            combo.InsertUpdate();
+            combo.End();
+            list_box.Begin();
+            list_box.InsertUpdate();
+            list_box.End();
+        });
+        window.End();
+    }
+};
+
+// A live list rebuilt every frame with a few changed rows: keyed Update keeps the other labels, SetList drops them all
+template<bool Keyed>
+struct BenchmarkListUpdate
+{
+    struct Row
+    {
+        int id;
+        int count;
+
+        bool operator==(const Row& other) const
+        {
+            return id == other.id && count == other.count;
+        }
+    };
+
+    ImGuiEx::Window window;
+    ImGuiEx::ListBox<Row, int> list_box;
+    std::vector<Row> source;
+    uint32_t seed;
+
+    BenchmarkListUpdate(const ImGuiEx::BenchmarkConfig& config) : window("List update"), list_box("##list")
+    {
+        seed = 1;
+        for (int i = 0; i < config.list_items; i++)
+            source.push_back(Row{ i, 0 });
+        if (Keyed)
+            list_box.SetKeyFunc([](const Row& row) { return row.id; });
+        list_box.SetLabelFunc([](Row& row) { return "Item " + std::to_string(row.id) + " (" + std::to_string(row.count) + ")"; });
+        std::vector<Row> copy = source;
+        list_box.SetList(std::move(copy));
+        list_box.SetSelectIndex(config.list_items / 2);
+    }
+
+    size_t Next()
+    {
+        seed = seed * 1664525u + 1013904223u;
+        return (size_t)(seed >> 8) % source.size();
+    }
+
+    void Frame()
+    {
+        // Sixteen counters tick and one row moves, the rest is as it was
+        for (int i = 0; i < 16; i++)
+            source[Next()].count++;
+        const size_t from = Next();
+        const size_t to = Next();
+        const Row moved = source[from];
+        source.erase(source.begin() + from);
+        source.insert(source.begin() + to, moved);
+
+        std::vector<Row> list = source;
+        if (Keyed)
+            list_box.Update(std::move(list));
+        else
+            list_box.SetList(std::move(list));
+
+        ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+        ImGui::SetNextWindowSize(ImVec2(600.0f, 1000.0f));
+        window.Begin();
+        window.ExpandUpdate([&]() {
+            list_box.Begin();
+            list_box.InsertUpdate();
+            list_box.End();
+        });
+        window.End();
+    }
+};
+
+// Rows labelled every frame by the InsertUpdate callback, into std::string or into the frame arena.
+// The labels are longer than the small string buffer, as live counters usually are.
+template<bool Arena>
+struct BenchmarkListFormat
+{
+    struct Row
+    {
+        int id;
+        int hits;
+
+        bool operator==(const Row& other) const
+        {
+            return id == other.id && hits == other.hits;
+        }
+    };
+
+    ImGuiEx::Window window;
+    ImGuiEx::ListBox<Row, int> list_box;
+    int frame;
+
+    BenchmarkListFormat(const ImGuiEx::BenchmarkConfig& config) : window("List format"), list_box("##format")
+    {
+        frame = 0;
+        std::vector<Row> rows;
+        for (int i = 0; i < config.windows * config.buttons; i++)
+            rows.push_back(Row{ i, i % 7 });
+        list_box.SetList(std::move(rows));
+    }
+
+    void Frame()
+    {
+        frame++;
+        ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+        ImGui::SetNextWindowSize(ImVec2(600.0f, 1000.0f));
+        window.Begin();
+        window.ExpandUpdate([&]() {
+            list_box.Begin();
+            if (Arena)
+                list_box.InsertUpdate([&](Row& row) { return ImGuiEx::FrameFormat("Item %d: %d hits, frame %d", row.id, row.hits, frame); });
+            else
+                list_box.InsertUpdate([&](Row& row) { return "Item " + std::to_string(row.id) + ": " + std::to_string(row.hits) + " hits, frame " + std::to_string(frame); });
+            list_box.End();
+        });
+        window.End();
+    }
+};
+
+struct BenchmarkText
+{
+    ImGuiEx::Window window;
+    ImGuiEx::InputTextMultiline text;
+
+    BenchmarkText(const ImGuiEx::BenchmarkConfig& config) : window("Text"), text("##text")
+    {
+        std::string content;
+        for (int i = 0; i < config.text_lines; i++)
+            content += "Line " + std::to_string(i) + ": the quick brown fox jumps over the lazy dog\n";
+        text.SetText(content);
+    }
+
+    void Frame()
+    {
+        ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+        ImGui::SetNextWindowSize(ImVec2(1000.0f, 1000.0f));
+        window.Begin();
+        window.ExpandUpdate([&]() {
+            text.Begin();
+            text.End();
+        });
+        window.End();
+    }
+};
+
+struct BenchmarkTree
+{
+    ImGuiEx::Window window;
+    std::vector<std::unique_ptr<ImGuiEx::TreeNode>> nodes;
+
+    BenchmarkTree(const ImGuiEx::BenchmarkConfig& config) : window("Tree")
+    {
+        for (int i = 0; i < config.tree_depth; i++)
+        {
+            nodes.push_back(std::make_unique<ImGuiEx::TreeNode>("Node " + std::to_string(i)));
+            nodes.back()->SetExpand(true);
+        }
+    }
+
+    void Frame()
+    {
+        ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+        ImGui::SetNextWindowSize(ImVec2(1000.0f, 1000.0f));
+        window.Begin();
+        window.ExpandUpdate([&]() { Node(0); });
+        window.End();
+    }
+
+    void Node(size_t depth)
+    {
+        if (depth == nodes.size())
+            return;
+        nodes[depth]->Begin();
+        nodes[depth]->ExpandUpdate([&]() {
+            ImGui::Text("Depth %d", (int)depth);
+            Node(depth + 1);
+        });
+        nodes[depth]->End();
+    }
+};
+
+template<bool Static>
+struct BenchmarkStaticPage
+{
+    ImGuiEx::Window window;
+    std::vector<std::string> lines;
+
+    BenchmarkStaticPage(const ImGuiEx::BenchmarkConfig& config) : window(Static ? "Static page" : "Page")
+    {
+        window.SetStatic(Static);
+        for (int i = 0; i < config.static_lines; i++)
+            lines.push_back("Help line " + std::to_string(i) + ": the quick brown fox jumps over the lazy dog");
+    }
+
+    void Frame()
+    {
+        ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+        ImGui::SetNextWindowSize(ImVec2(1000.0f, 1000.0f));
+        window.Begin();
+        window.ExpandUpdate([&]() {
+            ImGui::SeparatorText("Help");
+            for (size_t i = 0; i < lines.size(); i++)
+            {
+                if (i % 4 == 0)
+                    ImGui::BulletText("%s", lines[i].c_str());
+                else
+                    ImGui::TextUnformatted(lines[i].c_str());
+            }
+        });
+        window.End();
+    }
+};
+
+template<bool Cached>
+struct BenchmarkLabelForm
+{
+    ImGuiEx::Window window;
+    std::vector<std::unique_ptr<ImGuiEx::Text>> texts;
+    std::vector<std::string> labels;
+
+    BenchmarkLabelForm(const ImGuiEx::BenchmarkConfig& config) : window("Form")
+    {
+        for (int i = 0; i < config.form_labels; i++)
+        {
+            labels.push_back("Field " + std::to_string(i) + " \xe5\x90\x8d\xe7\xa7\xb0");
+            texts.push_back(std::make_unique<ImGuiEx::Text>(labels.back().c_str()));
+        }
+    }
+
+    void Frame()
+    {
+        ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+        ImGui::SetNextWindowSize(ImVec2(1000.0f, 1000.0f));
+        window.Begin();
+        window.ExpandUpdate([&]() {
+            for (size_t i = 0; i < texts.size(); i++)
+            {
+                if (Cached)
+                {
+                    texts[i]->Begin();
+                    texts[i]->End();
+                }
+                else
+                {
+                    ImGui::TextUnformatted(labels[i].c_str());
+                }
+            }
+        });
+        window.End();
+    }
+};
+
+// The same panels run by LayoutProgram and written out by hand, the difference is what the interpreter costs
+// The rows of BenchmarkWindows as Panel types against the same widgets called one by one
+template<bool Composed>
+struct BenchmarkPanel
+{
+    using Row = ImGuiEx::Panel<ImGuiEx::Button, ImGuiEx::layout::SameLineOp, ImGuiEx::CheckBox, ImGuiEx::layout::SameLineOp, ImGuiEx::Text>;
+
+    std::vector<std::unique_ptr<ImGuiEx::Window>> windows;
+    std::vector<std::unique_ptr<Row>> rows;
+    std::vector<std::unique_ptr<ImGuiEx::Button>> buttons;
+    std::vector<std::unique_ptr<ImGuiEx::CheckBox>> checks;
+    std::vector<std::unique_ptr<ImGuiEx::Text>> texts;
+    int clicks = 0;
+
+    BenchmarkPanel(const ImGuiEx::BenchmarkConfig& config)
+    {
+        for (int w = 0; w < config.windows; w++)
+        {
+            windows.push_back(std::make_unique<ImGuiEx::Window>("Window " + std::to_string(w)));
+            for (int b = 0; b < config.buttons; b++)
+            {
+                const std::string button = "Button " + std::to_string(b);
+                const std::string check = "Check " + std::to_string(b);
+                if (Composed)
+                {
+                    rows.push_back(std::make_unique<Row>(ImGuiEx::Button(button), ImGuiEx::layout::SameLineOp(), ImGuiEx::CheckBox(check, b % 2 == 0),
+                        ImGuiEx::layout::SameLineOp(), ImGuiEx::Text("Ready")));
+                }
+                else
+                {
+                    buttons.push_back(std::make_unique<ImGuiEx::Button>(button));
+                    checks.push_back(std::make_unique<ImGuiEx::CheckBox>(check, b % 2 == 0));
+                    texts.push_back(std::make_unique<ImGuiEx::Text>("Ready"));
+                }
+            }
+        }
+    }
+
+    void Frame()
+    {
+        const size_t count = Composed ? rows.size() : buttons.size();
+        const size_t per_window = windows.empty() ? 0 : count / windows.size();
+        for (size_t w = 0; w < windows.size(); w++)
+        {
+            ImGui::SetNextWindowPos(ImVec2((float)(w % 4) * 480.0f, (float)(w / 4 % 4) * 270.0f));
+            ImGui::SetNextWindowSize(ImVec2(460.0f, 250.0f));
+            windows[w]->Begin();
+            windows[w]->ExpandUpdate([&]() {
+                for (size_t i = w * per_window; i < (w + 1) * per_window; i++)
+                {
+                    if (Composed)
+                    {
+                        rows[i]->Run([this](auto& widget, auto index) {
+                            if constexpr (decltype(index)::value == 0)
+                                widget.ClickEvent([this]() { clicks++; });
+                        });
+                        continue;
+                    }
+                    buttons[i]->Begin();
+                    buttons[i]->ClickEvent([this]() { clicks++; });
+                    buttons[i]->End();
+                    ImGui::SameLine();
+                    checks[i]->Begin();
+                    checks[i]->End();
+                    ImGui::SameLine();
+                    texts[i]->Begin();
+                    texts[i]->End();
+                }
+            });
+            windows[w]->End();
+        }
+    }
+};
+
+template<bool Interpreted>
+struct BenchmarkLayout
+{
+    ImGuiEx::LayoutProgram program;
+    std::vector<std::unique_ptr<ImGuiEx::Window>> windows;
+    std::vector<std::unique_ptr<ImGuiEx::Button>> buttons;
+    std::vector<std::unique_ptr<ImGuiEx::CheckBox>> checks;
+    int clicks = 0;
+
+    BenchmarkLayout(const ImGuiEx::BenchmarkConfig& config)
+    {
+        std::string source;
+        for (int w = 0; w < config.windows; w++)
+        {
+            const std::string window = "Window " + std::to_string(w);
+            if (Interpreted)
+                source += "window \"" + window + "\"\n";
+            else
+                windows.push_back(std::make_unique<ImGuiEx::Window>(window));
+            for (int b = 0; b < config.buttons; b++)
+            {
+                const std::string button = "Button " + std::to_string(b);
+                const std::string check = "Check " + std::to_string(b);
+                if (Interpreted)
+                {
+                    source += "    button \"" + button + "\"\n    sameline\n    checkbox \"" + check + "\" check=" + std::to_string(b % 2 == 0) + "\n";
+                    program.Bind<ImGuiEx::Button>(window + "/" + button, [this](ImGuiEx::Button& widget) { widget.ClickEvent([this]() { clicks++; }); });
+                }
+                else
+                {
+                    buttons.push_back(std::make_unique<ImGuiEx::Button>(button));
+                    checks.push_back(std::make_unique<ImGuiEx::CheckBox>(check, b % 2 == 0));
+                }
+            }
+            if (Interpreted)
+                source += "end\n";
+        }
+        if (Interpreted)
+        {
+            const bool loaded = program.Load(source);
+            IM_ASSERT(loaded && "Benchmark layout does not compile");
+            (void)loaded;
+        }
+    }
+
+    void Frame()
+    {
+        if (Interpreted)
+        {
+            program.Run();
+            return;
+        }
+        const size_t per_window = windows.empty() ? 0 : buttons.size() / windows.size();
+        for (size_t w = 0; w < windows.size(); w++)
+        {
+            windows[w]->Begin();
+            windows[w]->ExpandUpdate([&]() {
+                for (size_t i = w * per_window; i < (w + 1) * per_window; i++)
+                {
+                    buttons[i]->Begin();
+                    buttons[i]->ClickEvent([this]() { clicks++; });
+                    buttons[i]->End();
+                    ImGui::SameLine();
+                    checks[i]->Begin();
+                    checks[i]->End();
+                }
+            });
+            windows[w]->End();
+        }
+    }
+};
+
+struct BenchmarkPlot
+{
+    ImGuiEx::Window window;
+    ImGuiEx::Plot plot;
+    std::vector<float> block;
+    uint32_t seed;
+
+    BenchmarkPlot(const ImGuiEx::BenchmarkConfig& config) : window("Plot"), plot("##plot", (size_t)config.plot_samples, ImVec2(-FLT_MIN, 200.0f))
+    {
+        seed = 1;
+        block.resize(1024);
+        for (int pushed = 0; pushed < config.plot_samples; pushed += (int)block.size())
+        {
+            Fill();
+            plot.Push(block.data(), (std::min)(block.size(), (size_t)(config.plot_samples - pushed)));
+        }
+    }
+
+    void Fill()
+    {
+        for (float& value : block)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            value = (float)(seed >> 8) / (float)(1 << 24);
+        }
+    }
+
+    // A live signal: one new block per frame, the whole history on screen
+    void Frame()
+    {
+        Fill();
+        plot.Push(block.data(), block.size());
+        ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+        ImGui::SetNextWindowSize(ImVec2(1600.0f, 300.0f));
+        window.Begin();
+        window.ExpandUpdate([&]() {
+            plot.Begin();
+            plot.End();
+        });
+        window.End();
+    }
+};
+
+// A sorted table scrolled every frame, a few rows change value in place and the sort column switches now and then
+struct BenchmarkTable
+{
+    struct Row
+    {
+        int id;
+        std::string name;
+        double value;
+    };
+
+    ImGuiEx::Window window;
+    ImGuiEx::Table<Row> table;
+    uint32_t seed;
+    int frame;
+
+    BenchmarkTable(const ImGuiEx::BenchmarkConfig& config) : window("Table"), table("##table")
+    {
+        seed = 1;
+        frame = 0;
+        table.AddColumn("Id", [](const Row& row) { return std::to_string(row.id); },
+            [](const Row& a, const Row& b) { return a.id < b.id ? -1 : a.id > b.id ? 1 : 0; });
+        table.AddColumn("Name", [](const Row& row) { return row.name; });
+        table.AddColumn("Value", [](const Row& row) { char text[32]; snprintf(text, sizeof(text), "%.3f", row.value); return std::string(text); },
+            [](const Row& a, const Row& b) { return a.value < b.value ? -1 : a.value > b.value ? 1 : 0; });
+        std::vector<Row> rows;
+        for (int i = 0; i < config.list_items; i++)
+            rows.push_back(Row{ i, "Item " + std::to_string(i), Next() });
+        table.SetRows(std::move(rows));
+        table.SetSize(ImVec2(0.0f, -FLT_MIN));
+    }
+
+    double Next()
+    {
+        seed = seed * 1664525u + 1013904223u;
+        return (double)(seed >> 8) / (double)(1 << 24);
+    }
+
+    void Frame()
+    {
+        const int changed = 16;
+        for (int i = 0; i < changed; i++)
+        {
+            const size_t index = (size_t)(Next() * (double)table.GetRows().size());
+            Row row = table.GetRows()[index];
+            row.value = Next();
+            table.SetRow(index, std::move(row));
+        }
+        ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+        ImGui::SetNextWindowSize(ImVec2(800.0f, 1000.0f));
+        window.Begin();
+        window.ExpandUpdate([&]() {
+            table.Begin();
+            if (ImGui::GetCurrentTable() != nullptr)
+            {
+                // Value up, value down, name: the next Begin sorts everything again
+                if (frame % 60 == 0)
+                {
+                    const int step = frame / 60 % 3;
+                    ImGui::TableSetColumnSortDirection(step == 2 ? 1 : 2, step == 1 ? ImGuiSortDirection_Descending : ImGuiSortDirection_Ascending, false);
+                }
+                ImGui::SetScrollY(fmodf((float)frame * 997.0f * ImGui::GetTextLineHeightWithSpacing(), ImGui::GetScrollMaxY() + 1.0f));
+            }
+            table.InsertUpdate();
+            table.End();
+        });
+        window.End();
+        frame++;
+    }
+};
+
+// Headless context with a built font atlas, the previous context is current again once it goes out of scope
+struct BenchmarkContext
+{
+    ImGuiContext* previous;
+    ImGuiContext* context;
+
+    BenchmarkContext()
+    {
+        previous = ImGui::GetCurrentContext();
+        context = ImGui::CreateContext();
+        ImGui::SetCurrentContext(context);
+        ImGuiIO& io = ImGui::GetIO();
+        io.IniFilename = nullptr;
+        io.DisplaySize = ImVec2(1920.0f, 1080.0f);
+        io.DeltaTime = 1.0f / 60.0f;
+        unsigned char* pixels;
+        int width, height;
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    }
+
+    ~BenchmarkContext()
+    {
+        ImGui::DestroyContext(context);
+        ImGui::SetCurrentContext(previous);
+    }
+};
 
-#include <d3d11.h>
-#pragma comment(lib, "D3D11.lib")
+static void SetBenchmarkTimes(ImGuiEx::BenchmarkResult& result, std::vector<double>& times)
+{
+    if (times.empty())
+        return;
+    double total = 0.0;
+    for (double time : times)
+        total += time;
+    result.cpu_ms_mean = total / times.size();
+    std::sort(times.begin(), times.end());
+    result.cpu_ms_p95 = times[(times.size() - 1) * 95 / 100];
+}
 
-#define IMGUI_EX_CPP
-#include <imgui_ex/imgui_ex_win32.h>
+// A fresh context per workload so one cannot warm caches for the next
+template<class Workload>
+static ImGuiEx::BenchmarkResult RunBenchmark(const char* name, const ImGuiEx::BenchmarkConfig& config)
+{
+    ImGui::GetAllocatorFunctions(&gs_benchmark_alloc, &gs_benchmark_free, &gs_benchmark_user_data);
+    ImGui::SetAllocatorFunctions(BenchmarkAlloc, BenchmarkFree);
 
-// Dear ImGui: standalone example application for DirectX 11
-// If you are new to Dear ImGui, read documentation from the docs/ folder + read the top of imgui.cpp.
-// Read online: https://github.com/ocornut/imgui/tree/master/docs
+    ImGuiEx::BenchmarkResult result = {};
+    result.name = name;
+    result.frames = config.frames;
+    std::vector<double> times;
+    {
+        BenchmarkContext context;
+        Workload workload(config);
+        // The first frames create the windows and lay out the lists
+        for (int i = 0; i < 2; i++)
+        {
+            ImGui::NewFrame();
+            workload.Frame();
+            ImGui::Render();
+            gs_frame_arena.Reset();
+        }
+        gs_count_heap_allocations = true;
+        const uint64_t allocations = gs_benchmark_allocations + gs_heap_allocations;
+        double vertices = 0.0;
+        for (int i = 0; i < config.frames; i++)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            ImGui::NewFrame();
+            workload.Frame();
+            ImGui::Render();
+            // The frame's draw data is done with, as in the main loop
+            gs_frame_arena.Reset();
+            times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            vertices += ImGui::GetDrawData()->TotalVtxCount;
+        }
+        gs_count_heap_allocations = false;
+        const double frames = (std::max)(config.frames, 1);
+        result.allocations_per_frame = (double)(gs_benchmark_allocations + gs_heap_allocations - allocations) / frames;
+        result.vertices_per_frame = vertices / frames;
+    }
+    ImGui::SetAllocatorFunctions(gs_benchmark_alloc, gs_benchmark_free, gs_benchmark_user_data);
+    SetBenchmarkTimes(result, times);
+    return result;
+}
 
-#include <tchar.h>
+// Measures the same labels with the scalar and the SSE2 path, both must agree on every label
+static std::vector<ImGuiEx::BenchmarkResult> RunTextMeasureBenchmark(const ImGuiEx::BenchmarkConfig& config)
+{
+    BenchmarkContext context;
+    const ImFont* font = ImGui::GetIO().Fonts->Fonts[0];
 
-static bool gs_exit_application = false;
+    // ASCII labels, Chinese labels and mixed ones, as the widgets show them
+    static const char* const kWords[] = { "Button", "Enable logging", "\xe6\x96\x87\xe4\xbb\xb6", "\xe8\xae\xbe\xe7\xbd\xae\xe9\x80\x89\xe9\xa1\xb9", "Path", "\xe7\xa1\xae\xe5\xae\x9a" };
+    std::vector<std::string> labels;
+    size_t bytes = 0;
+    for (int i = 0; i < config.list_items; i++)
+    {
+        std::string label = kWords[i % 6];
+        label += ' ';
+        label += kWords[(i / 6) % 6];
+        label += " " + std::to_string(i);
+        bytes += label.size();
+        labels.push_back(std::move(label));
+    }
+
+    int mismatches = 0;
+    for (const std::string& label : labels)
+    {
+        const ImVec2 reference = ImGuiEx::internal::CalcTextSizeReference(font, font->FontSize, label.data(), label.data() + label.size());
+        const ImVec2 fast = ImGuiEx::internal::CalcTextSizeFast(font, font->FontSize, label.data(), label.data() + label.size());
+        if (reference.x != fast.x || reference.y != fast.y)
+            mismatches++;
+    }
+    IM_ASSERT(mismatches == 0 && "CalcTextSizeFast disagrees with CalcTextSizeReference");
+
+    std::vector<ImGuiEx::BenchmarkResult> results;
+    for (int fast = 0; fast < 2; fast++)
+    {
+        ImGuiEx::BenchmarkResult result = {};
+        result.name = fast ? "text_measure" : "text_measure_scalar";
+        result.frames = config.frames;
+        std::vector<double> times;
+        float sink = 0.0f;
+        for (int i = 0; i < config.frames; i++)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            for (const std::string& label : labels)
+            {
+                const char* end = label.data() + label.size();
+                sink += fast ? ImGuiEx::internal::CalcTextSizeFast(font, font->FontSize, label.data(), end).x
+                             : ImGuiEx::internal::CalcTextSizeReference(font, font->FontSize, label.data(), end).x;
+            }
+            times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+        SetBenchmarkTimes(result, times);
+        result.throughput_mb_s = result.cpu_ms_mean > 0.0 ? bytes / (result.cpu_ms_mean * 1000.0) : 0.0;
+        // Keeps the loop from being optimized away, labels are never this wide
+        if (sink < 0.0f)
+            result.frames = 0;
+        results.push_back(result);
+    }
+    return results;
+}
+
+// Every hit of a few queries over the folded labels of a long list, as the list filter scans them
+static std::vector<ImGuiEx::BenchmarkResult> RunFindSubstringBenchmark(const ImGuiEx::BenchmarkConfig& config)
+{
+    std::string text;
+    for (int i = 0; i < config.list_items; i++)
+    {
+        text += ImGuiEx::internal::FoldAscii(i % 3 == 0 ? "Enable logging " : i % 3 == 1 ? "Output path " : "Item ");
+        text += std::to_string(i);
+        text += '\0';
+    }
+    // A rare hit, a common one, one first and last byte often match and a miss
+    static const char* const kNeedles[] = { "item 99999", "logging", "p 1", "zz" };
+
+    std::vector<ImGuiEx::BenchmarkResult> results;
+    size_t hits[2] = {};
+    for (int fast = 0; fast < 2; fast++)
+    {
+        ImGuiEx::BenchmarkResult result = {};
+        result.name = fast ? "find_substring" : "find_substring_scalar";
+        result.frames = config.frames;
+        std::vector<double> times;
+        for (int i = 0; i < config.frames; i++)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            for (const char* needle : kNeedles)
+            {
+                const size_t needle_len = strlen(needle);
+                size_t pos = 0;
+                while (pos < text.size())
+                {
+                    const char* hit = fast ? ImGuiEx::internal::FindSubstring(text.data() + pos, text.size() - pos, needle, needle_len)
+                                           : ImGuiEx::internal::FindSubstringScalar(text.data() + pos, text.size() - pos, needle, needle_len);
+                    if (hit == nullptr)
+                        break;
+                    hits[fast]++;
+                    pos = (size_t)(hit - text.data()) + 1;
+                }
+            }
+            times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+        SetBenchmarkTimes(result, times);
+        const double bytes = (double)text.size() * IM_ARRAYSIZE(kNeedles);
+        result.throughput_mb_s = result.cpu_ms_mean > 0.0 ? bytes / (result.cpu_ms_mean * 1000.0) : 0.0;
+        results.push_back(result);
+    }
+    IM_ASSERT(hits[0] == hits[1] && "FindSubstring disagrees with FindSubstringScalar");
+    return results;
+}
+
+// Snapshot of every registered widget and its restore, as an application does on exit and start
+static std::vector<ImGuiEx::BenchmarkResult> RunStateBenchmark(const ImGuiEx::BenchmarkConfig& config)
+{
+    std::vector<std::unique_ptr<ImGuiEx::CheckBox>> widgets;
+    ImGuiEx::StateRegistry registry;
+    for (int i = 0; i < config.state_widgets; i++)
+    {
+        widgets.push_back(std::make_unique<ImGuiEx::CheckBox>("Option " + std::to_string(i), i % 3 == 0));
+        registry.Register(*widgets.back());
+    }
+    std::vector<uint8_t> data;
+    registry.Save(data);
+
+    std::vector<ImGuiEx::BenchmarkResult> results;
+    for (int restore = 0; restore < 2; restore++)
+    {
+        ImGuiEx::BenchmarkResult result = {};
+        result.name = restore ? "state_restore" : "state_save";
+        result.frames = config.frames;
+        std::vector<double> times;
+        for (int i = 0; i < config.frames; i++)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            if (restore)
+                registry.Restore(data.data(), data.size());
+            else
+                registry.Save(data);
+            times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+        IM_ASSERT(registry.GetStats().widgets == (size_t)config.state_widgets);
+        IM_ASSERT(!restore || registry.GetStats().restored == (size_t)config.state_widgets);
+        SetBenchmarkTimes(result, times);
+        result.throughput_mb_s = result.cpu_ms_mean > 0.0 ? data.size() / (result.cpu_ms_mean * 1000.0) : 0.0;
+        results.push_back(result);
+    }
+    return results;
+}
+
+// Tool and viewer in one process, the messages go through a real named shared memory ring
+static ImGuiEx::BenchmarkResult RunDrawStreamBenchmark(const ImGuiEx::BenchmarkConfig& config)
+{
+    ImGuiEx::BenchmarkResult result = {};
+    result.name = "draw_stream";
+    result.frames = config.frames;
+    char name[64];
+    snprintf(name, sizeof(name), "imgui_ex_benchmark_draw_stream_%lu", (unsigned long)::GetCurrentProcessId());
+    SharedRing producer, consumer;
+    if (!producer.Create(name, 8 << 20) || !consumer.Open(name))
+        return result;
+
+    BenchmarkContext context;
+    BenchmarkWindows workload(config);
+    ImGuiEx::internal::DrawStreamEncoder encoder;
+    ImGuiEx::internal::DrawStreamDecoder decoder;
+    std::vector<double> times;
+    double bytes = 0.0;
+    double latency = 0.0;
+    for (int i = -2; i < config.frames; i++)
+    {
+        // The mouse sweeps over the buttons so hover highlights change a few lists every frame
+        ImGui::GetIO().MousePos = ImVec2((float)((i * 37) % 1900), (float)((i * 11) % 1060));
+        ImGui::NewFrame();
+        workload.Frame();
+        ImGui::Render();
+
+        const auto start = std::chrono::steady_clock::now();
+        if (producer.ring.TakeResync())
+            encoder.Reset();
+        encoder.Encode(ImGui::GetDrawData(), ImGui::GetIO().Fonts->TexID, producer.message);
+        if (!producer.ring.Push(producer.message.data(), (uint32_t)producer.message.size()))
+            encoder.Reset();
+        while (consumer.ring.Pop(consumer.message))
+        {
+            if (!decoder.Decode(consumer.message.data(), consumer.message.size()))
+                consumer.ring.RequestResync();
+        }
+        // The first frames send every list in full
+        if (i < 0)
+            continue;
+        times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        bytes += (double)encoder.GetStats().encoded_bytes;
+        latency += decoder.GetStats().latency_ms;
+    }
+    consumer.Close();
+    producer.Close();
+
+    const double frames = (std::max)(config.frames, 1);
+    SetBenchmarkTimes(result, times);
+    result.bytes_per_frame = bytes / frames;
+    result.latency_ms = latency / frames;
+    result.compression_ratio = encoder.GetStats().compression_ratio;
+    return result;
+}
+
+// A tool and its mirror in one process over the shared memory ring, a few widgets change every frame
+static ImGuiEx::BenchmarkResult RunStateDeltaBenchmark(const ImGuiEx::BenchmarkConfig& config)
+{
+    ImGuiEx::BenchmarkResult result = {};
+    result.name = "state_delta";
+    result.frames = config.frames;
+    char name[64];
+    snprintf(name, sizeof(name), "imgui_ex_benchmark_state_delta_%lu", (unsigned long)::GetCurrentProcessId());
+    SharedRing producer, consumer;
+    if (!producer.Create(name, 8 << 20) || !consumer.Open(name))
+        return result;
+
+    std::vector<std::unique_ptr<ImGuiEx::CheckBox>> tool_widgets, mirror_widgets;
+    ImGuiEx::StateRegistry tool, mirror;
+    for (int i = 0; i < config.state_widgets; i++)
+    {
+        const std::string label = "Option " + std::to_string(i);
+        tool_widgets.push_back(std::make_unique<ImGuiEx::CheckBox>(label, i % 3 == 0));
+        mirror_widgets.push_back(std::make_unique<ImGuiEx::CheckBox>(label));
+        tool.Register(*tool_widgets.back());
+        mirror.Register(*mirror_widgets.back());
+    }
+    ImGuiEx::InputText tool_path("Path", 256), mirror_path("Path", 256);
+    tool.Register(tool_path);
+    mirror.Register(mirror_path);
+
+    std::vector<double> times;
+    double bytes = 0.0;
+    double latency = 0.0;
+    uint32_t seed = 1;
+    int mismatches = 0;
+    for (int i = -1; i < config.frames; i++)
+    {
+        // A user toggling a handful of options and typing into one field
+        for (int change = 0; change < 8 && !tool_widgets.empty(); change++)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            ImGuiEx::CheckBox& widget = *tool_widgets[(seed >> 8) % tool_widgets.size()];
+            widget.SetCheck(!widget.GetCheck());
+        }
+        tool_path.SetText("C:\\logs\\run " + std::to_string(i));
+
+        const auto start = std::chrono::steady_clock::now();
+        if (producer.ring.TakeResync())
+            tool.ResetDelta();
+        if (tool.SaveDelta(producer.message) && !producer.ring.Push(producer.message.data(), (uint32_t)producer.message.size()))
+            tool.ResetDelta();
+        while (consumer.ring.Pop(consumer.message))
+        {
+            if (!mirror.ApplyDelta(consumer.message.data(), consumer.message.size()))
+                consumer.ring.RequestResync();
+        }
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        // The first delta holds every widget
+        if (i < 0)
+            continue;
+        times.push_back(ms);
+        bytes += (double)tool.GetStats().delta_bytes;
+        latency += ms;
+    }
+    for (size_t i = 0; i < tool_widgets.size(); i++)
+    {
+        if (tool_widgets[i]->GetCheck() != mirror_widgets[i]->GetCheck())
+            mismatches++;
+    }
+    IM_ASSERT(mismatches == 0 && strcmp(mirror_path.GetText(), tool_path.GetText()) == 0 && "The mirror does not match the tool");
+    (void)mismatches;
+    consumer.Close();
+    producer.Close();
+
+    const double frames = (std::max)(config.frames, 1);
+    SetBenchmarkTimes(result, times);
+    result.bytes_per_frame = bytes / frames;
+    // Save, ring and apply run back to back here, so the frame time is the latency from change to mirror
+    result.latency_ms = latency / frames;
+    return result;
+}
+
+// --benchmark <results.json> [--baseline <baseline.json>], -1 when not asked for.
+// benchmarks/baseline.json is the checked-in baseline, --benchmark benchmarks/baseline.json on the reference machine updates it.
+static int RunBenchmarkCommand()
+{
+    // Quoted paths with spaces are split the way the shell passed them
+    int argc = 0;
+    LPWSTR* argv = ::CommandLineToArgvW(::GetCommandLineW(), &argc);
+    if (argv == nullptr)
+        return -1;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; i++)
+    {
+        const int size = ::WideCharToMultiByte(CP_ACP, 0, argv[i], -1, nullptr, 0, nullptr, nullptr);
+        std::string arg(size > 0 ? size - 1 : 0, '\0');
+        if (size > 1)
+            ::WideCharToMultiByte(CP_ACP, 0, argv[i], -1, &arg[0], size, nullptr, nullptr);
+        args.push_back(arg);
+    }
+    ::LocalFree(argv);
+
+    std::string results_path, baseline_path;
+    for (size_t i = 0; i + 1 < args.size(); i++)
+    {
+        if (args[i] == "--benchmark")
+            results_path = args[i + 1];
+        else if (args[i] == "--baseline")
+            baseline_path = args[i + 1];
+    }
+    if (results_path.empty())
+        return -1;
+
+    const ImGuiEx::BenchmarkConfig config;
+    const std::vector<ImGuiEx::BenchmarkResult> results = ImGuiEx::RunBenchmarks(config);
+    if (!ImGuiEx::WriteBenchmarkJson(results_path.c_str(), results))
+    {
+        fprintf(stderr, "cannot write %s\n", results_path.c_str());
+        return 1;
+    }
+    if (baseline_path.empty())
+        return 0;
+    std::vector<ImGuiEx::BenchmarkResult> baseline;
+    if (!ImGuiEx::ReadBenchmarkJson(baseline_path.c_str(), baseline))
+    {
+        fprintf(stderr, "cannot read %s\n", baseline_path.c_str());
+        return 1;
+    }
+    // stderr for CI logs, the debugger output for runs started from the IDE
+    const std::vector<std::string> regressions = ImGuiEx::FindBenchmarkRegressions(results, baseline, config.tolerance);
+    for (const std::string& regression : regressions)
+    {
+        fprintf(stderr, "%s\n", regression.c_str());
+        ::OutputDebugStringA(regression.c_str());
+        ::OutputDebugStringA("\n");
+    }
+    fflush(stderr);
+    return regressions.empty() ? 0 : 2;
+}
 
+// A pooled window is only hidden, its HWND and swap chain stay alive
+static void HidePooledWindow(ImGuiViewport* viewport)
+{
+    HWND hwnd = (HWND)viewport->PlatformHandle;
+    if (hwnd == nullptr)
+        return;
+    // Transfer capture so a drag started in this window still receives its mouse up
+    if (::GetCapture() == hwnd)
+    {
+        ::ReleaseCapture();
+        ::SetCapture((HWND)ImGui::GetMainViewport()->PlatformHandle);
+    }
+    ::ShowWindow(hwnd, SW_HIDE);
+}
 
 namespace ImGuiEx {
 
-void ExitApplication() {
-    gs_exit_application = true;
+void SetPipelinedRendering(bool enable) {
+    gs_pipelined_rendering = enable;
 }
 
-void SlowDown() {
-    // d3d11֡ķSleepȻ
-    Sleep(10);
+RenderStats GetRenderStats() {
+    return gs_render_pipeline.GetStats();
 }
 
+void SetPlatformWindowPoolSize(int size) {
+    gs_platform_window_pool.SetCapacity(size);
+}
 
-} // namespace ImGuiEx
+PlatformWindowPoolStats GetPlatformWindowPoolStats() {
+    return gs_platform_window_pool.GetStats();
+}
 
+void SetPresentConfig(const PresentConfig& config) {
+    gs_present_config = config;
+    gs_present_config_dirty = true;
+}
 
-// Data
-static ID3D11Device* g_pd3dDevice = nullptr;
-static ID3D11DeviceContext* g_pd3dDeviceContext = nullptr;
-static IDXGISwapChain* g_pSwapChain = nullptr;
-static UINT                     g_ResizeWidth = 0, g_ResizeHeight = 0;
-static ID3D11RenderTargetView* g_mainRenderTargetView = nullptr;
+PresentConfig GetPresentConfig() {
+    return gs_present_config;
+}
 
-// Forward declarations of helper functions
-static bool CreateDeviceD3D(HWND hWnd);
-static void CleanupDeviceD3D();
-static void CreateRenderTarget();
-static void CleanupRenderTarget();
-static LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
+PresentStats GetPresentStats() {
+    return gs_present_pacer.GetStats();
+}
+
+ResizeStats GetResizeStats() {
+    return gs_resize_policy.GetStats();
+}
+
+void SetOverlayMode(bool enable) {
+    gs_overlay_mode = enable;
+}
+
+void InvalidateOverlay() {
+    gs_overlay_regions.Invalidate();
+}
+
+bool StartStateMirror(const char* name, uint32_t capacity) {
+    return gs_state_mirror.Create(name, capacity);
+}
+
+bool ConnectStateMirror(const char* name) {
+    return gs_state_mirror.Open(name);
+}
+
+void StopStateMirror() {
+    gs_state_mirror.Close();
+}
+
+bool StartDrawStream(const char* name, uint32_t capacity) {
+    gs_draw_encoder.Reset();
+    return gs_draw_stream.Create(name, capacity);
+}
+
+bool ConnectDrawStream(const char* name) {
+    gs_draw_decoder.Reset();
+    return gs_draw_stream.Open(name);
+}
+
+void StopDrawStream() {
+    gs_draw_stream.Close();
+    gs_draw_decoder.Reset();
+}
+
+DrawStreamStats GetDrawStreamStats() {
+    return gs_draw_stream.IsConsumer() ? gs_draw_decoder.GetStats() : gs_draw_encoder.GetStats();
+}
+
+ImVec2 CalcTextSize(const char* text, const char* text_end, bool hide_text_after_double_hash) {
+    ImGuiContext& g = *ImGui::GetCurrentContext();
+    return internal::CalcTextSizeRounded(g.Font, g.FontSize, text, text_end, hide_text_after_double_hash);
+}
+
+std::vector<BenchmarkResult> RunBenchmarks(const BenchmarkConfig& config) {
+    std::vector<BenchmarkResult> results;
+    results.push_back(RunBenchmark<BenchmarkWindows>("windows", config));
+    results.push_back(RunBenchmark<BenchmarkLists>("lists", config));
+    results.push_back(RunBenchmark<BenchmarkListUpdate<false>>("list_set", config));
+    results.push_back(RunBenchmark<BenchmarkListUpdate<true>>("list_update_keyed", config));
+    results.push_back(RunBenchmark<BenchmarkListFormat<false>>("list_format", config));
+    results.push_back(RunBenchmark<BenchmarkListFormat<true>>("list_format_arena", config));
+    results.push_back(RunBenchmark<BenchmarkText>("text", config));
+    results.push_back(RunBenchmark<BenchmarkTree>("tree", config));
+    results.push_back(RunBenchmark<BenchmarkStaticPage<false>>("static_page", config));
+    results.push_back(RunBenchmark<BenchmarkStaticPage<true>>("static_page_cached", config));
+    results.push_back(RunBenchmark<BenchmarkLabelForm<false>>("label_form", config));
+    results.push_back(RunBenchmark<BenchmarkLabelForm<true>>("label_form_cached", config));
+    results.push_back(RunBenchmark<BenchmarkPlot>("plot", config));
+    results.push_back(RunBenchmark<BenchmarkTable>("table", config));
+    results.push_back(RunBenchmark<BenchmarkPanel<false>>("panel_hand", config));
+    results.push_back(RunBenchmark<BenchmarkPanel<true>>("panel_composed", config));
+    results.push_back(RunBenchmark<BenchmarkLayout<false>>("layout_hand", config));
+    results.push_back(RunBenchmark<BenchmarkLayout<true>>("layout_program", config));
+    const std::vector<BenchmarkResult> text_results = RunTextMeasureBenchmark(config);
+    results.insert(results.end(), text_results.begin(), text_results.end());
+    const std::vector<BenchmarkResult> find_results = RunFindSubstringBenchmark(config);
+    results.insert(results.end(), find_results.begin(), find_results.end());
+    results.push_back(RunDrawStreamBenchmark(config));
+    results.push_back(RunStateDeltaBenchmark(config));
+    const std::vector<BenchmarkResult> state_results = RunStateBenchmark(config);
+    results.insert(results.end(), state_results.begin(), state_results.end());
+    return results;
+}
+
+bool WriteBenchmarkJson(const char* path, const std::vector<BenchmarkResult>& results) {
+    FILE* file = fopen(path, "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    fprintf(file, "{\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchmarkResult& result = results[i];
+        fprintf(file, "    { \"name\": \"%s\", \"frames\": %d, \"cpu_ms_mean\": %.6f, \"cpu_ms_p95\": %.6f, \"allocations_per_frame\": %.3f, \"vertices_per_frame\": %.1f, \"throughput_mb_s\": %.1f, "
+            "\"bytes_per_frame\": %.1f, \"latency_ms\": %.6f, \"compression_ratio\": %.2f }%s\n",
+            result.name.c_str(), result.frames, result.cpu_ms_mean, result.cpu_ms_p95, result.allocations_per_frame, result.vertices_per_frame,
+            result.throughput_mb_s, result.bytes_per_frame, result.latency_ms, result.compression_ratio, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    return fclose(file) == 0;
+}
+
+// Reads back what WriteBenchmarkJson wrote, one flat object per benchmark.
+// Metrics missing from an object read as NaN, FindBenchmarkRegressions reports them.
+bool ReadBenchmarkJson(const char* path, std::vector<BenchmarkResult>& results) {
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    std::string json;
+    char buffer[4096];
+    size_t size;
+    while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        json.append(buffer, size);
+    }
+    fclose(file);
+
+    results.clear();
+    auto number = [](const std::string& object, const char* key) {
+        const size_t at = object.find(std::string("\"") + key + "\"");
+        const size_t colon = at == std::string::npos ? std::string::npos : object.find(':', at);
+        return colon == std::string::npos ? std::numeric_limits<double>::quiet_NaN() : strtod(object.c_str() + colon + 1, nullptr);
+    };
+    size_t begin = json.find('[');
+    while (begin != std::string::npos && (begin = json.find('{', begin)) != std::string::npos) {
+        const size_t end = json.find('}', begin);
+        if (end == std::string::npos) {
+            return false;
+        }
+        const std::string object = json.substr(begin, end - begin);
+        BenchmarkResult result = {};
+        const size_t name = object.find("\"name\"");
+        const size_t quote = name == std::string::npos ? std::string::npos : object.find('"', object.find(':', name));
+        if (quote == std::string::npos) {
+            return false;
+        }
+        result.name = object.substr(quote + 1, object.find('"', quote + 1) - quote - 1);
+        const double frames = number(object, "frames");
+        result.frames = frames == frames ? (int)frames : 0;
+        result.cpu_ms_mean = number(object, "cpu_ms_mean");
+        result.cpu_ms_p95 = number(object, "cpu_ms_p95");
+        result.allocations_per_frame = number(object, "allocations_per_frame");
+        result.vertices_per_frame = number(object, "vertices_per_frame");
+        result.throughput_mb_s = number(object, "throughput_mb_s");
+        result.bytes_per_frame = number(object, "bytes_per_frame");
+        result.latency_ms = number(object, "latency_ms");
+        result.compression_ratio = number(object, "compression_ratio");
+        results.push_back(result);
+        begin = end + 1;
+    }
+    return true;
+}
+
+std::vector<std::string> FindBenchmarkRegressions(const std::vector<BenchmarkResult>& results, const std::vector<BenchmarkResult>& baseline, double tolerance) {
+    std::vector<std::string> regressions;
+    // NaN compares false against anything, a baseline without the metric would pass every run
+    auto missing = [&](const std::string& name, const char* metric, double base) {
+        if (base == base) {
+            return false;
+        }
+        regressions.push_back(name + " " + metric + ": missing from the baseline, regenerate it with --benchmark");
+        return true;
+    };
+    auto check = [&](const std::string& name, const char* metric, double value, double base, double slack) {
+        // The slack keeps near zero baselines from failing on noise
+        if (missing(name, metric, base)) {
+            return;
+        }
+        if (value > base * (1.0 + tolerance) + slack) {
+            char line[256];
+            snprintf(line, sizeof(line), "%s %s: %.3f, baseline %.3f", name.c_str(), metric, value, base);
+            regressions.push_back(line);
+        }
+    };
+    auto check_drop = [&](const std::string& name, const char* metric, double value, double base) {
+        if (missing(name, metric, base)) {
+            return;
+        }
+        if (value < base * (1.0 - tolerance)) {
+            char line[256];
+            snprintf(line, sizeof(line), "%s %s: %.1f, baseline %.1f", name.c_str(), metric, value, base);
+            regressions.push_back(line);
+        }
+    };
+    // A workload dropped or renamed since the baseline would otherwise pass silently
+    for (const BenchmarkResult& base : baseline) {
+        if (std::find_if(results.begin(), results.end(), [&](const BenchmarkResult& result) { return result.name == base.name; }) == results.end()) {
+            regressions.push_back(base.name + " missing from the results");
+        }
+    }
+    for (const BenchmarkResult& result : results) {
+        auto base = std::find_if(baseline.begin(), baseline.end(), [&](const BenchmarkResult& base) { return base.name == result.name; });
+        if (base == baseline.end()) {
+            continue;
+        }
+        check(result.name, "cpu_ms_mean", result.cpu_ms_mean, base->cpu_ms_mean, 0.01);
+        check(result.name, "cpu_ms_p95", result.cpu_ms_p95, base->cpu_ms_p95, 0.02);
+        check(result.name, "allocations_per_frame", result.allocations_per_frame, base->allocations_per_frame, 0.5);
+        check(result.name, "vertices_per_frame", result.vertices_per_frame, base->vertices_per_frame, 0.5);
+        check(result.name, "bytes_per_frame", result.bytes_per_frame, base->bytes_per_frame, 16.0);
+        check(result.name, "latency_ms", result.latency_ms, base->latency_ms, 0.02);
+        check_drop(result.name, "throughput_mb_s", result.throughput_mb_s, base->throughput_mb_s);
+        check_drop(result.name, "compression_ratio", result.compression_ratio, base->compression_ratio);
+    }
+    return regressions;
+}
+
+OverlayStats GetOverlayStats() {
+    OverlayStats stats = {};
+    stats.enabled = gs_overlay_active;
+    stats.click_through = gs_overlay_click_through;
+    stats.regions = (int)gs_overlay_regions.GetRegions().size();
+    stats.layout_changes = gs_overlay_regions.GetRebuildCount();
+    stats.click_through_toggles = gs_overlay_toggles;
+    stats.frames_presented = gs_overlay_presented;
+    stats.frames_skipped = gs_overlay_skipped;
+    return stats;
+}
+
+} // namespace ImGuiEx
 
 // Main code
 int WinMain(
@@ -57,6 +2181,11 @@ int WinMain(
     LPSTR     lpCmdLine,
     int       nShowCmd)
 {
+    // Headless benchmark run, no window or device is created
+    const int benchmark_exit_code = RunBenchmarkCommand();
+    if (benchmark_exit_code != -1)
+        return benchmark_exit_code;
+
     // Create application window
     //ImGui_ImplWin32_EnableDpiAwareness();
     WNDCLASSEXW wc = { sizeof(wc), CS_CLASSDC, WndProc, 0L, 0L, GetModuleHandle(nullptr), nullptr, nullptr, nullptr, nullptr, L"ImGui Example", nullptr };
@@ -90,6 +2219,16 @@ int WinMain(
 
     // Setup Dear ImGui context
     IMGUI_CHECKVERSION();
+#ifdef IMGUI_EX_MEMORY_STATS
+    {
+        // Replacing the hooks now would hand MemoryFree blocks without a header
+        ImGuiMemAllocFunc alloc_func;
+        ImGuiMemFreeFunc free_func;
+        void* user_data;
+        ImGui::GetAllocatorFunctions(&alloc_func, &free_func, &user_data);
+        IM_ASSERT(alloc_func == MemoryAlloc && free_func == MemoryFree);
+    }
+#endif
     ImGui::CreateContext();
     ImGuiIO& io = ImGui::GetIO(); (void)io;
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;     // Enable Keyboard Controls
@@ -109,7 +2248,10 @@ int WinMain(
     ImGui::StyleColorsDark();
     //ImGui::StyleColorsLight();
 
-    ImGuiInit();
+    {
+        ImGuiEx::MemoryScope memory_scope(ImGuiEx::MemoryTag_Widgets);
+        ImGuiInit();
+    }
 
 
     // When viewports are enabled we tweak WindowRounding/WindowBg so platform windows can look identical to regular ones.
@@ -123,6 +2265,8 @@ int WinMain(
     // Setup Platform/Renderer backends
     ImGui_ImplWin32_Init(hwnd);
     ImGui_ImplDX11_Init(g_pd3dDevice, g_pd3dDeviceContext);
+    if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
+        gs_platform_window_pool.Install(ImGui::GetPlatformIO(), HidePooledWindow);
 
     // Load Fonts
     // - If no fonts are loaded, dear imgui will use the default font. You can also load multiple fonts and use ImGui::PushFont()/PopFont() to select them.
@@ -151,52 +2295,176 @@ int WinMain(
     {
         // Poll and handle messages (inputs, window resize, etc.)
         // See the WndProc() function below for our to dispatch events to the Win32 backend.
+        // Mouse moves and wheel ticks are held back so high rate ones collapse, everything else is dispatched right away.
+        // With a latency waitable swap chain this blocks until a frame can be queued, so input is read as late as possible
+        gs_present_pacer.WaitForFrame();
+        const auto frame_start = std::chrono::steady_clock::now();
+        const DWORD pump_tick = ::GetTickCount();
+        auto dispatch = [](const ImGuiEx::InputMessage& message) {
+            MSG queued = {};
+            queued.hwnd = (HWND)message.window;
+            queued.message = message.message;
+            queued.wParam = (WPARAM)message.wparam;
+            queued.lParam = (LPARAM)message.lparam;
+            queued.time = message.time;
+            queued.pt.x = message.x;
+            queued.pt.y = message.y;
+            ::DispatchMessage(&queued);
+        };
         MSG msg;
         while (::PeekMessage(&msg, nullptr, 0U, 0U, PM_REMOVE))
         {
             ::TranslateMessage(&msg);
-            ::DispatchMessage(&msg);
             if (msg.message == WM_QUIT)
                 done = true;
+            if (IsInputMessage(msg.message))
+            {
+                // The message time tells how long the input waited in the queue
+                DWORD queued_ms = pump_tick - msg.time;
+                if (queued_ms > 1000)
+                    queued_ms = 0;
+                gs_present_pacer.GetLatencyTracker().Input(frame_start - std::chrono::milliseconds(queued_ms));
+            }
+            const ImGuiEx::InputMessageKind kind = gs_input_coalescing ? ClassifyInputMessage(msg.message) : ImGuiEx::InputMessageKind_Other;
+            gs_input_coalescer.Push(ImGuiEx::InputMessage{ msg.hwnd, msg.message, msg.wParam, msg.lParam, (uint32_t)msg.time, (int32_t)msg.pt.x, (int32_t)msg.pt.y, kind }, dispatch);
         }
+        gs_input_coalescer.Flush(dispatch);
+        gs_input_coalescer.SetPumpTime(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frame_start).count());
         if (done)
             break;
 
+        gs_render_pipeline.SetEnabled(gs_pipelined_rendering);
+
+        // The overlay needs a swap chain with alpha, the window resize arrives as a regular WM_SIZE
+        if (gs_overlay_mode != gs_overlay_active)
+        {
+            gs_render_pipeline.WaitIdle();
+            ApplyOverlayMode(hwnd, gs_overlay_mode);
+            gs_present_config_dirty = true;
+        }
+
+        if (gs_present_config_dirty)
+        {
+            gs_render_pipeline.WaitIdle();
+            CleanupSwapChain();
+            gs_present_config_dirty = false;
+            if (!CreateSwapChain(hwnd))
+                break;
+            gs_overlay_regions.Invalidate();
+        }
+
         // Handle window resize (we don't resize directly in the WM_SIZE handler)
+        // A drag resize reports a size every frame, the policy decides when the buffers are really reallocated
+        const double now_ms = std::chrono::duration<double, std::milli>(frame_start.time_since_epoch()).count();
         if (g_ResizeWidth != 0 && g_ResizeHeight != 0)
         {
-            CleanupRenderTarget();
-            g_pSwapChain->ResizeBuffers(0, g_ResizeWidth, g_ResizeHeight, DXGI_FORMAT_UNKNOWN, 0);
+            gs_resize_policy.Request((int)g_ResizeWidth, (int)g_ResizeHeight, now_ms);
             g_ResizeWidth = g_ResizeHeight = 0;
-            CreateRenderTarget();
+        }
+        ImGuiEx::internal::ResizePolicy::Action resize;
+        if (gs_resize_policy.Update(now_ms, resize))
+        {
+            gs_render_pipeline.WaitIdle();
+            if (resize.reallocate)
+            {
+                CleanupRenderTarget();
+                g_pSwapChain->ResizeBuffers(0, (UINT)resize.buffer_width, (UINT)resize.buffer_height, DXGI_FORMAT_UNKNOWN, g_SwapChainFlags);
+                CreateRenderTarget();
+            }
+            // ImGui renders into the top left corner of the buffers, only that region is presented
+            if (resize.change_region)
+                SetSwapChainSourceSize((UINT)resize.width, (UINT)resize.height);
+            gs_overlay_regions.Invalidate();
         }
 
         // Start the Dear ImGui frame
-        ImGui_ImplDX11_NewFrame();
+        {
+            // The font atlas is built by the first NewFrame
+            ImGuiEx::MemoryScope memory_scope(ImGuiEx::MemoryTag_Fonts);
+            ImGui_ImplDX11_NewFrame();
+        }
         ImGui_ImplWin32_NewFrame();
         ImGui::NewFrame();
+#ifdef IMGUI_EX_PROFILER
+        ImGuiEx::GetProfiler().NewFrame();
+#endif
 
 
-        ImGuiUpdate();
+        {
+            ImGuiEx::MemoryScope memory_scope(ImGuiEx::MemoryTag_Widgets);
+            ReceiveStateMirror();
+            ImGuiUpdate();
+            SendStateMirror();
+        }
 
 
         // Rendering
+        ImGuiEx::MemoryScope memory_scope(ImGuiEx::MemoryTag_DrawLists);
 
         ImGui::Render();
-        const float clear_color_with_alpha[4] = { clear_color.x * clear_color.w, clear_color.y * clear_color.w, clear_color.z * clear_color.w, clear_color.w };
-        g_pd3dDeviceContext->OMSetRenderTargets(1, &g_mainRenderTargetView, nullptr);
-        g_pd3dDeviceContext->ClearRenderTargetView(g_mainRenderTargetView, clear_color_with_alpha);
-        ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
+        SendDrawStream();
+        ReceiveDrawStream();
+        const ImVec4 background = gs_overlay_active ? ImVec4(0.0f, 0.0f, 0.0f, 0.0f) : clear_color;
+        const float clear_color_with_alpha[4] = { background.x * background.w, background.y * background.w, background.z * background.w, background.w };
+        gs_present_pacer.GetLatencyTracker().Latch();
+
+        // An overlay that shows the same pixels as the last frame is not presented again
+        bool skip_frame = false;
+        if (gs_overlay_active)
+        {
+            ImGuiEx::internal::CollectOverlayWindows(gs_overlay_regions, ImGui::GetMainViewport());
+            UpdateOverlayClickThrough(hwnd);
+            skip_frame = !gs_overlay_regions.IsDirty() && ImGui::GetPlatformIO().Viewports.Size == 1;
+            if (skip_frame)
+                gs_overlay_skipped++;
+            else
+            {
+                gs_overlay_regions.Presented();
+                gs_overlay_presented++;
+            }
+        }
 
-        // Update and Render additional Platform Windows
-        if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
+        if (skip_frame)
         {
-            ImGui::UpdatePlatformWindows();
-            ImGui::RenderPlatformWindowsDefault();
+            if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
+            {
+                gs_render_pipeline.WaitIdle();
+                ImGui::UpdatePlatformWindows();
+            }
         }
+        else if (gs_render_pipeline.IsRunning())
+        {
+            // Platform windows get created, resized and destroyed here, the previous frame must be done with them
+            if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
+            {
+                gs_render_pipeline.WaitIdle();
+                ImGui::UpdatePlatformWindows();
+            }
+            gs_render_pipeline.Submit(clear_color_with_alpha, frame_start, (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable) != 0);
+        }
+        else
+        {
+            const auto render_start = std::chrono::steady_clock::now();
+            g_pd3dDeviceContext->OMSetRenderTargets(1, &g_mainRenderTargetView, nullptr);
+            g_pd3dDeviceContext->ClearRenderTargetView(g_mainRenderTargetView, clear_color_with_alpha);
+            ImGui_ImplDX11_RenderDrawData(GetMainDrawData());
+
+            // Update and Render additional Platform Windows
+            if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
+            {
+                ImGui::UpdatePlatformWindows();
+                ImGui::RenderPlatformWindowsDefault();
+            }
 
-        g_pSwapChain->Present(1, 0); // Present with vsync
-        //g_pSwapChain->Present(0, 0); // Present without vsync
+            gs_present_pacer.Present(); // Sync interval and tearing from SetPresentConfig
+            gs_render_pipeline.RecordFrame(frame_start, render_start);
+        }
+
+        // The draw data has been rendered or copied, nothing refers to this frame's transient data anymore
+        gs_frame_arena.Reset();
+#ifdef IMGUI_EX_MEMORY_STATS
+        EndMemoryFrame();
+#endif
 
         if (gs_exit_application) {
             break;
@@ -205,12 +2473,20 @@ int WinMain(
         ImGuiEx::SlowDown();
     }
 
+    gs_render_pipeline.Stop();
+    gs_platform_window_pool.Uninstall();
+    ImGuiEx::StopStateMirror();
+    ImGuiEx::StopDrawStream();
+
     ImGuiExit();
 
     // Cleanup
     ImGui_ImplDX11_Shutdown();
     ImGui_ImplWin32_Shutdown();
     ImGui::DestroyContext();
+#ifdef IMGUI_EX_MEMORY_STATS
+    ReportMemoryLeaks(false);
+#endif
 
     CleanupDeviceD3D();
     ::DestroyWindow(hwnd);
@@ -222,41 +2498,150 @@ int WinMain(
 // Helper functions
 static bool CreateDeviceD3D(HWND hWnd)
 {
-    // Setup swap chain
-    DXGI_SWAP_CHAIN_DESC sd;
-    ZeroMemory(&sd, sizeof(sd));
-    sd.BufferCount = 2;
-    sd.BufferDesc.Width = 0;
-    sd.BufferDesc.Height = 0;
-    sd.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-    sd.BufferDesc.RefreshRate.Numerator = 60;
-    sd.BufferDesc.RefreshRate.Denominator = 1;
-    sd.Flags = DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH;
-    sd.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
-    sd.OutputWindow = hWnd;
-    sd.SampleDesc.Count = 1;
-    sd.SampleDesc.Quality = 0;
-    sd.Windowed = TRUE;
-    sd.SwapEffect = DXGI_SWAP_EFFECT_DISCARD;
-
     UINT createDeviceFlags = 0;
     //createDeviceFlags |= D3D11_CREATE_DEVICE_DEBUG;
     D3D_FEATURE_LEVEL featureLevel;
     const D3D_FEATURE_LEVEL featureLevelArray[2] = { D3D_FEATURE_LEVEL_11_0, D3D_FEATURE_LEVEL_10_0, };
-    HRESULT res = D3D11CreateDeviceAndSwapChain(nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr, createDeviceFlags, featureLevelArray, 2, D3D11_SDK_VERSION, &sd, &g_pSwapChain, &g_pd3dDevice, &featureLevel, &g_pd3dDeviceContext);
+    HRESULT res = D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr, createDeviceFlags, featureLevelArray, 2, D3D11_SDK_VERSION, &g_pd3dDevice, &featureLevel, &g_pd3dDeviceContext);
     if (res == DXGI_ERROR_UNSUPPORTED) // Try high-performance WARP software driver if hardware is not available.
-        res = D3D11CreateDeviceAndSwapChain(nullptr, D3D_DRIVER_TYPE_WARP, nullptr, createDeviceFlags, featureLevelArray, 2, D3D11_SDK_VERSION, &sd, &g_pSwapChain, &g_pd3dDevice, &featureLevel, &g_pd3dDeviceContext);
+        res = D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_WARP, nullptr, createDeviceFlags, featureLevelArray, 2, D3D11_SDK_VERSION, &g_pd3dDevice, &featureLevel, &g_pd3dDeviceContext);
     if (res != S_OK)
         return false;
 
+    return CreateSwapChain(hWnd);
+}
+
+// Setup swap chain from the present config, what the system lacks falls back to the legacy blt model
+static bool CreateSwapChain(HWND hWnd)
+{
+    IDXGIDevice* dxgiDevice = nullptr;
+    IDXGIAdapter* dxgiAdapter = nullptr;
+    IDXGIFactory* dxgiFactory = nullptr;
+    if (FAILED(g_pd3dDevice->QueryInterface(IID_PPV_ARGS(&dxgiDevice))))
+        return false;
+    dxgiDevice->GetAdapter(&dxgiAdapter);
+    dxgiAdapter->GetParent(IID_PPV_ARGS(&dxgiFactory));
+    dxgiAdapter->Release();
+
+    // Flip discard came with DXGI 1.4 (Windows 10), tearing with DXGI 1.5
+    ImGuiEx::PresentCaps caps = {};
+    IDXGIFactory4* dxgiFactory4 = nullptr;
+    if (SUCCEEDED(dxgiFactory->QueryInterface(IID_PPV_ARGS(&dxgiFactory4))))
+    {
+        caps.flip_model = true;
+        caps.waitable = true;
+        dxgiFactory4->Release();
+    }
+    IDXGIFactory5* dxgiFactory5 = nullptr;
+    if (SUCCEEDED(dxgiFactory->QueryInterface(IID_PPV_ARGS(&dxgiFactory5))))
+    {
+        BOOL allowTearing = FALSE;
+        caps.tearing = SUCCEEDED(dxgiFactory5->CheckFeatureSupport(DXGI_FEATURE_PRESENT_ALLOW_TEARING, &allowTearing, sizeof(allowTearing))) && allowTearing;
+        dxgiFactory5->Release();
+    }
+    // Flip model swap chains of a window ignore the alpha channel, the overlay stays on blt
+    if (gs_overlay_active)
+        caps = {};
+    ImGuiEx::PresentPolicy policy = ImGuiEx::internal::ResolvePresentPolicy(gs_present_config, caps);
+
+    HRESULT res = E_FAIL;
+    for (int attempt = 0; attempt < 2 && FAILED(res); attempt++)
+    {
+        if (attempt == 1)
+        {
+            if (!policy.flip_model)
+                break;
+            caps = {};
+            policy = ImGuiEx::internal::ResolvePresentPolicy(gs_present_config, caps);
+        }
+        DXGI_SWAP_CHAIN_DESC sd;
+        ZeroMemory(&sd, sizeof(sd));
+        sd.BufferCount = (UINT)policy.buffer_count;
+        sd.BufferDesc.Width = 0;
+        sd.BufferDesc.Height = 0;
+        sd.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        sd.BufferDesc.RefreshRate.Numerator = 0;
+        sd.BufferDesc.RefreshRate.Denominator = 1;
+        sd.Flags = policy.flip_model ? 0 : DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH;
+        if (policy.tearing)
+            sd.Flags |= DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING;
+        if (policy.waitable)
+            sd.Flags |= DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
+        sd.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+        sd.OutputWindow = hWnd;
+        sd.SampleDesc.Count = 1;
+        sd.SampleDesc.Quality = 0;
+        sd.Windowed = TRUE;
+        sd.SwapEffect = policy.flip_model ? DXGI_SWAP_EFFECT_FLIP_DISCARD : DXGI_SWAP_EFFECT_DISCARD;
+        res = dxgiFactory->CreateSwapChain(g_pd3dDevice, &sd, &g_pSwapChain);
+        g_SwapChainFlags = sd.Flags;
+    }
+    // Tearing is only allowed in windowed mode
+    if (SUCCEEDED(res) && policy.flip_model)
+        dxgiFactory->MakeWindowAssociation(hWnd, DXGI_MWA_NO_ALT_ENTER);
+    dxgiFactory->Release();
+    if (FAILED(res))
+    {
+        dxgiDevice->Release();
+        return false;
+    }
+
+    if (policy.waitable)
+    {
+        IDXGISwapChain2* swapChain2 = nullptr;
+        if (SUCCEEDED(g_pSwapChain->QueryInterface(IID_PPV_ARGS(&swapChain2))))
+        {
+            swapChain2->SetMaximumFrameLatency((UINT)policy.max_frame_latency);
+            g_FrameLatencyWaitable = swapChain2->GetFrameLatencyWaitableObject();
+            swapChain2->Release();
+        }
+        policy.waitable = g_FrameLatencyWaitable != nullptr;
+    }
+    else if (policy.max_frame_latency > 0)
+    {
+        IDXGIDevice1* dxgiDevice1 = nullptr;
+        if (SUCCEEDED(dxgiDevice->QueryInterface(IID_PPV_ARGS(&dxgiDevice1))))
+        {
+            dxgiDevice1->SetMaximumFrameLatency((UINT)policy.max_frame_latency);
+            dxgiDevice1->Release();
+        }
+    }
+    dxgiDevice->Release();
+    gs_present_pacer.SetPolicy(policy);
+
+    DXGI_SWAP_CHAIN_DESC desc;
+    g_pSwapChain->GetDesc(&desc);
+    IDXGISwapChain2* swapChain2 = nullptr;
+    const bool sourceSize = policy.flip_model && SUCCEEDED(g_pSwapChain->QueryInterface(IID_PPV_ARGS(&swapChain2)));
+    if (swapChain2)
+        swapChain2->Release();
+    gs_resize_policy.Reset((int)desc.BufferDesc.Width, (int)desc.BufferDesc.Height, sourceSize);
+
     CreateRenderTarget();
     return true;
 }
 
-static void CleanupDeviceD3D()
+// Presents only a region of larger buffers, flip model swap chains only
+static void SetSwapChainSourceSize(UINT width, UINT height)
+{
+    IDXGISwapChain2* swapChain2 = nullptr;
+    if (SUCCEEDED(g_pSwapChain->QueryInterface(IID_PPV_ARGS(&swapChain2))))
+    {
+        swapChain2->SetSourceSize(width, height);
+        swapChain2->Release();
+    }
+}
+
+static void CleanupSwapChain()
 {
     CleanupRenderTarget();
+    if (g_FrameLatencyWaitable) { ::CloseHandle(g_FrameLatencyWaitable); g_FrameLatencyWaitable = nullptr; }
     if (g_pSwapChain) { g_pSwapChain->Release(); g_pSwapChain = nullptr; }
+}
+
+static void CleanupDeviceD3D()
+{
+    CleanupSwapChain();
     if (g_pd3dDeviceContext) { g_pd3dDeviceContext->Release(); g_pd3dDeviceContext = nullptr; }
     if (g_pd3dDevice) { g_pd3dDevice->Release(); g_pd3dDevice = nullptr; }
 }
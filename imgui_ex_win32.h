@@ -2,9 +2,38 @@
 #define IMGUI_IMGUI_EX_WIN32_H_
 
 #include <unordered_map>
+#include <vector>
 #include <string>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <memory>
+#include <new>
+#include <deque>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <chrono>
+
+#if defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define IMGUI_EX_SSE2 1
+#include <emmintrin.h>
+#else
+#define IMGUI_EX_SSE2 0
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 #include <exception>
 #include <functional>
+#include <tuple>
+#include <type_traits>
+#include <filesystem>
 
 #ifndef IMGUI_EX_CPP
 #include <imgui/imgui.h>
@@ -13,10 +42,12 @@
 #include <imgui/imstb_rectpack.h>
 #include <imgui/imstb_textedit.h>
 
+#ifdef _WIN32
 #include <imgui/backends/imgui_impl_dx11.h>
 #include <imgui/backends/imgui_impl_win32.h>
 #include <d3d11.h>
 #endif
+#endif
 
 void ImGuiInit();
 void ImGuiUpdate();
@@ -28,6 +59,8 @@ void ExitApplication();
 void SlowDown();
 
 namespace internal {
+// Everything but these helpers and the application in imgui_ex_win32.cpp builds without Windows, the tests run on any platform
+#ifdef _WIN32
 static HWND GetWindowHwnd(ImGuiWindow* window) {
     if (window == nullptr) return NULL;
     return (HWND)window->Viewport->PlatformHandle;
@@ -51,932 +84,7036 @@ static bool SetWindowTop(ImGuiWindow* window, bool top) {
     }
     return true;
 }
+#else
+static bool SetWindowTop(ImGuiWindow* window, bool top) {
+    return false;
+}
+#endif
 } // namespace internal
 
 
-class Expandable {
+/*
+* Input
+* The message pump dispatches every message as soon as it is taken from the queue, only mouse moves and
+* wheel ticks are held back. One of those is folded into the held message right before it when both are
+* the same kind for the same window. Held messages go out before the next other message and when the
+* queue is empty, so clicks, keys and ordering are untouched, and GetMessagePos / GetMessageExtraInfo
+* still describe the message being dispatched for everything but the folded ones.
+*/
+enum InputMessageKind {
+    InputMessageKind_Other,
+    InputMessageKind_MouseMove,
+    InputMessageKind_MouseWheel,
+    InputMessageKind_MouseHWheel,
+};
+
+// Platform message in Win32 layout: wheel messages carry their delta in the high word of wparam
+struct InputMessage {
+    void* window;
+    uint32_t message;
+    uintptr_t wparam;
+    intptr_t lparam;
+    uint32_t time;
+    int32_t x;              // cursor position when the message was queued, screen coordinates
+    int32_t y;
+    InputMessageKind kind;
+};
+
+struct InputStats {
+    uint32_t received;      // messages taken from the queue last frame
+    uint32_t dispatched;    // messages left after coalescing
+    double pump_ms;         // time spent in the pump last frame
+};
+
+namespace internal {
+class InputCoalescer {
 public:
-    Expandable() {
-        end_expand_ = false;
-        expand_ = false;
+    InputCoalescer() {
+        received_ = 0;
+        dispatched_ = 0;
     }
 
-    void ExpandUpdate(std::function<void()> update) {
-        if (expand_ == true) { 
-            update(); 
+    template<class Dispatch>
+    void Push(const InputMessage& message, Dispatch&& dispatch) {
+        received_++;
+        if (message.kind == InputMessageKind_Other) {
+            DispatchHeld(dispatch);
+            dispatch(message);
+            dispatched_++;
+            return;
+        }
+        if (!queue_.empty()) {
+            InputMessage& tail = queue_.back();
+            if (tail.kind == message.kind && tail.window == message.window && tail.message == message.message) {
+                if (message.kind == InputMessageKind_MouseMove) {
+                    // Button state lives in wparam, a move across a button change stays separate
+                    if (tail.wparam == message.wparam) {
+                        tail.lparam = message.lparam;
+                        tail.time = message.time;
+                        tail.x = message.x;
+                        tail.y = message.y;
+                        return;
+                    }
+                }
+                else if ((tail.wparam & 0xffff) == (message.wparam & 0xffff)) {
+                    int delta = (int)(int16_t)(uint16_t)(tail.wparam >> 16) + (int)(int16_t)(uint16_t)(message.wparam >> 16);
+                    delta = (std::max)(-32768, (std::min)(32767, delta));
+                    tail.wparam = (tail.wparam & 0xffff) | ((uintptr_t)(uint16_t)(int16_t)delta << 16);
+                    tail.lparam = message.lparam;
+                    tail.time = message.time;
+                    tail.x = message.x;
+                    tail.y = message.y;
+                    return;
+                }
+            }
         }
+        queue_.push_back(message);
     }
 
-    void CollapsingUpdate(std::function<void()> update) {
-        if (expand_ == false) {
-            update();
-        }
+    // End of the pump: dispatches the held messages and closes the frame's stats
+    template<class Dispatch>
+    void Flush(Dispatch&& dispatch) {
+        DispatchHeld(dispatch);
+        stats_.received = received_;
+        stats_.dispatched = dispatched_;
+        received_ = 0;
+        dispatched_ = 0;
     }
 
-    void ExpandEvent(std::function<void()> event) { \
-        if (expand_ == true && expand_ != end_expand_) {
-            event();
-        }
+    void SetPumpTime(double pump_ms) {
+        stats_.pump_ms = pump_ms;
     }
-    
-    void CollapsingEvent(std::function<void()> event) {
-        if (expand_ == false && expand_ != end_expand_) {
-            event();
+
+    const InputStats& GetStats() {
+        return stats_;
+    }
+
+private:
+    template<class Dispatch>
+    void DispatchHeld(Dispatch& dispatch) {
+        for (auto& message : queue_) {
+            dispatch(message);
         }
+        dispatched_ += (uint32_t)queue_.size();
+        queue_.clear();
     }
 
-protected:
-    bool end_expand_;
-    bool expand_;
+private:
+    std::vector<InputMessage> queue_;
+    uint32_t received_;
+    uint32_t dispatched_;
+    InputStats stats_ = {};
 };
+} // namespace internal
+
+void SetInputCoalescing(bool enable);
+InputStats GetInputStats();
 
-    
 
 /*
-* Eventԭ
-* ǰ֡ControlлEventӰĳҪһܴ֡
+* Rendering
+* In pipelined mode the frame's draw data is copied after ImGui::Render and handed to a render
+* thread, which draws and presents it while the UI thread already runs the next ImGuiUpdate.
 */
+struct RenderStats {
+    bool pipelined;
+    uint64_t frames_presented;
+    double frame_latency_ms;    // frame start to present returned, averaged
+    double render_ms;           // draw plus present, averaged
+    double wait_ms;             // UI thread blocked on the render thread, averaged
+    double frames_per_second;
+};
 
-class Widget {
+namespace internal {
+// Deep copy of an ImDrawData; list buffers are kept between copies so steady frames do not allocate.
+class DrawDataSnapshot {
 public:
-    Widget(const std::string& label) : label_(label) {
-        entry_disabled_ = false;
-        end_disabled_ = false;
-        disabled_ = false;
-        init_ = false;
+    DrawDataSnapshot() = default;
+    DrawDataSnapshot(const DrawDataSnapshot&) = delete;
+    DrawDataSnapshot& operator=(const DrawDataSnapshot&) = delete;
+
+    ~DrawDataSnapshot() {
+        Clear();
     }
 
-    void Begin() {
-        if (disabled_) {
-            ImGui::BeginDisabled();
-            entry_disabled_ = true;
-        }
-        else {
-            entry_disabled_ = false;
+    // Frees the copied lists, the next Copy allocates them again
+    void Clear() {
+        for (auto list : lists_) {
+            IM_DELETE(list);
         }
+        lists_.clear();
+        draw_data_.CmdLists.clear();
+        draw_data_.CmdListsCount = 0;
     }
 
-    void End() {
-        end_disabled_ = disabled_;
-        if (entry_disabled_) {
-            ImGui::EndDisabled();
+    void Copy(const ImDrawData* src) {
+        while ((int)lists_.size() < src->CmdListsCount) {
+            lists_.push_back(IM_NEW(ImDrawList)(ImGui::GetDrawListSharedData()));
+        }
+        draw_data_.Valid = src->Valid;
+        draw_data_.CmdListsCount = src->CmdListsCount;
+        draw_data_.TotalIdxCount = src->TotalIdxCount;
+        draw_data_.TotalVtxCount = src->TotalVtxCount;
+        draw_data_.DisplayPos = src->DisplayPos;
+        draw_data_.DisplaySize = src->DisplaySize;
+        draw_data_.FramebufferScale = src->FramebufferScale;
+        draw_data_.OwnerViewport = nullptr;     // the viewport belongs to the UI thread
+        draw_data_.CmdLists.resize(src->CmdListsCount);
+        for (int i = 0; i < src->CmdListsCount; i++) {
+            const ImDrawList* from = src->CmdLists[i];
+            ImDrawList* to = lists_[i];
+            CopyVector(to->CmdBuffer, from->CmdBuffer);
+            CopyVector(to->IdxBuffer, from->IdxBuffer);
+            CopyVector(to->VtxBuffer, from->VtxBuffer);
+            to->Flags = from->Flags;
+            draw_data_.CmdLists[i] = to;
         }
     }
 
-
-    void InitEvent(std::function<void()> init) {
-        if (!init_) {
-            init_ = true;
-            init();
-        }
+    ImDrawData* Get() {
+        return &draw_data_;
     }
 
-    void DisableEvent(std::function<void()> event) {
-        if (disabled_ == true && disabled_ != end_disabled_) {
-            event();
+private:
+    // ImVector's assignment frees first, this keeps the capacity
+    template<class T>
+    static void CopyVector(ImVector<T>& dst, const ImVector<T>& src) {
+        dst.resize(src.Size);
+        if (src.Size > 0) {
+            memcpy(dst.Data, src.Data, (size_t)src.Size * sizeof(T));
         }
     }
 
+private:
+    ImDrawData draw_data_;
+    std::vector<ImDrawList*> lists_;
+};
+} // namespace internal
 
-    void EnableEvent(std::function<void()> event) {
-        if (disabled_ == false && disabled_ != end_disabled_) {
-            event();
-        }
-    }
+// Takes effect at the start of the next frame
+void SetPipelinedRendering(bool enable);
+RenderStats GetRenderStats();
 
 
-    std::string GetLabel() {
-        return label_;
-    }
+struct PlatformWindowPoolStats {
+    uint64_t created;                   // Platform windows created by the backend
+    uint64_t reused;                    // Taken from the pool instead
+    uint64_t resized;                   // Reused with a different size, the render target was resized
+    uint64_t released;                  // Returned to the pool instead of destroyed
+    uint64_t destroyed;                 // Destroyed by the backend
+    int pooled;
+    int capacity;
+};
 
-    void SetLabel(const std::string& label) {
-        label_ = label;
+namespace internal {
+// Keeps the platform and renderer data of closed viewports to hand them to the next new viewport.
+// It wraps the create/destroy callbacks of ImGuiPlatformIO, the only platform specific part is hiding a pooled window,
+// so a headless platform can drive it with fake callbacks.
+class PlatformWindowPool {
+public:
+    PlatformWindowPool(int capacity = 4) {
+        capacity_ = capacity;
+        platform_io_ = nullptr;
+        platform_create_ = nullptr;
+        platform_destroy_ = nullptr;
+        renderer_create_ = nullptr;
+        renderer_destroy_ = nullptr;
+        renderer_set_size_ = nullptr;
+        stats_ = {};
     }
 
-    void SetDisable(bool disabled) {
-        disabled_ = disabled;
+    ~PlatformWindowPool() {
+        Uninstall();
     }
 
-    void Disable() {
-        SetDisable(true);
+    PlatformWindowPool(const PlatformWindowPool&) = delete;
+    PlatformWindowPool& operator=(const PlatformWindowPool&) = delete;
+
+    // After the platform and renderer backends have been initialized, only one pool can be installed
+    void Install(ImGuiPlatformIO& platform_io, std::function<void(ImGuiViewport*)> hide_window) {
+        IM_ASSERT(Active() == nullptr);
+        Active() = this;
+        platform_io_ = &platform_io;
+        hide_window_ = std::move(hide_window);
+        platform_create_ = platform_io.Platform_CreateWindow;
+        platform_destroy_ = platform_io.Platform_DestroyWindow;
+        renderer_create_ = platform_io.Renderer_CreateWindow;
+        renderer_destroy_ = platform_io.Renderer_DestroyWindow;
+        renderer_set_size_ = platform_io.Renderer_SetWindowSize;
+        platform_io.Platform_CreateWindow = PlatformCreateWindow;
+        platform_io.Platform_DestroyWindow = PlatformDestroyWindow;
+        platform_io.Renderer_CreateWindow = RendererCreateWindow;
+        platform_io.Renderer_DestroyWindow = RendererDestroyWindow;
     }
 
-    void Enable() {
-        SetDisable(false);
+    // Destroys the pooled windows and restores the backend callbacks, before the backends shut down
+    void Uninstall() {
+        if (platform_io_ == nullptr) {
+            return;
+        }
+        SetCapacity(0);
+        platform_io_->Platform_CreateWindow = platform_create_;
+        platform_io_->Platform_DestroyWindow = platform_destroy_;
+        platform_io_->Renderer_CreateWindow = renderer_create_;
+        platform_io_->Renderer_DestroyWindow = renderer_destroy_;
+        platform_io_ = nullptr;
+        Active() = nullptr;
     }
 
-private:
-    std::string label_;
-
-    bool init_;
-
-    bool entry_disabled_;
-    bool end_disabled_;
-    bool disabled_;
-};
-
-
-
-class Window : public Widget,
-               public Expandable
-{
-public:
-    Window(const std::string& label, bool main = false, bool create = true, ImGuiWindowFlags flags = 0) : Widget(label) {
-        window_ = nullptr;
-        main_ = main;
-        end_top_ = true;
-        top_ = false;
-        control_create_ = false;
-        control_close_ = false;
-        end_create_ = false;
-        create_ = create;
+    void SetCapacity(int capacity) {
+        capacity_ = capacity > 0 ? capacity : 0;
+        while ((int)pool_.size() > capacity_) {
+            Destroy(pool_.front());
+            pool_.erase(pool_.begin());
+        }
+    }
 
-        entry_ = false;
+    PlatformWindowPoolStats GetStats() const {
+        PlatformWindowPoolStats stats = stats_;
+        stats.pooled = (int)pool_.size();
+        stats.capacity = capacity_;
+        return stats;
+    }
 
-        end_flags_ = flags;
-        flags_ = flags;
+private:
+    struct Entry {
+        void* platform_user_data;
+        void* platform_handle;
+        void* platform_handle_raw;
+        void* renderer_user_data;
+        ImVec2 size;
+    };
+
+    static PlatformWindowPool*& Active() {
+        static PlatformWindowPool* active = nullptr;
+        return active;
     }
 
-    void Begin() {
-        Widget::Begin();
-        
-        if (window_ == nullptr) {
-            window_ = ImGui::FindWindowByName(GetLabel().c_str());
+    static void PlatformCreateWindow(ImGuiViewport* viewport) {
+        PlatformWindowPool& pool = *Active();
+        if (pool.pool_.empty()) {
+            pool.stats_.created++;
+            pool.platform_create_(viewport);
+            return;
         }
+        // A window of the same size needs no resize, otherwise the most recently pooled one
+        auto it = std::find_if(pool.pool_.rbegin(), pool.pool_.rend(), [viewport](const Entry& entry) {
+            return entry.size.x == viewport->Size.x && entry.size.y == viewport->Size.y;
+        });
+        const size_t index = it != pool.pool_.rend() ? pool.pool_.size() - 1 - (it - pool.pool_.rbegin()) : pool.pool_.size() - 1;
+        const Entry entry = pool.pool_[index];
+        pool.pool_.erase(pool.pool_.begin() + index);
+        viewport->PlatformUserData = entry.platform_user_data;
+        viewport->PlatformHandle = entry.platform_handle;
+        viewport->PlatformHandleRaw = entry.platform_handle_raw;
+        viewport->PlatformRequestResize = false;
+        pool.reusing_.push_back({ viewport, entry });
+        pool.stats_.reused++;
+        // Position, size, title and style are applied by ImGui right after creation
+    }
 
-        if (end_top_ != top_) {
-            if (internal::SetWindowTop(window_, top_)) {
-                end_top_ = top_;
+    static void RendererCreateWindow(ImGuiViewport* viewport) {
+        PlatformWindowPool& pool = *Active();
+        auto it = std::find_if(pool.reusing_.begin(), pool.reusing_.end(), [viewport](const std::pair<ImGuiViewport*, Entry>& reusing) { return reusing.first == viewport; });
+        if (it == pool.reusing_.end() || it->second.renderer_user_data == nullptr) {
+            if (it != pool.reusing_.end()) {
+                pool.reusing_.erase(it);
             }
+            if (pool.renderer_create_) {
+                pool.renderer_create_(viewport);
+            }
+            return;
         }
-
-        if (control_create_) {
-            create_ = true;
-            control_create_ = false;
-        }
-        if (control_close_) {
-            create_ = false;
-            control_close_ = false;
+        const Entry entry = it->second;
+        pool.reusing_.erase(it);
+        viewport->RendererUserData = entry.renderer_user_data;
+        // ImGui takes the size at creation as the renderer size and will not resize it itself
+        if ((entry.size.x != viewport->Size.x || entry.size.y != viewport->Size.y) && pool.renderer_set_size_) {
+            pool.renderer_set_size_(viewport, viewport->Size);
+            pool.stats_.resized++;
         }
+    }
 
-        if (create_) {
-            entry_ = true;
-            expand_ = ImGui::Begin(GetLabel().c_str(), &create_, flags_);
-        }
-        if (create_ == true && create_ != end_create_) {
-            // ÿ¿ڶҪtop״̬
-            end_top_ = !top_;
+    // ImGui destroys the renderer side first, it is kept until the platform side arrives
+    static void RendererDestroyWindow(ImGuiViewport* viewport) {
+        PlatformWindowPool& pool = *Active();
+        if (viewport == ImGui::GetMainViewport() || pool.capacity_ == 0) {
+            if (pool.renderer_destroy_) {
+                pool.renderer_destroy_(viewport);
+            }
+            return;
         }
+        pool.destroying_.push_back({ viewport, viewport->RendererUserData });
+        viewport->RendererUserData = nullptr;
     }
 
-    void End() {
-        if (entry_) {
-            ImGui::End();
-            entry_ = false;
+    static void PlatformDestroyWindow(ImGuiViewport* viewport) {
+        PlatformWindowPool& pool = *Active();
+        Entry entry = { viewport->PlatformUserData, viewport->PlatformHandle, viewport->PlatformHandleRaw, nullptr, viewport->Size };
+        auto it = std::find_if(pool.destroying_.begin(), pool.destroying_.end(), [viewport](const std::pair<ImGuiViewport*, void*>& destroying) { return destroying.first == viewport; });
+        if (it != pool.destroying_.end()) {
+            entry.renderer_user_data = it->second;
+            pool.destroying_.erase(it);
         }
-        end_create_ = create_;
-        if (create_ == false) {
-            if (main_) {
-                ExitApplication();
+
+        if (viewport == ImGui::GetMainViewport() || entry.platform_user_data == nullptr || pool.capacity_ == 0) {
+            viewport->RendererUserData = entry.renderer_user_data;
+            if (viewport->RendererUserData && pool.renderer_destroy_) {
+                pool.renderer_destroy_(viewport);
             }
+            if (pool.platform_destroy_) {
+                pool.platform_destroy_(viewport);
+            }
+            return;
         }
-        end_expand_ = expand_;
-        Widget::End();
+        viewport->PlatformUserData = nullptr;
+        viewport->PlatformHandle = nullptr;
+        viewport->PlatformHandleRaw = nullptr;
+        if ((int)pool.pool_.size() >= pool.capacity_) {
+            pool.Destroy(pool.pool_.front());
+            pool.pool_.erase(pool.pool_.begin());
+        }
+        if (pool.hide_window_) {
+            ImGuiViewport hidden;
+            hidden.PlatformUserData = entry.platform_user_data;
+            hidden.PlatformHandle = entry.platform_handle;
+            hidden.PlatformHandleRaw = entry.platform_handle_raw;
+            pool.hide_window_(&hidden);
+            hidden.PlatformUserData = nullptr;
+        }
+        pool.pool_.push_back(entry);
+        pool.stats_.released++;
     }
 
-    /*
-    * Update
-    */
-    void CreateUpdate(std::function<void()> event) {
-        if (create_) {
-            event();
+    // Hands the data back to the backend callbacks through a stand-in viewport
+    void Destroy(const Entry& entry) {
+        ImGuiViewport viewport;
+        viewport.Size = entry.size;
+        viewport.RendererUserData = entry.renderer_user_data;
+        viewport.PlatformUserData = entry.platform_user_data;
+        viewport.PlatformHandle = entry.platform_handle;
+        viewport.PlatformHandleRaw = entry.platform_handle_raw;
+        if (viewport.RendererUserData && renderer_destroy_) {
+            renderer_destroy_(&viewport);
+        }
+        if (platform_destroy_) {
+            platform_destroy_(&viewport);
         }
+        viewport.RendererUserData = nullptr;
+        viewport.PlatformUserData = nullptr;
+        stats_.destroyed++;
     }
 
-    void CloseUpdate(std::function<void()> close) {
-        if (!create_) {
-            close();
-        }
+private:
+    int capacity_;
+    std::vector<Entry> pool_;
+    std::vector<std::pair<ImGuiViewport*, Entry>> reusing_;
+    std::vector<std::pair<ImGuiViewport*, void*>> destroying_;
+
+    ImGuiPlatformIO* platform_io_;
+    std::function<void(ImGuiViewport*)> hide_window_;
+    void (*platform_create_)(ImGuiViewport*);
+    void (*platform_destroy_)(ImGuiViewport*);
+    void (*renderer_create_)(ImGuiViewport*);
+    void (*renderer_destroy_)(ImGuiViewport*);
+    void (*renderer_set_size_)(ImGuiViewport*, ImVec2);
+
+    PlatformWindowPoolStats stats_;
+};
+} // namespace internal
+
+// Closed platform windows are hidden and kept for reuse up to this count, 0 disables pooling
+void SetPlatformWindowPoolSize(int size);
+PlatformWindowPoolStats GetPlatformWindowPoolStats();
+
+
+/*
+* Present
+* PresentConfig is what the application asks for, PresentPolicy what the swap chain can do of it.
+*/
+struct PresentConfig {
+    PresentConfig() {
+        flip_model = true;
+        buffer_count = 2;
+        vsync = true;
+        allow_tearing = true;
+        max_frame_latency = 1;
     }
 
+    bool flip_model;                    // DXGI_SWAP_EFFECT_FLIP_DISCARD instead of the legacy blt model
+    int buffer_count;
+    bool vsync;
+    bool allow_tearing;                 // Without vsync, present immediately even mid-scanout
+    int max_frame_latency;              // Frames queued ahead of the display, 0 keeps the driver default
+};
+
+struct PresentCaps {
+    bool flip_model;
+    bool tearing;
+    bool waitable;                      // Frame latency waitable object
+};
 
-    /*
-    * Event
-    */
+struct PresentPolicy {
+    bool flip_model;
+    int buffer_count;
+    unsigned sync_interval;
+    bool tearing;
+    bool waitable;
+    int max_frame_latency;
+};
 
-    void CreateEvent(std::function<void()> event) {
-        if (end_create_ == false && create_ == true) {
-            event();
-        }
+struct PresentStats {
+    PresentPolicy policy;
+    uint64_t presents;
+    double present_ms;                  // Moving average
+    double wait_ms;                     // Moving average of the wait on the latency waitable object
+    uint64_t wait_timeouts;
+    double input_latency_ms;            // Moving average from input arrival to the present that shows it
+    double input_latency_max_ms;
+    uint64_t input_samples;
+};
+
+namespace internal {
+static PresentPolicy ResolvePresentPolicy(const PresentConfig& config, const PresentCaps& caps) {
+    PresentPolicy policy;
+    policy.flip_model = config.flip_model && caps.flip_model;
+    // The flip model needs a back buffer besides the one on screen
+    policy.buffer_count = ImClamp(config.buffer_count, policy.flip_model ? 2 : 1, 16);
+    policy.sync_interval = config.vsync ? 1 : 0;
+    policy.tearing = !config.vsync && config.allow_tearing && caps.tearing && policy.flip_model;
+    policy.max_frame_latency = ImClamp(config.max_frame_latency, 0, 16);
+    policy.waitable = policy.flip_model && caps.waitable && policy.max_frame_latency > 0;
+    return policy;
+}
+
+// Input to present latency, inputs are latched into the frame being built and answered by its present.
+// Frames may be presented on another thread than the one that builds them.
+class PresentLatencyTracker {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    PresentLatencyTracker() {
+        has_input_ = false;
+        average_ms_ = 0.0;
+        max_ms_ = 0.0;
+        samples_ = 0;
     }
 
-    void CloseEvent(std::function<void()> event) {
-        if (end_create_ == true && create_ == false) {
-            event();
+    // The earliest input not yet latched counts
+    void Input(Clock::time_point time) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!has_input_ || time < input_) {
+            input_ = time;
+            has_input_ = true;
         }
     }
 
+    // After the frame that handles the inputs so far has been built
+    void Latch() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        latched_.push_back(has_input_ ? input_ : Clock::time_point::min());
+        has_input_ = false;
+        // Frames that never get presented must not pile up
+        while (latched_.size() > 8) {
+            latched_.pop_front();
+        }
+    }
 
-    /*
-    * Control
-    */
-    void Create() {
-        control_create_ = true;
+    // Returns the latency of the presented frame in milliseconds, negative if it answered no input
+    double Presented(Clock::time_point now) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (latched_.empty()) {
+            return -1.0;
+        }
+        const Clock::time_point input = latched_.front();
+        latched_.pop_front();
+        if (input == Clock::time_point::min()) {
+            return -1.0;
+        }
+        const double ms = std::chrono::duration<double, std::milli>(now - input).count();
+        average_ms_ = samples_ == 0 ? ms : average_ms_ + (ms - average_ms_) * 0.1;
+        max_ms_ = (std::max)(max_ms_, ms);
+        samples_++;
+        return ms;
     }
 
-    void Close() {
-        control_close_ = true;
+    void GetStats(PresentStats& stats) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats.input_latency_ms = average_ms_;
+        stats.input_latency_max_ms = max_ms_;
+        stats.input_samples = samples_;
     }
 
+private:
+    std::mutex mutex_;
+    bool has_input_;
+    Clock::time_point input_;
+    std::deque<Clock::time_point> latched_;
+    double average_ms_;
+    double max_ms_;
+    uint64_t samples_;
+};
 
-    ImGuiWindowFlags GetFlags() {
-        return flags_;
+// Presents a swap chain by a resolved policy, SwapChain only needs
+//     bool WaitForFrame(unsigned timeout_ms);     // false on timeout
+//     bool Present(unsigned sync_interval, bool tearing);
+// so the pacing and the measurements run against a mock as well as against DXGI.
+template<class SwapChain>
+class PresentPacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    PresentPacer(SwapChain& swap_chain) : swap_chain_(swap_chain) {
+        policy_ = {};
+        stats_ = {};
     }
 
-    void SetFlags(ImGuiWindowFlags flags) {
-        flags_ = flags;
+    void SetPolicy(const PresentPolicy& policy) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        policy_ = policy;
     }
 
-    void AddFlags(ImGuiWindowFlags flags) {
-        flags_ |= flags;
+    PresentPolicy GetPolicy() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return policy_;
     }
 
-    void UnaddFlags(ImGuiWindowFlags flags) {
-        flags_ &= (~flags);;
+    // Before the frame reads its input, so the input is as fresh as the queue allows
+    void WaitForFrame(unsigned timeout_ms = 1000) {
+        if (!GetPolicy().waitable) {
+            return;
+        }
+        const auto start = Clock::now();
+        const bool signaled = swap_chain_.WaitForFrame(timeout_ms);
+        const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.wait_ms += (ms - stats_.wait_ms) * 0.1;
+        if (!signaled) {
+            stats_.wait_timeouts++;
+        }
     }
 
+    bool Present() {
+        return Present(swap_chain_);
+    }
 
-    void SetTop(bool top) {
-        top_ = top;
+    // Presents another swap chain under the same policy and counters, e.g. the one captured with a pipelined frame
+    bool Present(SwapChain& swap_chain) {
+        const PresentPolicy policy = GetPolicy();
+        const auto start = Clock::now();
+        const bool presented = swap_chain.Present(policy.sync_interval, policy.tearing);
+        const auto now = Clock::now();
+        latency_.Presented(now);
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.present_ms += (std::chrono::duration<double, std::milli>(now - start).count() - stats_.present_ms) * 0.1;
+        stats_.presents++;
+        return presented;
     }
 
-    void SetDocking(bool enable){
-        if (enable) {
-            UnaddFlags(ImGuiWindowFlags_NoDocking);
-        }
-        else {
-            AddFlags(ImGuiWindowFlags_NoDocking);
-        }
+    PresentLatencyTracker& GetLatencyTracker() {
+        return latency_;
     }
 
-    void SetAlwaysAutoResize(bool enable) {
-        if (enable) {
-            AddFlags(ImGuiWindowFlags_AlwaysAutoResize);
-        }
-        else {
-            UnaddFlags(ImGuiWindowFlags_AlwaysAutoResize);
-        }
-    }
-
-    void SetMove(bool enable) {
-        if (enable) {
-            UnaddFlags(ImGuiWindowFlags_NoMove);
-        }
-        else {
-            AddFlags(ImGuiWindowFlags_NoMove);
-        }
-    }
-
-    void SetCollapse(bool enable) {
-        if (enable) {
-            UnaddFlags(ImGuiWindowFlags_NoCollapse);
-        }
-        else {
-            AddFlags(ImGuiWindowFlags_NoCollapse);
+    PresentStats GetStats() {
+        PresentStats stats;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats = stats_;
+            stats.policy = policy_;
         }
+        latency_.GetStats(stats);
+        return stats;
     }
 
 private:
-    ImGuiWindow* window_;
+    SwapChain& swap_chain_;
+    std::mutex mutex_;
+    PresentPolicy policy_;
+    PresentStats stats_;
+    PresentLatencyTracker latency_;
+};
+} // namespace internal
 
-    bool main_;
-    bool entry_;
-    bool end_top_;
-    bool top_;
+// The main swap chain is recreated at the start of the next frame
+void SetPresentConfig(const PresentConfig& config);
+PresentConfig GetPresentConfig();
+PresentStats GetPresentStats();
 
-    bool control_close_;
-    bool control_create_;
-    bool end_create_;
-    bool create_;
 
-    ImGuiWindowFlags end_flags_;
-    ImGuiWindowFlags flags_;
+struct ResizeStats {
+    uint64_t requests;                  // Size changes reported by the window
+    uint64_t reallocations;             // Back buffer reallocations
+    uint64_t region_changes;            // Resizes served from the allocated buffers
+    int buffer_width;
+    int buffer_height;
+    int width;
+    int height;
 };
 
-class Button : public Widget {
+namespace internal {
+// Decides when the back buffers get reallocated while a window is resized.
+// With a presenter that can show a sub-region of the buffers, they grow in size classes and the
+// window size is only a region of them, without one they are reallocated once the size settles.
+class ResizePolicy {
 public:
-    Button(const std::string& label) : Widget(label) {
-        click_ = false;
-        control_click_ = false;
+    struct Action {
+        bool reallocate;
+        int buffer_width;
+        int buffer_height;
+        bool change_region;
+        int width;
+        int height;
+    };
+
+    ResizePolicy(int granularity = 256, double settle_ms = 150.0, double max_interval_ms = 100.0) {
+        granularity_ = granularity > 0 ? granularity : 1;
+        settle_ms_ = settle_ms;
+        max_interval_ms_ = max_interval_ms;
+        sub_region_ = false;
+        stats_ = {};
+        pending_ = false;
+        request_width_ = 0;
+        request_height_ = 0;
+        last_request_ms_ = 0.0;
+        last_reallocation_ms_ = 0.0;
     }
 
-    void Begin() {
-        Widget::Begin();
-        click_ = ImGui::Button(GetLabel().c_str());
-        if (control_click_) {
-            click_ = true;
-            control_click_ = false;
-        }
+    // Buffers as created, after (re)creating the swap chain
+    void Reset(int buffer_width, int buffer_height, bool sub_region) {
+        stats_.buffer_width = stats_.width = buffer_width;
+        stats_.buffer_height = stats_.height = buffer_height;
+        sub_region_ = sub_region;
+        pending_ = false;
     }
 
-    void End() {
-        Widget::End();
+    void Request(int width, int height, double now_ms) {
+        if (width <= 0 || height <= 0) {
+            return;
+        }
+        if (width != request_width_ || height != request_height_ || !pending_) {
+            stats_.requests++;
+        }
+        request_width_ = width;
+        request_height_ = height;
+        last_request_ms_ = now_ms;
+        pending_ = true;
     }
 
-    /*
-    * Event
-    */
-    void ClickEvent(std::function<void()> event) {
-        if (click_ == true) {
-            event();
+    // Once per frame, returns false when nothing has to be done
+    bool Update(double now_ms, Action& action) {
+        action = {};
+        action.buffer_width = stats_.buffer_width;
+        action.buffer_height = stats_.buffer_height;
+        action.width = stats_.width;
+        action.height = stats_.height;
+        const bool settled = now_ms - last_request_ms_ >= settle_ms_;
+
+        if (!sub_region_) {
+            if (!pending_) {
+                return false;
+            }
+            // Exact sizes only, while dragging at a bounded rate
+            if (!settled && now_ms - last_reallocation_ms_ < max_interval_ms_) {
+                return false;
+            }
+            pending_ = !settled;
+            if (request_width_ == stats_.buffer_width && request_height_ == stats_.buffer_height) {
+                return false;
+            }
+            return Reallocate(request_width_, request_height_, request_width_, request_height_, now_ms, action);
+        }
+
+        if (pending_) {
+            pending_ = false;
+            if (request_width_ > stats_.buffer_width || request_height_ > stats_.buffer_height) {
+                return Reallocate((std::max)(SizeClass(request_width_), stats_.buffer_width), (std::max)(SizeClass(request_height_), stats_.buffer_height), request_width_, request_height_, now_ms, action);
+            }
+            if (request_width_ != stats_.width || request_height_ != stats_.height) {
+                stats_.width = action.width = request_width_;
+                stats_.height = action.height = request_height_;
+                action.change_region = true;
+                stats_.region_changes++;
+                return true;
+            }
         }
+        // Give memory back once the size settles, but only when more than a size class is unused
+        if (settled && (stats_.buffer_width > SizeClass(stats_.width) || stats_.buffer_height > SizeClass(stats_.height))) {
+            return Reallocate(SizeClass(stats_.width), SizeClass(stats_.height), stats_.width, stats_.height, now_ms, action);
+        }
+        return false;
     }
 
+    int SizeClass(int size) const {
+        return (size + granularity_ - 1) / granularity_ * granularity_;
+    }
 
-    /*
-    * Control
-    */
-    void Click() {
-        control_click_ = true;
+    const ResizeStats& GetStats() const {
+        return stats_;
     }
 
 private:
-    bool control_click_;
-    bool click_;
+    bool Reallocate(int buffer_width, int buffer_height, int width, int height, double now_ms, Action& action) {
+        action.reallocate = true;
+        action.buffer_width = stats_.buffer_width = buffer_width;
+        action.buffer_height = stats_.buffer_height = buffer_height;
+        action.change_region = sub_region_;
+        action.width = stats_.width = width;
+        action.height = stats_.height = height;
+        last_reallocation_ms_ = now_ms;
+        stats_.reallocations++;
+        return true;
+    }
+
+private:
+    int granularity_;
+    double settle_ms_;
+    double max_interval_ms_;
+    bool sub_region_;
+
+    bool pending_;
+    int request_width_;
+    int request_height_;
+    double last_request_ms_;
+    double last_reallocation_ms_;
+
+    ResizeStats stats_;
 };
+} // namespace internal
 
-template<class Element = std::string>
-class Combo : public Widget,
-              public Expandable
-{
-public:
-    Combo(const std::string& label) : Widget(label) {
-        end_select_index_ = -1;
-        select_index_ = -1;
+ResizeStats GetResizeStats();
 
-        end_expand_ = false;
-        expand_ = false;
+
+/*
+* Overlay
+* The main window covers the monitor, is transparent and lets clicks through everywhere except over ImGui windows.
+*/
+struct OverlayStats {
+    bool enabled;
+    bool click_through;
+    int regions;                        // Interactive rects after merging
+    uint64_t layout_changes;            // Frames that rebuilt the regions
+    uint64_t click_through_toggles;
+    uint64_t frames_presented;
+    uint64_t frames_skipped;            // Nothing changed on screen, present skipped
+};
+
+namespace internal {
+// Interactive regions and dirty rects of one viewport, fed with its windows every frame.
+// The region list is only rebuilt when a window appears, disappears, moves or changes z-order,
+// content changes only produce dirty rects.
+class OverlayRegions {
+public:
+    OverlayRegions() {
+        count_ = 0;
+        layout_dirty_ = true;
+        layout_changed_ = false;
+        invalidated_ = true;
+        rebuilds_ = 0;
     }
 
-    void Begin() {
-        Widget::Begin();
-        expand_ = ImGui::BeginCombo(GetLabel().c_str(), select_label_.c_str());
+    void BeginFrame() {
+        count_ = 0;
+        dirty_.clear();
     }
 
-    void End() {
-        if (expand_) {
-            ImGui::EndCombo();
+    // Windows in back to front order, rects in screen coordinates.
+    // content_key changes whenever the window has to be drawn again, it is never compared across windows.
+    void AddWindow(ImGuiID id, const ImRect& rect, uint64_t content_key, bool interactive) {
+        if (count_ < windows_.size()) {
+            Window& window = windows_[count_];
+            if (window.id != id || !SameRect(window.rect, rect) || window.interactive != interactive) {
+                layout_dirty_ = true;
+                AddDirty(window.rect);
+                AddDirty(rect);
+            }
+            else if (window.content_key != content_key) {
+                AddDirty(rect);
+            }
+            window = { id, rect, content_key, interactive };
         }
-        end_expand_ = expand_;
-        end_select_index_ = select_index_;
-        Widget::End();
+        else {
+            windows_.push_back({ id, rect, content_key, interactive });
+            layout_dirty_ = true;
+            AddDirty(rect);
+        }
+        count_++;
     }
 
-    /*
-    * Update
-    */
-    void InsertUpdate(std::function<std::string(Element&)> insert) {
-        if (expand_ == false) {
-            return;
+    // Content of every window fed this frame changed, on frames with input
+    void RedrawWindows() {
+        for (size_t i = 0; i < count_; i++) {
+            AddDirty(windows_[i].rect);
         }
-        for (int i = 0; i < list_.size(); i++) {
-            const bool is_selected = (select_index_ == i);
-            auto temp = insert(list_[i]);
+    }
 
-            if (temp.empty()) {
-                continue;
+    void EndFrame() {
+        if (count_ < windows_.size()) {
+            for (size_t i = count_; i < windows_.size(); i++) {
+                AddDirty(windows_[i].rect);
             }
+            windows_.resize(count_);
+            layout_dirty_ = true;
+        }
+        layout_changed_ = layout_dirty_;
+        if (layout_dirty_) {
+            Rebuild();
+            layout_dirty_ = false;
+            rebuilds_++;
+        }
+        MergeDirty();
+    }
 
-            if (ImGui::Selectable(temp.c_str(), is_selected)) {
-                select_index_ = i;
-                select_label_ = temp;
-            }
+    // Everything is dirty next frame, after a resize or when the target was recreated
+    void Invalidate() {
+        invalidated_ = true;
+    }
 
-            if (is_selected) {
-                ImGui::SetItemDefaultFocus();
+    bool HitTest(const ImVec2& point) const {
+        if (regions_.empty() || !Inside(bounds_, point)) {
+            return false;
+        }
+        for (auto& region : regions_) {
+            if (Inside(region, point)) {
+                return true;
             }
         }
-        
+        return false;
     }
 
-    /*
-    * Event
-    */
-    void SelectEvent(std::function<void()> event) {
-        if (end_select_index_ != select_index_) {
-            event();
-        }
+    // True when the frame shows anything the last one did not
+    bool IsDirty() {
+        return !dirty_.empty() || invalidated_;
     }
 
-
-    /*
-    * Control
-    */
-    Element& GetSelectItem() {
-        return list_.at(select_index_);
+    // The full frame has been presented
+    void Presented() {
+        invalidated_ = false;
     }
 
-    int GetSelectIndex() {
-        return select_index_;
+    bool LayoutChanged() const {
+        return layout_changed_;
     }
 
-    int SetSelectIndex(int select_index) {
-        select_index_ = select_index;
+    const std::vector<ImRect>& GetRegions() const {
+        return regions_;
     }
 
-    void SetList(std::vector<Element>&& list) {
-        list_ = std::move(list);
+    const std::vector<ImRect>& GetDirtyRects() const {
+        return dirty_;
     }
 
-    std::vector<Element>& GetList() {
-        return list_;
+    uint64_t GetRebuildCount() const {
+        return rebuilds_;
     }
 
-    void ClearList() {
-        list_.clear();
+private:
+    struct Window {
+        ImGuiID id;
+        ImRect rect;
+        uint64_t content_key;
+        bool interactive;
+    };
+
+    static bool SameRect(const ImRect& a, const ImRect& b) {
+        return a.Min.x == b.Min.x && a.Min.y == b.Min.y && a.Max.x == b.Max.x && a.Max.y == b.Max.y;
     }
 
-private:
-    std::vector<Element> list_;
-    int end_select_index_;
-    int select_index_;
-    std::string select_label_;
+    static bool Inside(const ImRect& rect, const ImVec2& point) {
+        return point.x >= rect.Min.x && point.y >= rect.Min.y && point.x < rect.Max.x && point.y < rect.Max.y;
+    }
 
-};
+    static bool Encloses(const ImRect& outer, const ImRect& inner) {
+        return inner.Min.x >= outer.Min.x && inner.Min.y >= outer.Min.y && inner.Max.x <= outer.Max.x && inner.Max.y <= outer.Max.y;
+    }
 
-class InputText : public Widget {
-public:
-    InputText(const std::string& label, size_t text_size) : Widget(label), text_(text_size, '\0') {
-        end_input_ = false;
-        input_ = false;
+    static bool Touches(const ImRect& a, const ImRect& b) {
+        return a.Min.x <= b.Max.x && b.Min.x <= a.Max.x && a.Min.y <= b.Max.y && b.Min.y <= a.Max.y;
     }
 
-    void Begin() {
-        Widget::Begin();
-        if (ImGui::InputText(GetLabel().c_str(), (char*)text_.c_str(), text_.size())) {
-            input_ = true;
-        } else {
-            input_ = false;
+    void AddDirty(const ImRect& rect) {
+        if (rect.Max.x > rect.Min.x && rect.Max.y > rect.Min.y) {
+            dirty_.push_back(rect);
         }
     }
 
-    void End() {
-        end_input_ = input_;
-        Widget::End();
+    // Rects enclosed by another one never decide a hit test
+    void Rebuild() {
+        regions_.clear();
+        for (auto& window : windows_) {
+            if (!window.interactive || window.rect.Max.x <= window.rect.Min.x || window.rect.Max.y <= window.rect.Min.y) {
+                continue;
+            }
+            bool enclosed = false;
+            for (auto& region : regions_) {
+                if (Encloses(region, window.rect)) {
+                    enclosed = true;
+                    break;
+                }
+            }
+            if (enclosed) {
+                continue;
+            }
+            regions_.erase(std::remove_if(regions_.begin(), regions_.end(), [&window](const ImRect& region) { return Encloses(window.rect, region); }), regions_.end());
+            regions_.push_back(window.rect);
+        }
+        if (!regions_.empty()) {
+            bounds_ = regions_[0];
+            for (auto& region : regions_) {
+                bounds_.Min.x = (std::min)(bounds_.Min.x, region.Min.x);
+                bounds_.Min.y = (std::min)(bounds_.Min.y, region.Min.y);
+                bounds_.Max.x = (std::max)(bounds_.Max.x, region.Max.x);
+                bounds_.Max.y = (std::max)(bounds_.Max.y, region.Max.y);
+            }
+        }
     }
 
-    /*
-    * Event
-    */
-    void InputEvent(std::function<void()> event) {
-        if (input_ == true && input_ != end_input_) {
-            event();
+    // Overlapping dirty rects become their union, there are rarely more than a handful
+    void MergeDirty() {
+        for (bool merged = true; merged;) {
+            merged = false;
+            for (size_t i = 0; i < dirty_.size() && !merged; i++) {
+                for (size_t j = i + 1; j < dirty_.size(); j++) {
+                    if (Touches(dirty_[i], dirty_[j])) {
+                        dirty_[i].Min.x = (std::min)(dirty_[i].Min.x, dirty_[j].Min.x);
+                        dirty_[i].Min.y = (std::min)(dirty_[i].Min.y, dirty_[j].Min.y);
+                        dirty_[i].Max.x = (std::max)(dirty_[i].Max.x, dirty_[j].Max.x);
+                        dirty_[i].Max.y = (std::max)(dirty_[i].Max.y, dirty_[j].Max.y);
+                        dirty_.erase(dirty_.begin() + j);
+                        merged = true;
+                        break;
+                    }
+                }
+            }
         }
     }
 
-    std::string GetText() {
-        return std::string(text_.c_str(), strlen(text_.c_str()));
-    }
+private:
+    std::vector<Window> windows_;
+    size_t count_;
+    bool layout_dirty_;
+    bool layout_changed_;
+    bool invalidated_;
+    uint64_t rebuilds_;
+
+    std::vector<ImRect> regions_;
+    ImRect bounds_;
+    std::vector<ImRect> dirty_;
+};
 
-    void SetText(const std::string& text) {
-        memcpy((void*)text_.c_str(), text.c_str(), (text_.size() < text.size() ? text_.size() : text.size()));
+// Feeds the windows drawn into a viewport. A window is keyed on its rect, flags and a hash of its draw list,
+// as DrawStreamEncoder does, so a counter that keeps its length still redraws. The overlay windows are small,
+// hashing their vertices costs less than presenting an unchanged frame.
+// Only content drawn outside the draw lists, a texture updated in place, needs InvalidateOverlay().
+static void CollectOverlayWindows(OverlayRegions& regions, ImGuiViewport* viewport) {
+    ImGuiContext& g = *ImGui::GetCurrentContext();
+    const bool redraw = g.InputEventsTrail.Size > 0 || g.ActiveId != 0 || g.HoveredId != g.HoveredIdPreviousFrame;
+    regions.BeginFrame();
+    for (int i = 0; i < g.Windows.Size; i++) {
+        ImGuiWindow* window = g.Windows[i];
+        if (!window->WasActive || window->Hidden || window->Viewport != viewport) {
+            continue;
+        }
+        const ImDrawList* draw_list = window->DrawList;
+        ImGuiID content_key = ImHashData(&window->Flags, sizeof(window->Flags));
+        content_key = ImHashData(draw_list->VtxBuffer.Data, (size_t)draw_list->VtxBuffer.size_in_bytes(), content_key);
+        content_key = ImHashData(draw_list->IdxBuffer.Data, (size_t)draw_list->IdxBuffer.size_in_bytes(), content_key);
+        content_key = ImHashData(draw_list->CmdBuffer.Data, (size_t)draw_list->CmdBuffer.size_in_bytes(), content_key);
+        // Child windows are inside their root, they only matter for dirty rects
+        const bool interactive = !(window->Flags & (ImGuiWindowFlags_NoMouseInputs | ImGuiWindowFlags_ChildWindow));
+        regions.AddWindow(window->ID, window->Rect(), content_key, interactive);
+    }
+    if (redraw) {
+        regions.RedrawWindows();
     }
+    regions.EndFrame();
+}
+} // namespace internal
 
-private:
-    std::string text_;
+// Takes effect at the start of the next frame
+void SetOverlayMode(bool enable);
+// Presents the next frame, for content that changed outside the draw lists
+void InvalidateOverlay();
+OverlayStats GetOverlayStats();
 
-    bool end_input_;
-    bool input_;
+
+/*
+* Memory statistics
+* Define IMGUI_EX_MEMORY_STATS to route ImGui allocations through tagged counters.
+* Without it no allocator is installed, MemoryScope compiles to nothing and the stats stay empty.
+*/
+enum MemoryTag {
+    MemoryTag_Core,
+    MemoryTag_DrawLists,
+    MemoryTag_Widgets,
+    MemoryTag_Fonts,
+    MemoryTag_COUNT
 };
 
-class InputTextMultiline : public Widget {
+struct MemoryTagStats {
+    uint64_t frame_allocations;         // Last completed frame
+    uint64_t frame_frees;
+    size_t frame_bytes;
+    uint64_t live_allocations;
+    size_t live_bytes;
+    size_t peak_live_bytes;
+};
+
+struct MemoryStats {
+    bool enabled;
+    uint64_t frame;
+    MemoryTagStats tags[MemoryTag_COUNT];
+};
+
+struct MemoryLeak {
+    MemoryTag tag;
+    size_t size;
+    uint64_t frame;                     // Frame the allocation was made in
+};
+
+// Returns the previous tag
+MemoryTag SetMemoryTag(MemoryTag tag);
+const char* GetMemoryTagName(MemoryTag tag);
+MemoryStats GetMemoryStats();
+// Allocations still alive. After ImGui::DestroyContext these are leaks, except MemoryTag_Widgets blocks
+// of widgets that are still alive.
+std::vector<MemoryLeak> GetMemoryLeaks();
+void ShowMemoryStatsWindow(bool* open = nullptr);
+
+// Charges the ImGui allocations made until the end of the scope to tag
+class MemoryScope {
 public:
-    InputTextMultiline(const std::string& label, const std::string& text = "", ImGuiInputTextFlags flags = 0) : Widget(label), size_(-FLT_MIN, -FLT_MIN) {
-        end_input_ = false;
-        input_ = false;
+#ifdef IMGUI_EX_MEMORY_STATS
+    MemoryScope(MemoryTag tag) {
+        previous_ = SetMemoryTag(tag);
+    }
 
-        flags_ = flags | ImGuiInputTextFlags_CallbackResize;
-        SetText(text);
+    ~MemoryScope() {
+        SetMemoryTag(previous_);
     }
 
-    void Begin() {
-        if (text_.empty()) {
-            text_.push_back('\0');
-        }
-        Widget::Begin();
-        if (ImGui::InputTextMultiline(GetLabel().c_str(), text_.begin(), text_.size(), size_, flags_, ResizeCallback, &text_)) {
-            input_ = true;
-        }
-        else {
-            input_ = false;
-        }
+private:
+    MemoryTag previous_;
+#else
+    MemoryScope(MemoryTag) {
     }
+#endif
+};
 
-    void End() {
-        end_input_ = input_;
-        Widget::End();
+
+struct FrameArenaStats {
+    size_t bytes_used;                  // Last completed frame
+    size_t peak_bytes;
+    size_t capacity;
+    uint64_t heap_allocations;          // Blocks the arena requested from the heap during the last completed frame, nothing else
+    uint64_t total_heap_allocations;
+};
+
+namespace internal {
+// Linear allocator for data that only lives until the end of the frame.
+// Frees nothing individually, Reset() rewinds it and folds all blocks into one so a steady UI stops touching the heap.
+// Not thread-safe, only the UI thread may use it.
+class FrameArena {
+public:
+    FrameArena(size_t block_size = 64 * 1024) {
+        block_size_ = block_size;
+        block_index_ = 0;
+        offset_ = 0;
+        used_ = 0;
+        stats_ = {};
+        frame_heap_allocations_ = 0;
     }
 
-    /*
-    * Event
-    */
-    void InputEvent(std::function<void()> event) {
-        if (input_ == true && input_ != end_input_) {
-            event();
+    ~FrameArena() {
+        for (auto& block : blocks_) {
+            ::operator delete(block.data);
         }
     }
 
-    std::string GetText() {
-        return std::string(&text_[0], strlen(&text_[0]));
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* Allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+        while (block_index_ < blocks_.size()) {
+            Block& block = blocks_[block_index_];
+            const size_t start = (offset_ + align - 1) & ~(align - 1);
+            if (start + size <= block.size) {
+                offset_ = start + size;
+                used_ += size;
+                return block.data + start;
+            }
+            block_index_++;
+            offset_ = 0;
+        }
+        size_t block_size = blocks_.empty() ? block_size_ : blocks_.back().size * 2;
+        if (block_size < size + align) {
+            block_size = size + align;
+        }
+        AddBlock(block_size);
+        return Allocate(size, align);
     }
 
-    void SetText(const std::string& text) {
-        text_.clear();
-        text_.resize(text.size() + 1);
-        memcpy(&text_[0], &text[0], text.size() + 1);
+    template<class T>
+    T* AllocateArray(size_t count) {
+        return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
     }
 
-    void SetSize(const ImVec2& size) {
-        size_ = size;
+    char* FormatV(const char* fmt, va_list args) {
+        va_list copy;
+        va_copy(copy, args);
+        const int length = vsnprintf(nullptr, 0, fmt, copy);
+        va_end(copy);
+        if (length < 0) {
+            return CopyString("");
+        }
+        char* text = AllocateArray<char>((size_t)length + 1);
+        vsnprintf(text, (size_t)length + 1, fmt, args);
+        return text;
     }
 
-    ImVec2& GetSize() {
-        return size_;
+    char* CopyString(std::string_view text) {
+        char* copy = AllocateArray<char>(text.size() + 1);
+        memcpy(copy, text.data(), text.size());
+        copy[text.size()] = '\0';
+        return copy;
     }
 
-    void SetReadOnly(bool enable) {
-        if (enable) {
-            flags_ |= ImGuiInputTextFlags_ReadOnly;
-        }
-        else {
-            flags_ &= (~ImGuiInputTextFlags_ReadOnly);
+    // Everything handed out since the last reset becomes invalid
+    void Reset() {
+        stats_.bytes_used = used_;
+        stats_.peak_bytes = (std::max)(stats_.peak_bytes, used_);
+        if (blocks_.size() > 1) {
+            size_t capacity = 0;
+            for (auto& block : blocks_) {
+                capacity += block.size;
+                ::operator delete(block.data);
+            }
+            blocks_.clear();
+            AddBlock(capacity);
         }
+        stats_.heap_allocations = frame_heap_allocations_;
+        frame_heap_allocations_ = 0;
+        block_index_ = 0;
+        offset_ = 0;
+        used_ = 0;
     }
 
-private:
-    static int ResizeCallback(ImGuiInputTextCallbackData* data) {
-        if (data->EventFlag == ImGuiInputTextFlags_CallbackResize) {
-            ImVector<char>* my_str = (ImVector<char>*)data->UserData;
-            IM_ASSERT(my_str->begin() == data->Buf);
-            my_str->resize(data->BufSize); // NB: On resizing calls, generally data->BufSize == data->BufTextLen + 1
-            data->Buf = my_str->begin();
+    FrameArenaStats GetStats() const {
+        FrameArenaStats stats = stats_;
+        stats.capacity = 0;
+        for (auto& block : blocks_) {
+            stats.capacity += block.size;
         }
-        return 0;
+        return stats;
     }
 
 private:
-    ImVector<char> text_;
+    struct Block {
+        char* data;
+        size_t size;
+    };
+
+    void AddBlock(size_t size) {
+        blocks_.push_back({ static_cast<char*>(::operator new(size)), size });
+        frame_heap_allocations_++;
+        stats_.total_heap_allocations++;
+    }
 
-    bool end_input_;
-    bool input_;
+private:
+    std::vector<Block> blocks_;
+    size_t block_size_;
+    size_t block_index_;
+    size_t offset_;
+    size_t used_;
+    uint64_t frame_heap_allocations_;
+    FrameArenaStats stats_;
+};
 
-    ImVec2 size_;
+static inline const char* LabelData(const std::string& label) {
+    return label.c_str();
+}
 
-    ImGuiInputTextFlags flags_;
+static inline const char* LabelData(const char* label) {
+    return label;
+}
+} // namespace internal
+
+// Reset by the main loop once the frame has been rendered
+internal::FrameArena& GetFrameArena();
+FrameArenaStats GetFrameArenaStats();
+
+// Text valid until the end of the frame
+const char* FrameFormat(const char* fmt, ...) IM_FMTARGS(1);
+const char* FrameString(std::string_view text);
+
+// Allocator for containers that do not outlive the frame
+template<class T>
+class FrameAllocator {
+public:
+    using value_type = T;
+
+    FrameAllocator() = default;
+
+    template<class U>
+    FrameAllocator(const FrameAllocator<U>&) {
+    }
+
+    T* allocate(size_t count) {
+        return GetFrameArena().AllocateArray<T>(count);
+    }
+
+    void deallocate(T*, size_t) {
+    }
+
+    template<class U>
+    bool operator==(const FrameAllocator<U>&) const {
+        return true;
+    }
+
+    template<class U>
+    bool operator!=(const FrameAllocator<U>&) const {
+        return false;
+    }
 };
 
-class Text : public Widget {
+template<class T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+
+struct ProfileEntry {
+    std::string label;
+    bool top_level;                     // Not nested in another widget, normally a Window
+    double calls;                       // Per frame
+    double inclusive_ms;                // Per frame
+    double exclusive_ms;                // Per frame
+    double max_inclusive_ms;            // Slowest single call
+};
+
+namespace internal {
+// Call tree of timed scopes, a node is keyed by its parent and its label.
+// Only the UI thread may use it.
+class Profiler {
 public:
-    template<typename ... Args>
-    Text(const char* fmt, Args... args) : Widget(fmt) {
-        
+    struct Node {
+        std::string label;
+        int parent;
+        uint64_t calls;
+        int64_t inclusive_ns;
+        int64_t exclusive_ns;
+        int64_t max_inclusive_ns;
+    };
+
+    // Nanoseconds from any origin
+    using Clock = int64_t (*)();
+
+    Profiler() {
+        frames_ = 0;
+        clock_ = SteadyNow;
+    }
+
+    // steady_clock unless set, tests step a clock of their own
+    void SetClock(Clock clock) {
+        clock_ = clock ? clock : SteadyNow;
+    }
+
+    void Push(const void* owner, std::string_view label, const char* event = nullptr) {
+        const int parent = stack_.empty() ? -1 : stack_.back().node;
+        uint64_t key = 14695981039346656037ull;
+        auto hash = [&key](const char* data, size_t size) {
+            for (size_t i = 0; i < size; i++) {
+                key = (key ^ (uint8_t)data[i]) * 1099511628211ull;
+            }
+        };
+        hash(label.data(), label.size());
+        if (event) {
+            hash(event, strlen(event));
+        }
+        key ^= (uint64_t)(parent + 1) * 0x9E3779B97F4A7C15ull;
+
+        auto it = index_.find(key);
+        int node;
+        if (it == index_.end()) {
+            node = (int)nodes_.size();
+            std::string name(label);
+            if (event) {
+                name += name.empty() ? event : std::string(" ") + event;
+            }
+            nodes_.push_back({ std::move(name), parent, 0, 0, 0, 0 });
+            index_.emplace(key, node);
+        }
+        else {
+            node = it->second;
+        }
+        stack_.push_back({ owner, node, 0, clock_() });
+    }
+
+    // Scopes left open inside owner are closed with it
+    void Pop(const void* owner) {
+        auto it = std::find_if(stack_.rbegin(), stack_.rend(), [owner](const Entry& entry) { return entry.owner == owner; });
+        if (it == stack_.rend()) {
+            return;
+        }
+        const int64_t now = clock_();
+        for (;;) {
+            const Entry entry = stack_.back();
+            stack_.pop_back();
+            const int64_t elapsed = now - entry.start;
+            Node& node = nodes_[entry.node];
+            node.calls++;
+            node.inclusive_ns += elapsed;
+            node.exclusive_ns += elapsed - entry.child_ns;
+            node.max_inclusive_ns = (std::max)(node.max_inclusive_ns, elapsed);
+            if (!stack_.empty()) {
+                stack_.back().child_ns += elapsed;
+            }
+            if (entry.owner == owner) {
+                break;
+            }
+        }
+    }
+
+    void NewFrame() {
+        if (!stack_.empty()) {
+            Pop(stack_.front().owner);
+        }
+        frames_++;
+    }
+
+    void Reset() {
+        stack_.clear();
+        nodes_.clear();
+        index_.clear();
+        frames_ = 0;
+    }
+
+    // Aggregated by label
+    std::vector<ProfileEntry> GetEntries() const {
+        std::vector<ProfileEntry> entries;
+        std::unordered_map<std::string_view, size_t> index;
+        const double frames = frames_ > 0 ? (double)frames_ : 1.0;
+        for (auto& node : nodes_) {
+            auto it = index.find(node.label);
+            if (it == index.end()) {
+                it = index.emplace(node.label, entries.size()).first;
+                entries.push_back({ node.label, false, 0.0, 0.0, 0.0, 0.0 });
+            }
+            ProfileEntry& entry = entries[it->second];
+            entry.top_level |= node.parent == -1;
+            entry.calls += node.calls / frames;
+            entry.inclusive_ms += node.inclusive_ns / 1e6 / frames;
+            entry.exclusive_ms += node.exclusive_ns / 1e6 / frames;
+            entry.max_inclusive_ms = (std::max)(entry.max_inclusive_ms, node.max_inclusive_ns / 1e6);
+        }
+        return entries;
+    }
+
+    // Folded stacks ("Window;Child;Button 1234" in microseconds of exclusive time), the input format of flamegraph.pl and speedscope
+    std::string GetFoldedStacks() const {
+        std::string folded;
+        std::vector<int> path;
+        for (int i = 0; i < (int)nodes_.size(); i++) {
+            const int64_t us = nodes_[i].exclusive_ns / 1000;
+            if (us <= 0) {
+                continue;
+            }
+            path.clear();
+            for (int node = i; node != -1; node = nodes_[node].parent) {
+                path.push_back(node);
+            }
+            for (auto it = path.rbegin(); it != path.rend(); ++it) {
+                for (char c : nodes_[*it].label) {
+                    folded.push_back(c == ';' ? ',' : c);
+                }
+                folded.push_back(it + 1 == path.rend() ? ' ' : ';');
+            }
+            folded += std::to_string(us);
+            folded.push_back('\n');
+        }
+        return folded;
+    }
+
+    const std::vector<Node>& GetNodes() const {
+        return nodes_;
+    }
+
+    uint64_t GetFrameCount() const {
+        return frames_;
+    }
+
+private:
+    struct Entry {
+        const void* owner;
+        int node;
+        int64_t child_ns;
+        int64_t start;
+    };
+
+    static int64_t SteadyNow() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+private:
+    std::vector<Entry> stack_;
+    std::vector<Node> nodes_;
+    std::unordered_map<uint64_t, int> index_;
+    uint64_t frames_;
+    Clock clock_;
+};
+
+// By a column of the profiler window: 0 label, 1 calls, 2 inclusive, 3 exclusive, 4 max. Exclusive descending lists the top offenders.
+static void SortProfileEntries(std::vector<ProfileEntry>& entries, int column, bool ascending) {
+    auto key = [column](const ProfileEntry& entry) {
+        switch (column) {
+        case 1: return entry.calls;
+        case 2: return entry.inclusive_ms;
+        case 4: return entry.max_inclusive_ms;
+        default: return entry.exclusive_ms;
+        }
+    };
+    std::stable_sort(entries.begin(), entries.end(), [&](const ProfileEntry& a, const ProfileEntry& b) {
+        if (column == 0) {
+            return ascending ? a.label < b.label : b.label < a.label;
+        }
+        return ascending ? key(a) < key(b) : key(b) < key(a);
+    });
+}
+} // namespace internal
+
+internal::Profiler& GetProfiler();
+std::vector<ProfileEntry> GetProfileEntries();
+bool ExportFlameGraph(const char* path);
+void ShowProfilerWindow(bool* open = nullptr);
+
+namespace internal {
+class ProfileScope {
+public:
+    ProfileScope(std::string_view label, const char* event) {
+        GetProfiler().Push(this, label, event);
+    }
+
+    ~ProfileScope() {
+        GetProfiler().Pop(this);
+    }
+};
+} // namespace internal
+
+/*
+* Profiler
+* Define IMGUI_EX_PROFILER to time Widget Begin/End and the event helpers, without it the macro expands to nothing.
+*/
+#ifdef IMGUI_EX_PROFILER
+#define IMGUI_EX_PROFILE_SCOPE(label, event) ImGuiEx::internal::ProfileScope imgui_ex_profile_scope(label, event)
+#else
+#define IMGUI_EX_PROFILE_SCOPE(label, event)
+#endif
+
+
+class Expandable {
+public:
+    Expandable() {
+        end_expand_ = false;
+        expand_ = false;
+    }
+
+    template<class Fn>
+    void ExpandUpdate(Fn&& update) {
+        if (expand_ == true) { 
+            IMGUI_EX_PROFILE_SCOPE("", "ExpandUpdate");
+            update(); 
+        }
+    }
+
+    template<class Fn>
+    void CollapsingUpdate(Fn&& update) {
+        if (expand_ == false) {
+            IMGUI_EX_PROFILE_SCOPE("", "CollapsingUpdate");
+            update();
+        }
+    }
+
+    template<class Fn>
+    void ExpandEvent(Fn&& event) {
+        if (expand_ == true && expand_ != end_expand_) {
+            IMGUI_EX_PROFILE_SCOPE("", "ExpandEvent");
+            event();
+        }
+    }
+    
+    template<class Fn>
+    void CollapsingEvent(Fn&& event) {
+        if (expand_ == false && expand_ != end_expand_) {
+            IMGUI_EX_PROFILE_SCOPE("", "CollapsingEvent");
+            event();
+        }
+    }
+
+    bool GetExpand() {
+        return expand_;
+    }
+
+protected:
+    bool end_expand_;
+    bool expand_;
+};
+
+    
+
+/*
+* Eventԭ
+* ǰ֡ControlлEventӰĳҪһܴ֡
+*/
+
+class Widget {
+public:
+    Widget(const std::string& label) : label_(label) {
+        entry_disabled_ = false;
+        end_disabled_ = false;
+        disabled_ = false;
+        init_ = false;
     }
 
     void Begin() {
-        Widget::Begin();
-        ImGui::Text(GetLabel().c_str());
+#ifdef IMGUI_EX_PROFILER
+        GetProfiler().Push(this, label_);
+#endif
+        if (disabled_) {
+            ImGui::BeginDisabled();
+            entry_disabled_ = true;
+        }
+        else {
+            entry_disabled_ = false;
+        }
+    }
+
+    void End() {
+        end_disabled_ = disabled_;
+        if (entry_disabled_) {
+            ImGui::EndDisabled();
+        }
+#ifdef IMGUI_EX_PROFILER
+        GetProfiler().Pop(this);
+#endif
+    }
+
+
+    template<class Fn>
+    void InitEvent(Fn&& init) {
+        if (!init_) {
+            init_ = true;
+            IMGUI_EX_PROFILE_SCOPE(GetLabel(), "InitEvent");
+            init();
+        }
+    }
+
+    template<class Fn>
+    void DisableEvent(Fn&& event) {
+        if (disabled_ == true && disabled_ != end_disabled_) {
+            IMGUI_EX_PROFILE_SCOPE(GetLabel(), "DisableEvent");
+            event();
+        }
+    }
+
+
+    template<class Fn>
+    void EnableEvent(Fn&& event) {
+        if (disabled_ == false && disabled_ != end_disabled_) {
+            IMGUI_EX_PROFILE_SCOPE(GetLabel(), "EnableEvent");
+            event();
+        }
+    }
+
+
+    const std::string& GetLabel() {
+        return label_;
+    }
+
+    void SetLabel(const std::string& label) {
+        label_ = label;
+    }
+
+    void SetDisable(bool disabled) {
+        disabled_ = disabled;
+    }
+
+    void Disable() {
+        SetDisable(true);
+    }
+
+    void Enable() {
+        SetDisable(false);
+    }
+
+private:
+    std::string label_;
+
+    bool init_;
+
+    bool entry_disabled_;
+    bool end_disabled_;
+    bool disabled_;
+};
+
+
+
+namespace internal {
+/*
+* Content geometry of a static Window, captured from its ImDrawList once and appended again on later frames
+* while the window position, size, scroll, clip rect, font and style are unchanged. Indices are stored relative
+* to each segment so replayed geometry lands on whatever vertex offset the list has reached.
+* Content that begins a child window, popup or tooltip draws into other lists and is never cached.
+*/
+class DrawListCache {
+public:
+    DrawListCache() {
+        key_ = 0;
+        valid_ = false;
+        capture_ = false;
+        cmd_begin_ = 0;
+        idx_begin_ = 0;
+        windows_active_ = 0;
+        child_windows_ = 0;
+        hits_ = 0;
+        misses_ = 0;
+    }
+
+    void Invalidate() {
+        valid_ = false;
+    }
+
+    // Appends the cached content, false when it has to be generated and captured again
+    bool Replay(ImGuiWindow* window) {
+        ImGuiContext& g = *ImGui::GetCurrentContext();
+        // Hover and active items may change the look of the content, those frames run the widget code
+        if (g.HoveredWindow == window || g.ActiveIdWindow == window) {
+            valid_ = false;
+            return false;
+        }
+        const ImGuiID key = Key(window);
+        if (!valid_ || key != key_) {
+            valid_ = false;
+            key_ = key;
+            return false;
+        }
+        ImDrawList* draw_list = window->DrawList;
+        for (const Segment& segment : segments_) {
+            draw_list->PushClipRect(ImVec2(segment.clip_rect.x, segment.clip_rect.y), ImVec2(segment.clip_rect.z, segment.clip_rect.w));
+            draw_list->PushTextureID(segment.texture_id);
+            draw_list->PrimReserve(segment.idx_count, segment.vtx_count);
+            memcpy(draw_list->_VtxWritePtr, vtx_.data() + segment.vtx_begin, segment.vtx_count * sizeof(ImDrawVert));
+            draw_list->_VtxWritePtr += segment.vtx_count;
+            const ImDrawIdx* idx = idx_.data() + segment.idx_begin;
+            for (int i = 0; i < segment.idx_count; i++) {
+                draw_list->_IdxWritePtr[i] = (ImDrawIdx)(draw_list->_VtxCurrentIdx + idx[i]);
+            }
+            draw_list->_IdxWritePtr += segment.idx_count;
+            draw_list->_VtxCurrentIdx += segment.vtx_count;
+            draw_list->PopTextureID();
+            draw_list->PopClipRect();
+        }
+        window->DC.CursorPos = cursor_pos_;
+        window->DC.CursorMaxPos = cursor_max_pos_;
+        window->DC.IdealMaxPos = ideal_max_pos_;
+        hits_++;
+        return true;
+    }
+
+    void BeginCapture(ImGuiWindow* window) {
+        ImGuiContext& g = *ImGui::GetCurrentContext();
+        ImDrawList* draw_list = window->DrawList;
+        // Content written into channels is merged out of order, such windows are not cached
+        capture_ = draw_list->_Splitter._Count <= 1;
+        cmd_begin_ = draw_list->CmdBuffer.Size - 1;
+        idx_begin_ = draw_list->IdxBuffer.Size;
+        windows_active_ = g.WindowsActiveCount;
+        child_windows_ = window->DC.ChildWindows.Size;
+        misses_++;
+    }
+
+    void EndCapture(ImGuiWindow* window) {
+        ImGuiContext& g = *ImGui::GetCurrentContext();
+        ImDrawList* draw_list = window->DrawList;
+        segments_.clear();
+        vtx_.clear();
+        idx_.clear();
+        valid_ = false;
+        if (!capture_ || cmd_begin_ < 0 || draw_list->_Splitter._Count > 1) {
+            return;
+        }
+        // A child window, popup or tooltip begun by the content would be missing from the replayed frames
+        if (g.WindowsActiveCount != windows_active_ || window->DC.ChildWindows.Size != child_windows_) {
+            return;
+        }
+        for (int i = cmd_begin_; i < draw_list->CmdBuffer.Size; i++) {
+            const ImDrawCmd& cmd = draw_list->CmdBuffer[i];
+            if (cmd.UserCallback != nullptr) {
+                return;
+            }
+            // The first command was opened by the window itself, only its tail belongs to the content
+            const int idx_first = (std::max)((int)cmd.IdxOffset, idx_begin_);
+            const int idx_last = (int)(cmd.IdxOffset + cmd.ElemCount);
+            if (idx_first >= idx_last) {
+                continue;
+            }
+            unsigned int vtx_min = draw_list->IdxBuffer[idx_first];
+            unsigned int vtx_max = vtx_min;
+            for (int j = idx_first + 1; j < idx_last; j++) {
+                vtx_min = (std::min)(vtx_min, (unsigned int)draw_list->IdxBuffer[j]);
+                vtx_max = (std::max)(vtx_max, (unsigned int)draw_list->IdxBuffer[j]);
+            }
+            Segment segment;
+            segment.clip_rect = cmd.ClipRect;
+            segment.texture_id = cmd.TextureId;
+            segment.vtx_begin = (int)vtx_.size();
+            segment.vtx_count = (int)(vtx_max - vtx_min + 1);
+            segment.idx_begin = (int)idx_.size();
+            segment.idx_count = idx_last - idx_first;
+            const ImDrawVert* vtx = draw_list->VtxBuffer.Data + cmd.VtxOffset + vtx_min;
+            vtx_.insert(vtx_.end(), vtx, vtx + segment.vtx_count);
+            for (int j = idx_first; j < idx_last; j++) {
+                idx_.push_back((ImDrawIdx)(draw_list->IdxBuffer[j] - vtx_min));
+            }
+            segments_.push_back(segment);
+        }
+        cursor_pos_ = window->DC.CursorPos;
+        cursor_max_pos_ = window->DC.CursorMaxPos;
+        ideal_max_pos_ = window->DC.IdealMaxPos;
+        valid_ = true;
+    }
+
+    uint64_t GetHits() const {
+        return hits_;
+    }
+
+    uint64_t GetMisses() const {
+        return misses_;
+    }
+
+private:
+    struct Segment {
+        ImVec4 clip_rect;
+        ImTextureID texture_id;
+        int vtx_begin;
+        int vtx_count;
+        int idx_begin;
+        int idx_count;
+    };
+
+    // Everything the generated geometry depends on apart from the widget code itself
+    static ImGuiID Key(ImGuiWindow* window) {
+        ImGuiContext& g = *ImGui::GetCurrentContext();
+        const ImDrawList* draw_list = window->DrawList;
+        ImGuiID key = ImHashData(&g.Style, sizeof(g.Style));
+        key = ImHashData(&window->Pos, sizeof(window->Pos), key);
+        key = ImHashData(&window->Size, sizeof(window->Size), key);
+        key = ImHashData(&window->Scroll, sizeof(window->Scroll), key);
+        key = ImHashData(&window->DC.CursorPos, sizeof(window->DC.CursorPos), key);
+        key = ImHashData(&draw_list->_CmdHeader.ClipRect, sizeof(draw_list->_CmdHeader.ClipRect), key);
+        key = ImHashData(&draw_list->_CmdHeader.TextureId, sizeof(draw_list->_CmdHeader.TextureId), key);
+        key = ImHashData(&draw_list->Flags, sizeof(draw_list->Flags), key);
+        key = ImHashData(&g.Font, sizeof(g.Font), key);
+        return ImHashData(&g.FontSize, sizeof(g.FontSize), key);
     }
 
-    void End() {
-        Widget::End();
+    std::vector<Segment> segments_;
+    std::vector<ImDrawVert> vtx_;
+    std::vector<ImDrawIdx> idx_;
+    ImVec2 cursor_pos_;
+    ImVec2 cursor_max_pos_;
+    ImVec2 ideal_max_pos_;
+    ImGuiID key_;
+    bool valid_;
+    bool capture_;
+    int cmd_begin_;
+    int idx_begin_;
+    int windows_active_;
+    int child_windows_;
+    uint64_t hits_;
+    uint64_t misses_;
+};
+} // namespace internal
+
+class Window : public Widget,
+               public Expandable
+{
+public:
+    Window(const std::string& label, bool main = false, bool create = true, ImGuiWindowFlags flags = 0) : Widget(label) {
+        window_ = nullptr;
+        main_ = main;
+        end_top_ = true;
+        top_ = false;
+        control_create_ = false;
+        control_close_ = false;
+        end_create_ = false;
+        create_ = create;
+
+        entry_ = false;
+        static_ = false;
+
+        end_flags_ = flags;
+        flags_ = flags;
+    }
+
+    void Begin() {
+        Widget::Begin();
+        
+        if (window_ == nullptr) {
+            window_ = ImGui::FindWindowByName(GetLabel().c_str());
+        }
+
+        if (end_top_ != top_) {
+            if (internal::SetWindowTop(window_, top_)) {
+                end_top_ = top_;
+            }
+        }
+
+        if (control_create_) {
+            create_ = true;
+            control_create_ = false;
+        }
+        if (control_close_) {
+            create_ = false;
+            control_close_ = false;
+        }
+
+        if (create_) {
+            entry_ = true;
+            expand_ = ImGui::Begin(GetLabel().c_str(), &create_, flags_);
+        }
+        if (create_ == true && create_ != end_create_) {
+            // ÿ¿ڶҪtop״̬
+            end_top_ = !top_;
+        }
+    }
+
+    void End() {
+        if (entry_) {
+            ImGui::End();
+            entry_ = false;
+        }
+        end_create_ = create_;
+        if (create_ == false) {
+            if (main_) {
+                ExitApplication();
+            }
+        }
+        end_expand_ = expand_;
+        Widget::End();
+    }
+
+    /*
+    * Update
+    */
+    // A static window replays the content captured on an earlier frame instead of running update
+    template<class Fn>
+    void ExpandUpdate(Fn&& update) {
+        if (!static_) {
+            Expandable::ExpandUpdate(std::forward<Fn>(update));
+            return;
+        }
+        if (expand_ == true) {
+            IMGUI_EX_PROFILE_SCOPE(GetLabel(), "ExpandUpdate");
+            ImGuiWindow* window = ImGui::GetCurrentWindow();
+            if (!static_cache_.Replay(window)) {
+                static_cache_.BeginCapture(window);
+                update();
+                static_cache_.EndCapture(window);
+            }
+        }
+    }
+
+    template<class Fn>
+    void CreateUpdate(Fn&& event) {
+        if (create_) {
+            IMGUI_EX_PROFILE_SCOPE(GetLabel(), "CreateUpdate");
+            event();
+        }
+    }
+
+    template<class Fn>
+    void CloseUpdate(Fn&& close) {
+        if (!create_) {
+            IMGUI_EX_PROFILE_SCOPE(GetLabel(), "CloseUpdate");
+            close();
+        }
+    }
+
+
+    /*
+    * Event
+    */
+
+    template<class Fn>
+    void CreateEvent(Fn&& event) {
+        if (end_create_ == false && create_ == true) {
+            IMGUI_EX_PROFILE_SCOPE(GetLabel(), "CreateEvent");
+            event();
+        }
+    }
+
+    template<class Fn>
+    void CloseEvent(Fn&& event) {
+        if (end_create_ == true && create_ == false) {
+            IMGUI_EX_PROFILE_SCOPE(GetLabel(), "CloseEvent");
+            event();
+        }
+    }
+
+
+    /*
+    * Control
+    */
+    void Create() {
+        control_create_ = true;
+    }
+
+    void Close() {
+        control_close_ = true;
+    }
+
+
+    bool GetCreate() {
+        return create_;
+    }
+
+    ImGuiWindowFlags GetFlags() {
+        return flags_;
+    }
+
+    void SetFlags(ImGuiWindowFlags flags) {
+        flags_ = flags;
+    }
+
+    void AddFlags(ImGuiWindowFlags flags) {
+        flags_ |= flags;
+    }
+
+    void UnaddFlags(ImGuiWindowFlags flags) {
+        flags_ &= (~flags);;
+    }
+
+
+    bool GetTop() {
+        return top_;
+    }
+
+    void SetTop(bool top) {
+        top_ = top;
+    }
+
+    void SetDocking(bool enable){
+        if (enable) {
+            UnaddFlags(ImGuiWindowFlags_NoDocking);
+        }
+        else {
+            AddFlags(ImGuiWindowFlags_NoDocking);
+        }
+    }
+
+    void SetAlwaysAutoResize(bool enable) {
+        if (enable) {
+            AddFlags(ImGuiWindowFlags_AlwaysAutoResize);
+        }
+        else {
+            UnaddFlags(ImGuiWindowFlags_AlwaysAutoResize);
+        }
+    }
+
+    void SetMove(bool enable) {
+        if (enable) {
+            UnaddFlags(ImGuiWindowFlags_NoMove);
+        }
+        else {
+            AddFlags(ImGuiWindowFlags_NoMove);
+        }
+    }
+
+    void SetCollapse(bool enable) {
+        if (enable) {
+            UnaddFlags(ImGuiWindowFlags_NoCollapse);
+        }
+        else {
+            AddFlags(ImGuiWindowFlags_NoCollapse);
+        }
+    }
+
+    /*
+    * For content that looks the same every frame (help text, BulletText, SeparatorText...). While the window is not
+    * hovered and its position, size, scroll, font and style are unchanged the geometry of the last run is reused
+    * and the ExpandUpdate code, including any events in it, does not run. Call InvalidateStatic when the shown data changes.
+    * The content must be non-interactive: replayed items are not submitted, so they cannot be focused, navigated to
+    * with the keyboard or report events. Content that begins a child window, popup or tooltip is never cached.
+    */
+    void SetStatic(bool enable) {
+        static_ = enable;
+        static_cache_.Invalidate();
+    }
+
+    bool GetStatic() {
+        return static_;
+    }
+
+    void InvalidateStatic() {
+        static_cache_.Invalidate();
+    }
+
+    const internal::DrawListCache& GetStaticCache() {
+        return static_cache_;
+    }
+
+private:
+    ImGuiWindow* window_;
+
+    bool main_;
+    bool entry_;
+    bool end_top_;
+    bool top_;
+
+    bool control_close_;
+    bool control_create_;
+    bool end_create_;
+    bool create_;
+
+    ImGuiWindowFlags end_flags_;
+    ImGuiWindowFlags flags_;
+
+    bool static_;
+    internal::DrawListCache static_cache_;
+};
+
+class Button : public Widget {
+public:
+    Button(const std::string& label) : Widget(label) {
+        click_ = false;
+        control_click_ = false;
+    }
+
+    void Begin() {
+        Widget::Begin();
+        click_ = ImGui::Button(GetLabel().c_str());
+        if (control_click_) {
+            click_ = true;
+            control_click_ = false;
+        }
+    }
+
+    void End() {
+        Widget::End();
+    }
+
+    /*
+    * Event
+    */
+    template<class Fn>
+    void ClickEvent(Fn&& event) {
+        if (click_ == true) {
+            IMGUI_EX_PROFILE_SCOPE(GetLabel(), "ClickEvent");
+            event();
+        }
+    }
+
+
+    /*
+    * Control
+    */
+    void Click() {
+        control_click_ = true;
+    }
+
+private:
+    bool control_click_;
+    bool click_;
+};
+
+namespace internal {
+static inline unsigned CountTrailingZeros(unsigned mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+static inline char FoldAscii(char c) {
+    return (c >= 'A' && c <= 'Z') ? (char)(c + ('a' - 'A')) : c;
+}
+
+static std::string FoldAscii(const std::string& str) {
+    std::string folded(str);
+    for (auto& c : folded) {
+        c = FoldAscii(c);
+    }
+    return folded;
+}
+
+// Byte at a time substring search, the reference for FindSubstring and its tail loop.
+static const char* FindSubstringScalar(const char* hay, size_t hay_len, const char* needle, size_t needle_len) {
+    if (needle_len == 0) {
+        return hay;
+    }
+    if (needle_len > hay_len) {
+        return nullptr;
+    }
+    for (size_t i = 0; i <= hay_len - needle_len; i++) {
+        if (hay[i] == needle[0] && memcmp(hay + i, needle, needle_len) == 0) {
+            return hay + i;
+        }
+    }
+    return nullptr;
+}
+
+// Substring search, SSE2 tests the needle's first and last byte at 16 positions per step
+// and only runs memcmp on positions where both hit.
+static const char* FindSubstring(const char* hay, size_t hay_len, const char* needle, size_t needle_len) {
+    if (needle_len == 0) {
+        return hay;
+    }
+    if (needle_len > hay_len) {
+        return nullptr;
+    }
+    const size_t last = hay_len - needle_len;
+    size_t i = 0;
+#if IMGUI_EX_SSE2
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i tail = _mm_set1_epi8(needle[needle_len - 1]);
+    for (; i + 16 <= last + 1; i += 16) {
+        const __m128i block_first = _mm_loadu_si128((const __m128i*)(hay + i));
+        const __m128i block_tail = _mm_loadu_si128((const __m128i*)(hay + i + needle_len - 1));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, block_first), _mm_cmpeq_epi8(tail, block_tail)));
+        while (mask) {
+            const size_t pos = i + CountTrailingZeros(mask);
+            if (needle_len <= 2 || memcmp(hay + pos + 1, needle + 1, needle_len - 2) == 0) {
+                return hay + pos;
+            }
+            mask &= mask - 1;
+        }
+    }
+#endif
+    return FindSubstringScalar(hay + i, hay_len - i, needle, needle_len);
+}
+
+/*
+* Text measurement with the result of ImFont::CalcTextSizeA (no wrapping, no width limit).
+* CalcTextSizeReference is the per character loop of ImGui. CalcTextSizeFast takes 16 printable ASCII bytes
+* per SSE2 test and decodes valid 3 byte UTF-8 (CJK) inline, everything else goes through ImTextCharFromUtf8.
+* Widths are summed in the same order as the reference, so both return identical floats.
+*/
+static ImVec2 CalcTextSizeReference(const ImFont* font, float size, const char* text, const char* text_end) {
+    const float scale = size / font->FontSize;
+    ImVec2 text_size(0.0f, 0.0f);
+    float line_width = 0.0f;
+    const char* s = text;
+    while (s < text_end) {
+        unsigned int c = (unsigned int)(unsigned char)*s;
+        if (c < 0x80) {
+            s += 1;
+        }
+        else {
+            s += ImTextCharFromUtf8(&c, s, text_end);
+        }
+        if (c < 32) {
+            if (c == '\n') {
+                text_size.x = ImMax(text_size.x, line_width);
+                text_size.y += size;
+                line_width = 0.0f;
+                continue;
+            }
+            if (c == '\r') {
+                continue;
+            }
+        }
+        const float char_width = ((int)c < font->IndexAdvanceX.Size ? font->IndexAdvanceX.Data[c] : font->FallbackAdvanceX) * scale;
+        line_width += char_width;
+    }
+    if (text_size.x < line_width) {
+        text_size.x = line_width;
+    }
+    if (line_width > 0 || text_size.y == 0.0f) {
+        text_size.y += size;
+    }
+    return text_size;
+}
+
+static ImVec2 CalcTextSizeFast(const ImFont* font, float size, const char* text, const char* text_end) {
+    const float scale = size / font->FontSize;
+    const float* advance = font->IndexAdvanceX.Data;
+    const unsigned int advance_count = (unsigned int)font->IndexAdvanceX.Size;
+    const float fallback = font->FallbackAdvanceX;
+    ImVec2 text_size(0.0f, 0.0f);
+    float line_width = 0.0f;
+    const char* s = text;
+    while (s < text_end) {
+#if IMGUI_EX_SSE2
+        if (text_end - s >= 16 && advance_count >= 0x80) {
+            // Signed compare, bytes >= 0x80 count as below 32 too
+            const __m128i block = _mm_loadu_si128((const __m128i*)s);
+            const unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmplt_epi8(block, _mm_set1_epi8(32)));
+            const int run = mask != 0 ? (int)CountTrailingZeros(mask) : 16;
+            for (int i = 0; i < run; i++) {
+                const float char_width = advance[(unsigned char)s[i]] * scale;
+                line_width += char_width;
+            }
+            s += run;
+            if (run == 16) {
+                continue;
+            }
+        }
+#endif
+        unsigned int c = (unsigned int)(unsigned char)*s;
+        if (c < 0x80) {
+            s += 1;
+        }
+        else if ((c & 0xF0) == 0xE0 && text_end - s >= 3 && ((unsigned char)s[1] & 0xC0) == 0x80 && ((unsigned char)s[2] & 0xC0) == 0x80) {
+            c = ((c & 0x0F) << 12) | (((unsigned char)s[1] & 0x3F) << 6) | ((unsigned char)s[2] & 0x3F);
+            // Overlong forms and surrogates get ImGui's error handling
+            if (c >= 0x800 && (c >> 11) != 0x1B) {
+                s += 3;
+            }
+            else {
+                s += ImTextCharFromUtf8(&c, s, text_end);
+            }
+        }
+        else {
+            s += ImTextCharFromUtf8(&c, s, text_end);
+        }
+        if (c < 32) {
+            if (c == '\n') {
+                text_size.x = ImMax(text_size.x, line_width);
+                text_size.y += size;
+                line_width = 0.0f;
+                continue;
+            }
+            if (c == '\r') {
+                continue;
+            }
+        }
+        const float char_width = (c < advance_count ? advance[c] : fallback) * scale;
+        line_width += char_width;
+    }
+    if (text_size.x < line_width) {
+        text_size.x = line_width;
+    }
+    if (line_width > 0 || text_size.y == 0.0f) {
+        text_size.y += size;
+    }
+    return text_size;
+}
+
+// ImGui::CalcTextSize without wrapping, measured by CalcTextSizeFast
+static ImVec2 CalcTextSizeRounded(const ImFont* font, float size, const char* text, const char* text_end, bool hide_text_after_double_hash) {
+    const char* text_display_end = hide_text_after_double_hash ? ImGui::FindRenderedTextEnd(text, text_end) : (text_end ? text_end : text + strlen(text));
+    if (text == text_display_end) {
+        return ImVec2(0.0f, size);
+    }
+    ImVec2 text_size = CalcTextSizeFast(font, size, text, text_display_end);
+    // Rounded up like ImGui::CalcTextSize
+    text_size.x = (float)(int)(text_size.x + 0.99999f);
+    return text_size;
+}
+
+/*
+* All labels of a list case-folded into one buffer, '\0' separated,
+* so a filter is a single pass over contiguous memory.
+*/
+class LabelArena {
+public:
+    template<class GetLabel>
+    void Build(size_t count, GetLabel&& get_label) {
+        text_.clear();
+        offsets_.resize(count + 1);
+        for (size_t i = 0; i < count; i++) {
+            offsets_[i] = (uint32_t)text_.size();
+            const std::string& label = get_label(i);
+            const size_t pos = text_.size();
+            text_.resize(pos + label.size() + 1);
+            for (size_t j = 0; j < label.size(); j++) {
+                text_[pos + j] = FoldAscii(label[j]);
+            }
+            text_[pos + label.size()] = '\0';
+        }
+        offsets_[count] = (uint32_t)text_.size();
+    }
+
+    // Appends the rows in [first, last) containing needle (already folded), rows with an empty label never match.
+    void Search(const std::string& needle, std::vector<int>& rows, size_t first = 0, size_t last = SIZE_MAX) const {
+        last = (std::min)(last, GetRowCount());
+        if (first >= last) {
+            return;
+        }
+        if (needle.empty()) {
+            for (size_t i = first; i < last; i++) {
+                if (RowLength(i) != 0) {
+                    rows.push_back((int)i);
+                }
+            }
+            return;
+        }
+        const char* base = text_.data();
+        size_t pos = offsets_[first];
+        const size_t end = offsets_[last];
+        size_t row = first;
+        while (pos < end) {
+            const char* hit = FindSubstring(base + pos, end - pos, needle.data(), needle.size());
+            if (hit == nullptr) {
+                break;
+            }
+            // Hits only move forward, so walk the row offsets instead of searching them
+            const uint32_t offset = (uint32_t)(hit - base);
+            while (offsets_[row + 1] <= offset) {
+                row++;
+            }
+            rows.push_back((int)row);
+            pos = offsets_[row + 1];
+        }
+    }
+
+    bool Contains(size_t row, const std::string& needle) const {
+        return FindSubstring(text_.data() + offsets_[row], RowLength(row), needle.data(), needle.size()) != nullptr;
+    }
+
+    // Keep only the rows that also contain needle, used when the query grew.
+    void Narrow(const std::string& needle, std::vector<int>& rows) const {
+        size_t kept = 0;
+        for (int row : rows) {
+            if (Contains(row, needle)) {
+                rows[kept++] = row;
+            }
+        }
+        rows.resize(kept);
+    }
+
+    std::string_view GetRow(size_t row) const {
+        return std::string_view(text_.data() + offsets_[row], RowLength(row));
+    }
+
+    size_t RowLength(size_t row) const {
+        return offsets_[row + 1] - offsets_[row] - 1;
+    }
+
+    size_t GetRowCount() const {
+        return offsets_.empty() ? 0 : offsets_.size() - 1;
+    }
+
+private:
+    std::vector<char> text_;
+    std::vector<uint32_t> offsets_;
+};
+
+/*
+* The size of one widget's text, measured with CalcTextSizeFast only when the text or the font changed.
+* A rebuilt atlas reallocates the font's advance table, which counts as a change of font.
+* Text and BulletText lay out with it. Button, CheckBox, RadioButtonGroup, SeparatorText and the Combo and
+* ListBox rows are measured inside ImGui, which takes no size from outside, so they do not use it.
+*/
+class TextSizeMemo {
+public:
+    TextSizeMemo() {
+        font_ = nullptr;
+        advances_ = nullptr;
+        size_ = 0.0f;
+    }
+
+    // Unrounded size, as CalcTextSizeFast returns it
+    ImVec2 Get(const ImFont* font, float size, const char* text, const char* text_end) {
+        const size_t length = (size_t)(text_end - text);
+        if (font == font_ && size == size_ && font->IndexAdvanceX.Data == advances_
+            && length == text_.size() && memcmp(text, text_.data(), length) == 0) {
+            return text_size_;
+        }
+        text_size_ = CalcTextSizeFast(font, size, text, text_end);
+        text_.assign(text, length);
+        font_ = font;
+        advances_ = font->IndexAdvanceX.Data;
+        size_ = size;
+        return text_size_;
+    }
+
+private:
+    std::string text_;
+    const ImFont* font_;
+    const float* advances_;
+    float size_;
+    ImVec2 text_size_;
+};
+} // namespace internal
+
+// ImGui::CalcTextSize for the current font through internal::CalcTextSizeFast, without wrapping.
+// The widgets measure through their TextSizeMemo instead, this is for application code that lays out its own text.
+ImVec2 CalcTextSize(const char* text, const char* text_end = nullptr, bool hide_text_after_double_hash = false);
+
+namespace internal {
+// ImGui::TextUnformatted with the size taken from the memo, or measured with CalcTextSizeFast. Wrapped and very long text,
+// which ImGui lays out and clips differently, still goes through ImGui.
+static void TextUnformattedCached(const char* text, const char* text_end = nullptr, TextSizeMemo* memo = nullptr) {
+    ImGuiWindow* window = ImGui::GetCurrentWindow();
+    if (window->SkipItems) {
+        return;
+    }
+    if (text_end == nullptr) {
+        text_end = text + strlen(text);
+    }
+    if (window->DC.TextWrapPos >= 0.0f || text_end - text > 2000) {
+        ImGui::TextUnformatted(text, text_end);
+        return;
+    }
+    ImGuiContext& g = *ImGui::GetCurrentContext();
+    ImVec2 text_size(0.0f, g.FontSize);
+    if (text != text_end) {
+        text_size = memo != nullptr ? memo->Get(g.Font, g.FontSize, text, text_end) : CalcTextSizeFast(g.Font, g.FontSize, text, text_end);
+        // Rounded up like ImGui::CalcTextSize
+        text_size.x = (float)(int)(text_size.x + 0.99999f);
+    }
+    const ImVec2 text_pos(window->DC.CursorPos.x, window->DC.CursorPos.y + window->DC.CurrLineTextBaseOffset);
+    const ImRect bb(text_pos, ImVec2(text_pos.x + text_size.x, text_pos.y + text_size.y));
+    ImGui::ItemSize(text_size, 0.0f);
+    if (!ImGui::ItemAdd(bb, 0)) {
+        return;
+    }
+    ImGui::RenderText(bb.Min, text, text_end, false);
+}
+
+// ImGui::BulletText with the size taken from the memo, laid out like ImGui::BulletTextV
+static void BulletTextCached(const char* text, const char* text_end = nullptr, TextSizeMemo* memo = nullptr) {
+    ImGuiWindow* window = ImGui::GetCurrentWindow();
+    if (window->SkipItems) {
+        return;
+    }
+    if (text_end == nullptr) {
+        text_end = text + strlen(text);
+    }
+    ImGuiContext& g = *ImGui::GetCurrentContext();
+    const ImGuiStyle& style = g.Style;
+    ImVec2 label_size(0.0f, g.FontSize);
+    if (text != text_end) {
+        label_size = memo != nullptr ? memo->Get(g.Font, g.FontSize, text, text_end) : CalcTextSizeFast(g.Font, g.FontSize, text, text_end);
+        label_size.x = (float)(int)(label_size.x + 0.99999f);
+    }
+    // Empty text doesn't add padding
+    const ImVec2 total_size(g.FontSize + (label_size.x > 0.0f ? (label_size.x + style.FramePadding.x * 2) : 0.0f), label_size.y);
+    const ImVec2 pos(window->DC.CursorPos.x, window->DC.CursorPos.y + window->DC.CurrLineTextBaseOffset);
+    ImGui::ItemSize(total_size, 0.0f);
+    const ImRect bb(pos, ImVec2(pos.x + total_size.x, pos.y + total_size.y));
+    if (!ImGui::ItemAdd(bb, 0)) {
+        return;
+    }
+    const ImU32 text_col = ImGui::GetColorU32(ImGuiCol_Text);
+    ImGui::RenderBullet(window->DrawList, ImVec2(bb.Min.x + style.FramePadding.x + g.FontSize * 0.5f, bb.Min.y + g.FontSize * 0.5f), text_col);
+    ImGui::RenderText(ImVec2(bb.Min.x + g.FontSize + style.FramePadding.x * 2, bb.Min.y), text, text_end, false);
+}
+} // namespace internal
+
+enum ListSort {
+    ListSort_None,
+    ListSort_Ascending,
+    ListSort_Descending,
+};
+
+enum ListFilterState {
+    ListFilterState_Idle,       // view matches the current filter and sort
+    ListFilterState_Running,    // a newer view is being built, the old one is still shown
+};
+
+namespace internal {
+// Orders rows by their folded label, ties keep list order.
+static void SortRows(const LabelArena& arena, std::vector<int>& rows, ListSort sort) {
+    if (sort == ListSort_None) {
+        return;
+    }
+    std::sort(rows.begin(), rows.end(), [&](int a, int b) {
+        const int order = arena.GetRow(a).compare(arena.GetRow(b));
+        if (order != 0) {
+            return sort == ListSort_Ascending ? order < 0 : order > 0;
+        }
+        return a < b;
+    });
+}
+
+class WorkerPool {
+public:
+    explicit WorkerPool(size_t thread_count) {
+        stop_ = false;
+        for (size_t i = 0; i < thread_count; i++) {
+            threads_.emplace_back([this]() { Run(); });
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    void Submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push_back(std::move(task));
+        }
+        cv_.notify_one();
+    }
+
+    size_t GetThreadCount() {
+        return threads_.size();
+    }
+
+private:
+    void Run() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
+                if (stop_ && tasks_.empty()) {
+                    return;
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            task();
+        }
+    }
+
+private:
+    std::vector<std::thread> threads_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_;
+};
+} // namespace internal
+
+internal::WorkerPool& GetWorkerPool();
+
+namespace internal {
+/*
+* Filter/sort jobs for ListContainer on the worker pool.
+* Each Submit bumps the generation, older jobs notice it and stop early.
+* Results come back through an atomic pointer: the worker publishes into ready_,
+* the UI thread takes it with one exchange, no lock on either side.
+* Progress carries the generation it belongs to, an older job still finishing a chunk cannot overwrite it.
+*/
+class AsyncListFilter {
+public:
+    struct Result {
+        uint64_t generation;
+        uint64_t arena_version;
+        std::string filter;
+        ListSort sort;
+        std::vector<int> rows;
+    };
+
+    AsyncListFilter() : state_(std::make_shared<State>()) {
+    }
+
+    ~AsyncListFilter() {
+        Cancel();
+    }
+
+    // base holds the previous rows when the query only grew, otherwise the whole arena is searched
+    void Submit(std::shared_ptr<const LabelArena> arena, uint64_t arena_version, const std::string& filter, ListSort sort, const std::vector<int>* base) {
+        const uint64_t generation = ++state_->generation;
+        state_->total_rows = (uint32_t)(base ? base->size() : arena->GetRowCount());
+        state_->progress = MakeProgress(generation, 0);
+
+        Result* result = state_->spare.exchange(nullptr);
+        if (result == nullptr) {
+            result = new Result();
+        }
+        result->generation = generation;
+        result->arena_version = arena_version;
+        result->filter = filter;
+        result->sort = sort;
+        result->rows.clear();
+        std::vector<int> base_rows;
+        if (base) {
+            base_rows = *base;
+        }
+        const bool narrow = base != nullptr;
+
+        auto state = state_;
+        GetWorkerPool().Submit([state, arena, result, narrow, base_rows = std::move(base_rows)]() {
+            Run(*state, *arena, result, narrow, base_rows);
+        });
+    }
+
+    // The newest finished result, or nullptr. Hand it back through Recycle once consumed.
+    Result* Poll() {
+        Result* result = state_->ready.exchange(nullptr);
+        if (result && result->generation != state_->generation) {
+            Recycle(result);
+            return nullptr;
+        }
+        return result;
+    }
+
+    void Recycle(Result* result) {
+        delete state_->spare.exchange(result);
+    }
+
+    void Cancel() {
+        ++state_->generation;
+    }
+
+    float GetProgress() {
+        const uint32_t total = state_->total_rows;
+        const uint64_t progress = state_->progress;
+        if (progress >> 32 != (uint32_t)state_->generation) {
+            return 0.0f;
+        }
+        return total == 0 ? 1.0f : (float)(uint32_t)progress / (float)total;
+    }
+
+private:
+    // Low 32 bits of the generation above the done rows
+    static uint64_t MakeProgress(uint64_t generation, uint32_t done_rows) {
+        return ((uint64_t)(uint32_t)generation << 32) | done_rows;
+    }
+
+    struct State {
+        State() : generation(0), total_rows(0), progress(0), ready(nullptr), spare(nullptr) {
+        }
+
+        ~State() {
+            delete ready.load();
+            delete spare.load();
+        }
+
+        std::atomic<uint64_t> generation;
+        std::atomic<uint32_t> total_rows;
+        std::atomic<uint64_t> progress;
+        std::atomic<Result*> ready;
+        std::atomic<Result*> spare;
+    };
+
+    static void Run(State& state, const LabelArena& arena, Result* result, bool narrow, const std::vector<int>& base) {
+        const size_t kChunkRows = 1 << 16;
+        const size_t total = narrow ? base.size() : arena.GetRowCount();
+        for (size_t first = 0; first < total; first += kChunkRows) {
+            if (state.generation != result->generation) {
+                delete result;
+                return;
+            }
+            const size_t last = (std::min)(first + kChunkRows, total);
+            if (narrow) {
+                for (size_t i = first; i < last; i++) {
+                    if (arena.Contains(base[i], result->filter)) {
+                        result->rows.push_back(base[i]);
+                    }
+                }
+            }
+            else {
+                arena.Search(result->filter, result->rows, first, last);
+            }
+            // Only advances progress of the own generation, a newer Submit may have reset it meanwhile
+            uint64_t expected = state.progress;
+            while (expected >> 32 == (uint32_t)result->generation
+                && !state.progress.compare_exchange_weak(expected, MakeProgress(result->generation, (uint32_t)last))) {
+            }
+        }
+        if (state.generation != result->generation) {
+            delete result;
+            return;
+        }
+        SortRows(arena, result->rows, result->sort);
+        delete state.ready.exchange(result);
+    }
+
+private:
+    std::shared_ptr<State> state_;
+};
+} // namespace internal
+
+/*
+* List storage shared by Combo and ListBox.
+* With a key func the list can be updated row by row; the selection follows its key
+* and only rows that actually changed rebuild their cached label.
+*/
+template<class Element, class Key = std::string>
+class ListContainer {
+public:
+    ListContainer() {
+        end_select_index_ = -1;
+        select_index_ = -1;
+        select_key_valid_ = false;
+        arena_dirty_ = true;
+        arena_version_ = 0;
+        view_valid_ = false;
+        view_version_ = 0;
+        view_sort_ = ListSort_None;
+        sort_ = ListSort_None;
+        async_ = false;
+        async_pending_ = false;
+        pending_version_ = 0;
+        pending_sort_ = ListSort_None;
+    }
+
+    /*
+    * Event
+    */
+    template<class Fn>
+    void SelectEvent(Fn&& event) {
+        if (end_select_index_ != select_index_) {
+            IMGUI_EX_PROFILE_SCOPE("", "SelectEvent");
+            event();
+        }
+    }
+
+
+    /*
+    * Control
+    */
+    Element& GetSelectItem() {
+        return list_.at(select_index_);
+    }
+
+    int GetSelectIndex() {
+        return select_index_;
+    }
+
+    void SetSelectIndex(int select_index) {
+        Select(select_index);
+    }
+
+    void SetList(std::vector<Element>&& list) {
+        list_ = std::move(list);
+        labels_.clear();
+        labels_.resize(list_.size());
+        arena_dirty_ = true;
+        RebuildKeyIndex(0);
+        RestoreSelect();
+    }
+
+    std::vector<Element>& GetList() {
+        return list_;
+    }
+
+    void ClearList() {
+        list_.clear();
+        labels_.clear();
+        key_index_.clear();
+        arena_dirty_ = true;
+        RestoreSelect();
+    }
+
+
+    /*
+    * Keyed update
+    */
+    void SetKeyFunc(std::function<Key(const Element&)> key) {
+        key_func_ = std::move(key);
+        RebuildKeyIndex(0);
+        SaveSelectKey();
+    }
+
+    void SetLabelFunc(std::function<std::string(Element&)> label) {
+        label_func_ = std::move(label);
+        InvalidateLabels();
+    }
+
+    Element* Find(const Key& key) {
+        auto it = key_index_.find(key);
+        if (it == key_index_.end()) {
+            return nullptr;
+        }
+        return &list_[it->second];
+    }
+
+    int FindIndex(const Key& key) {
+        auto it = key_index_.find(key);
+        if (it == key_index_.end()) {
+            return -1;
+        }
+        return (int)it->second;
+    }
+
+    bool Insert(size_t pos, Element&& element) {
+        if (!key_func_) {
+            return false;
+        }
+        SyncLabels();
+        if (key_index_.count(key_func_(element))) {
+            return false;
+        }
+        if (pos > list_.size()) {
+            pos = list_.size();
+        }
+        list_.insert(list_.begin() + pos, std::move(element));
+        labels_.insert(labels_.begin() + pos, Label());
+        arena_dirty_ = true;
+        RebuildKeyIndex(pos);
+        RestoreSelect();
+        return true;
+    }
+
+    bool Erase(const Key& key) {
+        SyncLabels();
+        auto it = key_index_.find(key);
+        if (it == key_index_.end()) {
+            return false;
+        }
+        size_t pos = it->second;
+        key_index_.erase(it);
+        list_.erase(list_.begin() + pos);
+        labels_.erase(labels_.begin() + pos);
+        arena_dirty_ = true;
+        RebuildKeyIndex(pos);
+        RestoreSelect();
+        return true;
+    }
+
+    bool Move(const Key& key, size_t pos) {
+        SyncLabels();
+        auto it = key_index_.find(key);
+        if (it == key_index_.end()) {
+            return false;
+        }
+        size_t from = it->second;
+        if (pos >= list_.size()) {
+            pos = list_.size() - 1;
+        }
+        if (from < pos) {
+            std::rotate(list_.begin() + from, list_.begin() + from + 1, list_.begin() + pos + 1);
+            std::rotate(labels_.begin() + from, labels_.begin() + from + 1, labels_.begin() + pos + 1);
+            RebuildKeyIndex(from, pos + 1);
+        }
+        else if (from > pos) {
+            std::rotate(list_.begin() + pos, list_.begin() + from, list_.begin() + from + 1);
+            std::rotate(labels_.begin() + pos, labels_.begin() + from, labels_.begin() + from + 1);
+            RebuildKeyIndex(pos, from + 1);
+        }
+        arena_dirty_ = true;
+        RestoreSelect();
+        return true;
+    }
+
+    bool Patch(const Key& key, Element&& element) {
+        SyncLabels();
+        auto it = key_index_.find(key);
+        if (it == key_index_.end() || !(key_func_(element) == key)) {
+            return false;
+        }
+        list_[it->second] = std::move(element);
+        labels_[it->second].dirty = true;
+        arena_dirty_ = true;
+        return true;
+    }
+
+    // Reconcile against a freshly built list by key, Element needs operator==.
+    // Rows that kept both key and value also keep their label; returns the number of rows invalidated.
+    size_t Update(std::vector<Element>&& list) {
+        if (!key_func_) {
+            SetList(std::move(list));
+            return list_.size();
+        }
+        SyncLabels();
+        std::vector<Label> labels(list.size());
+        size_t changed = 0;
+        for (size_t i = 0; i < list.size(); i++) {
+            auto it = key_index_.find(key_func_(list[i]));
+            if (it != key_index_.end() && list_[it->second] == list[i]) {
+                labels[i] = std::move(labels_[it->second]);
+                labels_[it->second].dirty = true;
+            }
+            else {
+                changed++;
+            }
+        }
+        list_ = std::move(list);
+        labels_ = std::move(labels);
+        arena_dirty_ = true;
+        RebuildKeyIndex(0);
+        RestoreSelect();
+        return changed;
+    }
+
+    const std::string& GetItemLabel(size_t index) {
+        Label& label = labels_.at(index);
+        if (label.dirty) {
+            label.text = label_func_ ? label_func_(list_[index]) : std::string();
+            label.dirty = false;
+        }
+        return label.text;
+    }
+
+    void InvalidateLabel(size_t index) {
+        labels_.at(index).dirty = true;
+        arena_dirty_ = true;
+    }
+
+    void InvalidateLabels() {
+        for (auto& label : labels_) {
+            label.dirty = true;
+        }
+        arena_dirty_ = true;
+    }
+
+
+    /*
+    * Filter
+    */
+    // Case-insensitive (ASCII) substring filter over the labels from SetLabelFunc,
+    // applied by the cached InsertUpdate().
+    void SetFilter(const std::string& filter) {
+        filter_ = internal::FoldAscii(filter);
+    }
+
+    const std::string& GetFilter() {
+        return filter_;
+    }
+
+    void SetSort(ListSort sort) {
+        sort_ = sort;
+    }
+
+    ListSort GetSort() {
+        return sort_;
+    }
+
+    // Filter and sort on the worker pool; the previous view stays on screen until the new one is ready.
+    void SetAsync(bool async) {
+        if (!async && async_pending_) {
+            async_filter_.Cancel();
+            async_pending_ = false;
+        }
+        async_ = async;
+    }
+
+    ListFilterState GetFilterState() {
+        return async_pending_ ? ListFilterState_Running : ListFilterState_Idle;
+    }
+
+    float GetFilterProgress() {
+        return async_pending_ ? async_filter_.GetProgress() : 1.0f;
+    }
+
+    // List indices of the rows passing the filter, in list order unless sorted.
+    // In async mode it can lag behind list changes for a few frames, check indices against GetList().
+    const std::vector<int>& GetFilterView() {
+        UpdateView();
+        return view_;
+    }
+
+protected:
+    struct Label {
+        std::string text;
+        bool dirty = true;
+    };
+
+    void Select(int index) {
+        select_index_ = index;
+        SaveSelectKey();
+    }
+
+    void SelectEnd() {
+        end_select_index_ = select_index_;
+    }
+
+    bool HasLabelFunc() {
+        return (bool)label_func_;
+    }
+
+    void UpdateView() {
+        SyncLabels();
+        if (arena_dirty_) {
+            // Workers may still be reading the old arena
+            if (!arena_ || arena_.use_count() > 1) {
+                arena_ = std::make_shared<internal::LabelArena>();
+            }
+            arena_->Build(list_.size(), [this](size_t i) -> const std::string& { return GetItemLabel(i); });
+            arena_dirty_ = false;
+            arena_version_++;
+        }
+        if (view_valid_ && view_version_ == arena_version_ && view_filter_ == filter_ && view_sort_ == sort_) {
+            if (async_pending_) {
+                async_filter_.Cancel();
+                async_pending_ = false;
+            }
+            return;
+        }
+        if (async_) {
+            UpdateAsyncView();
+            return;
+        }
+        if (CanNarrowView()) {
+            arena_->Narrow(filter_, view_);
+        }
+        else {
+            view_.clear();
+            arena_->Search(filter_, view_);
+            internal::SortRows(*arena_, view_, sort_);
+        }
+        view_filter_ = filter_;
+        view_sort_ = sort_;
+        view_version_ = arena_version_;
+        view_valid_ = true;
+    }
+
+    // A query that contains the previous one can only drop rows
+    bool CanNarrowView() {
+        return view_valid_ && view_version_ == arena_version_ && view_sort_ == sort_
+            && !view_filter_.empty() && filter_.find(view_filter_) != std::string::npos;
+    }
+
+    void UpdateAsyncView() {
+        if (auto result = async_filter_.Poll()) {
+            view_.swap(result->rows);
+            view_filter_ = result->filter;
+            view_sort_ = result->sort;
+            view_version_ = result->arena_version;
+            view_valid_ = true;
+            async_filter_.Recycle(result);
+            async_pending_ = false;
+            if (view_version_ == arena_version_ && view_filter_ == filter_ && view_sort_ == sort_) {
+                return;
+            }
+        }
+        if (async_pending_ && pending_version_ == arena_version_ && pending_filter_ == filter_ && pending_sort_ == sort_) {
+            return;
+        }
+        async_filter_.Submit(arena_, arena_version_, filter_, sort_, CanNarrowView() ? &view_ : nullptr);
+        pending_version_ = arena_version_;
+        pending_filter_ = filter_;
+        pending_sort_ = sort_;
+        async_pending_ = true;
+    }
+
+    // GetList() hands out the vector itself, catch up if rows were added or removed through it.
+    void SyncLabels() {
+        if (labels_.size() != list_.size()) {
+            labels_.clear();
+            labels_.resize(list_.size());
+            arena_dirty_ = true;
+            RebuildKeyIndex(0);
+        }
+    }
+
+private:
+    void RebuildKeyIndex(size_t first, size_t last = SIZE_MAX) {
+        if (!key_func_) {
+            return;
+        }
+        if (first == 0 && last >= list_.size()) {
+            key_index_.clear();
+        }
+        last = (std::min)(last, list_.size());
+        for (size_t i = first; i < last; i++) {
+            key_index_[key_func_(list_[i])] = i;
+        }
+    }
+
+    void SaveSelectKey() {
+        select_key_valid_ = key_func_ && select_index_ >= 0 && select_index_ < (int)list_.size();
+        if (select_key_valid_) {
+            select_key_ = key_func_(list_[select_index_]);
+        }
+    }
+
+    void RestoreSelect() {
+        if (!select_key_valid_) {
+            return;
+        }
+        int index = FindIndex(select_key_);
+        // Same item at a new position is not a selection change
+        if (index != -1 && end_select_index_ == select_index_) {
+            end_select_index_ = index;
+        }
+        select_index_ = index;
+        if (index == -1) {
+            select_key_valid_ = false;
+        }
+    }
+
+protected:
+    std::vector<Element> list_;
+    std::vector<Label> labels_;
+
+    int end_select_index_;
+    int select_index_;
+
+private:
+    std::function<Key(const Element&)> key_func_;
+    std::function<std::string(Element&)> label_func_;
+    std::unordered_map<Key, size_t> key_index_;
+
+    bool select_key_valid_;
+    Key select_key_;
+
+    std::shared_ptr<internal::LabelArena> arena_;
+    uint64_t arena_version_;
+    bool arena_dirty_;
+
+    std::string filter_;
+    ListSort sort_;
+
+    std::vector<int> view_;
+    std::string view_filter_;
+    ListSort view_sort_;
+    uint64_t view_version_;
+    bool view_valid_;
+
+    internal::AsyncListFilter async_filter_;
+    bool async_;
+    bool async_pending_;
+    std::string pending_filter_;
+    ListSort pending_sort_;
+    uint64_t pending_version_;
+};
+
+template<class Element = std::string, class Key = std::string>
+class Combo : public Widget,
+              public Expandable,
+              public ListContainer<Element, Key>
+{
+public:
+    Combo(const std::string& label) : Widget(label) {
+        end_expand_ = false;
+        expand_ = false;
+    }
+
+    void Begin() {
+        Widget::Begin();
+        if (this->HasLabelFunc()) {
+            this->SyncLabels();
+            if (this->select_index_ >= 0 && this->select_index_ < (int)this->list_.size()) {
+                select_label_ = this->GetItemLabel(this->select_index_);
+            }
+            else {
+                select_label_.clear();
+            }
+        }
+        expand_ = ImGui::BeginCombo(GetLabel().c_str(), select_label_.c_str());
+    }
+
+    void End() {
+        if (expand_) {
+            ImGui::EndCombo();
+        }
+        end_expand_ = expand_;
+        this->SelectEnd();
+        Widget::End();
+    }
+
+    /*
+    * Update
+    */
+    // insert returns each row's label, text from FrameFormat keeps the rows formatted every frame off the heap
+    template<class Fn>
+    void InsertUpdate(Fn&& insert) {
+        if (expand_ == false) {
+            return;
+        }
+        auto& list = this->list_;
+        for (int i = 0; i < list.size(); i++) {
+            const bool is_selected = (this->select_index_ == i);
+            auto&& temp = insert(list[i]);
+            const char* label = internal::LabelData(temp);
+
+            if (label == nullptr || label[0] == '\0') {
+                continue;
+            }
+
+            if (ImGui::Selectable(label, is_selected)) {
+                this->Select(i);
+                select_label_ = label;
+            }
+
+            if (is_selected) {
+                ImGui::SetItemDefaultFocus();
+            }
+        }
+        
+    }
+
+    // Uses the labels cached through SetLabelFunc, only the visible rows of the filter view are submitted
+    void InsertUpdate() {
+        if (expand_ == false) {
+            return;
+        }
+        const auto& view = this->GetFilterView();
+        ImGuiListClipper clipper;
+        clipper.Begin((int)view.size());
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+                const int i = view[row];
+                if (i >= (int)this->list_.size()) {
+                    continue;
+                }
+                const bool is_selected = (this->select_index_ == i);
+                const std::string& label = this->GetItemLabel(i);
+
+                if (ImGui::Selectable(label.c_str(), is_selected)) {
+                    this->Select(i);
+                    select_label_ = label;
+                }
+
+                if (is_selected) {
+                    ImGui::SetItemDefaultFocus();
+                }
+            }
+        }
+    }
+
+private:
+    std::string select_label_;
+
+};
+
+class InputText : public Widget {
+public:
+    InputText(const std::string& label, size_t text_size) : Widget(label), text_(text_size, '\0') {
+        end_input_ = false;
+        input_ = false;
+    }
+
+    void Begin() {
+        Widget::Begin();
+        if (ImGui::InputText(GetLabel().c_str(), (char*)text_.c_str(), text_.size())) {
+            input_ = true;
+        } else {
+            input_ = false;
+        }
+    }
+
+    void End() {
+        end_input_ = input_;
+        Widget::End();
+    }
+
+    /*
+    * Event
+    */
+    template<class Fn>
+    void InputEvent(Fn&& event) {
+        if (input_ == true && input_ != end_input_) {
+            IMGUI_EX_PROFILE_SCOPE(GetLabel(), "InputEvent");
+            event();
+        }
+    }
+
+    // Points into the widget's buffer, valid until the next Begin or SetText
+    const char* GetText() {
+        return text_.c_str();
+    }
+
+    void SetText(const std::string& text) {
+        memcpy((void*)text_.c_str(), text.c_str(), (text_.size() < text.size() ? text_.size() : text.size()));
+    }
+
+private:
+    std::string text_;
+
+    bool end_input_;
+    bool input_;
+};
+
+class InputTextMultiline : public Widget {
+public:
+    InputTextMultiline(const std::string& label, const std::string& text = "", ImGuiInputTextFlags flags = 0) : Widget(label), size_(-FLT_MIN, -FLT_MIN) {
+        end_input_ = false;
+        input_ = false;
+
+        flags_ = flags | ImGuiInputTextFlags_CallbackResize;
+        SetText(text);
+    }
+
+    void Begin() {
+        if (text_.empty()) {
+            text_.push_back('\0');
+        }
+        Widget::Begin();
+        if (ImGui::InputTextMultiline(GetLabel().c_str(), text_.begin(), text_.size(), size_, flags_, ResizeCallback, &text_)) {
+            input_ = true;
+        }
+        else {
+            input_ = false;
+        }
+    }
+
+    void End() {
+        end_input_ = input_;
+        Widget::End();
+    }
+
+    /*
+    * Event
+    */
+    template<class Fn>
+    void InputEvent(Fn&& event) {
+        if (input_ == true && input_ != end_input_) {
+            IMGUI_EX_PROFILE_SCOPE(GetLabel(), "InputEvent");
+            event();
+        }
+    }
+
+    // Points into the widget's buffer, valid until the next Begin or SetText
+    const char* GetText() {
+        return &text_[0];
+    }
+
+    void SetText(const std::string& text) {
+        text_.clear();
+        text_.resize(text.size() + 1);
+        memcpy(&text_[0], &text[0], text.size() + 1);
+    }
+
+    void SetSize(const ImVec2& size) {
+        size_ = size;
+    }
+
+    ImVec2& GetSize() {
+        return size_;
+    }
+
+    void SetReadOnly(bool enable) {
+        if (enable) {
+            flags_ |= ImGuiInputTextFlags_ReadOnly;
+        }
+        else {
+            flags_ &= (~ImGuiInputTextFlags_ReadOnly);
+        }
+    }
+
+private:
+    static int ResizeCallback(ImGuiInputTextCallbackData* data) {
+        if (data->EventFlag == ImGuiInputTextFlags_CallbackResize) {
+            ImVector<char>* my_str = (ImVector<char>*)data->UserData;
+            IM_ASSERT(my_str->begin() == data->Buf);
+            my_str->resize(data->BufSize); // NB: On resizing calls, generally data->BufSize == data->BufTextLen + 1
+            data->Buf = my_str->begin();
+        }
+        return 0;
+    }
+
+private:
+    ImVector<char> text_;
+
+    bool end_input_;
+    bool input_;
+
+    ImVec2 size_;
+
+    ImGuiInputTextFlags flags_;
+};
+
+class Text : public Widget {
+public:
+    template<typename ... Args>
+    Text(const char* fmt, Args... args) : Widget(fmt) {
+        
+    }
+
+    void Begin() {
+        Widget::Begin();
+        // Labels without format specifiers print as they are, their size comes from the widget's TextSizeMemo
+        const std::string& label = GetLabel();
+        if (label.find('%') == std::string::npos) {
+            internal::TextUnformattedCached(label.c_str(), label.c_str() + label.size(), &text_size_);
+        }
+        else {
+            ImGui::Text(label.c_str());
+        }
+    }
+
+    void End() {
+        Widget::End();
+    }
+
+
+    const std::string& GetText() {
+        return GetLabel();
+    }
+
+    void SetText(const std::string& text) {
+        return SetLabel(text);
+    }
+
+private:
+    std::string text_;
+    internal::TextSizeMemo text_size_;
+};
+
+class SeparatorText : public Widget {
+public:
+    SeparatorText(const std::string& label) : Widget(label) {
+        
+    }
+
+    void Begin() {
+        Widget::Begin();
+        ImGui::SeparatorText(GetLabel().c_str());
+    }
+
+    void End() {
+        Widget::End();
+    }
+};
+
+class BulletText : public Widget {
+public:
+    template<typename ... Args>
+    BulletText(const char* fmt, Args... args) : Widget(fmt) {
+        
+    }
+
+    void Begin() {
+        Widget::Begin();
+        // Same as Text, labels without format specifiers take their size from the widget's TextSizeMemo
+        const std::string& label = GetLabel();
+        if (label.find('%') == std::string::npos) {
+            internal::BulletTextCached(label.c_str(), label.c_str() + label.size(), &text_size_);
+        }
+        else {
+            ImGui::BulletText(label.c_str());
+        }
+    }
+
+    void End() {
+        Widget::End();
+    }
+
+private:
+    internal::TextSizeMemo text_size_;
+};
+
+class HelpMarker : public Widget {
+public:
+    HelpMarker(const std::string& title, const std::string& desc) : Widget(title), desc_(desc) {
+        
+    }
+
+    void Begin() {
+        Widget::Begin();
+        
+        ImGui::TextDisabled(GetLabel().c_str());
+        if (ImGui::BeginItemTooltip()) {
+            ImGui::PushTextWrapPos(ImGui::GetFontSize() * 35.0f);
+            ImGui::TextUnformatted(desc_.c_str());
+            ImGui::PopTextWrapPos();
+            ImGui::EndTooltip();
+        }
+    }
+
+    void End() {
+        Widget::End();
+    }
+
+private:
+    std::string desc_;
+};
+
+
+class CollapsingHeader : public Widget,
+                         public Expandable
+{
+public:
+    CollapsingHeader(const std::string& label) : Widget(label) {
+        control_expand_ = -1;
+    }
+
+    void Begin() {
+        Widget::Begin();
+        if (control_expand_ != -1) {
+            ImGui::SetNextItemOpen(control_expand_ == 1);
+            control_expand_ = -1;
+        }
+        expand_ = ImGui::CollapsingHeader(GetLabel().c_str());
+    }
+
+    void End() {
+        end_expand_ = expand_;
+        Widget::End();
+    }
+
+    /*
+    * Control
+    */
+    void SetExpand(bool expand) {
+        control_expand_ = expand ? 1 : 0;
+    }
+
+private:
+    int control_expand_;    // -1 leaves the open state to ImGui
+};
+
+class TreeNode : public Widget,
+                 public Expandable
+{
+public:
+    TreeNode(const std::string& label) : Widget(label) {
+        end_expand_ = false;
+        expand_ = false;
+        control_expand_ = -1;
+    }
+
+    void Begin() {
+        Widget::Begin();
+        if (control_expand_ != -1) {
+            ImGui::SetNextItemOpen(control_expand_ == 1);
+            control_expand_ = -1;
+        }
+        expand_ = ImGui::TreeNode(GetLabel().c_str());
+    }
+
+    void End() {
+        if (expand_) {
+            ImGui::TreePop();
+        }
+        end_expand_ = expand_;
+        Widget::End();
+    }
+
+
+    /*
+    * Event
+    */
+
+    /*
+    * Control
+    */
+    void SetExpand(bool expand) {
+        control_expand_ = expand ? 1 : 0;
+    }
+
+private:
+    int control_expand_;    // -1 leaves the open state to ImGui
+};
+
+class CheckBox : public Widget {
+public:
+    CheckBox(const std::string& label, bool check = false) : Widget(label) {
+        end_check_ = false;
+        check_ = check;
+    }
+
+    void Begin() {
+        Widget::Begin();
+        ImGui::Checkbox(GetLabel().c_str(), &check_);
+    }
+
+    void End() {
+        end_check_ = check_;
+        Widget::End();
+    }
+
+
+    /*
+    * Event
+    */
+    template<class Fn>
+    void CheckEvent(Fn&& event) {
+        if (end_check_ == false && check_ == true) {
+            IMGUI_EX_PROFILE_SCOPE(GetLabel(), "CheckEvent");
+            event();
+        }
+    }
+
+    template<class Fn>
+    void UncheckEvent(Fn&& event) {
+        if (end_check_ == true && check_ == false) {
+            IMGUI_EX_PROFILE_SCOPE(GetLabel(), "UncheckEvent");
+            event();
+        }
+    }
+
+    /*
+    * Control
+    */
+    bool GetCheck() {
+        return check_;
+    }
+
+    void SetCheck(bool check) {
+        check_ = check;
+    }
+
+private:
+    bool end_check_;
+    bool check_;
+};
+
+template<class Element = std::string, class Key = std::string>
+class ListBox : public Widget,
+                public ListContainer<Element, Key>
+{
+public:
+    ListBox(const std::string& label) : Widget(label), size_(-FLT_MIN, -FLT_MIN) {
+        entry_ = false;
+    }
+
+    void Begin() {
+        Widget::Begin();
+        entry_ = ImGui::BeginListBox(GetLabel().c_str(), size_);
+    }
+
+    void End() {
+        if (entry_) {
+            ImGui::EndListBox();
+        }
+        this->SelectEnd();
+        Widget::End();
+    }
+
+    /*
+    * Update
+    */
+    // insert returns each row's label, text from FrameFormat keeps the rows formatted every frame off the heap
+    template<class Fn>
+    void InsertUpdate(Fn&& insert) {
+        auto& list = this->list_;
+        for (int i = 0; i < list.size(); i++) {
+            const bool is_selected = (this->select_index_ == i);
+            auto&& temp = insert(list[i]);
+            const char* label = internal::LabelData(temp);
+
+            if (label == nullptr || label[0] == '\0') {
+                continue;
+            }
+
+            if (ImGui::Selectable(label, is_selected)) {
+                this->Select(i);
+            }
+
+            if (is_selected) {
+                ImGui::SetItemDefaultFocus();
+            }
+        }
+    }
+
+    // Uses the labels cached through SetLabelFunc, only the visible rows of the filter view are submitted
+    void InsertUpdate() {
+        if (entry_ == false) {
+            return;
+        }
+        const auto& view = this->GetFilterView();
+        ImGuiListClipper clipper;
+        clipper.Begin((int)view.size());
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+                const int i = view[row];
+                if (i >= (int)this->list_.size()) {
+                    continue;
+                }
+                const bool is_selected = (this->select_index_ == i);
+
+                if (ImGui::Selectable(this->GetItemLabel(i).c_str(), is_selected)) {
+                    this->Select(i);
+                }
+
+                if (is_selected) {
+                    ImGui::SetItemDefaultFocus();
+                }
+            }
+        }
+    }
+
+    /*
+    * Control
+    */
+    void SetSize(const ImVec2& size) {
+        size_ = size;
+    }
+
+    ImVec2& GetSize() {
+        return size_;
+    }
+
+private:
+    ImVec2 size_;
+
+    bool entry_;
+};
+
+/*
+* Table over ImGui::BeginTable.
+* Rows stay in the order they were set; header sorting only reorders a permutation.
+* Cell strings are cached per column and formatted the first time a row becomes visible.
+*/
+template<class Row>
+class Table : public Widget {
+public:
+    Table(const std::string& label, ImGuiTableFlags flags = ImGuiTableFlags_Sortable | ImGuiTableFlags_SortMulti | ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_Reorderable | ImGuiTableFlags_Hideable)
+        : Widget(label), size_(0.0f, 0.0f) {
+        entry_ = false;
+        flags_ = flags;
+        sort_ = false;
+        end_select_index_ = -1;
+        select_index_ = -1;
+    }
+
+    void Begin() {
+        Widget::Begin();
+        sort_ = false;
+        entry_ = !columns_.empty() && ImGui::BeginTable(GetLabel().c_str(), (int)columns_.size(), flags_, size_);
+        if (!entry_) {
+            return;
+        }
+        ImGui::TableSetupScrollFreeze(0, 1);
+        for (size_t i = 0; i < columns_.size(); i++) {
+            ImGui::TableSetupColumn(columns_[i].name.c_str(), columns_[i].flags, 0.0f, (ImGuiID)i);
+        }
+        ImGui::TableHeadersRow();
+
+        ImGuiTableSortSpecs* sort_specs = ImGui::TableGetSortSpecs();
+        if (sort_specs && sort_specs->SpecsDirty) {
+            sort_specs_.assign(sort_specs->Specs, sort_specs->Specs + sort_specs->SpecsCount);
+            sort_specs->SpecsDirty = false;
+            Sort();
+            sort_ = true;
+        }
+    }
+
+    void End() {
+        if (entry_) {
+            ImGui::EndTable();
+            entry_ = false;
+        }
+        end_select_index_ = select_index_;
+        Widget::End();
+    }
+
+    /*
+    * Update
+    */
+    // Submits only the rows inside the scroll region
+    void InsertUpdate() {
+        if (entry_ == false) {
+            return;
+        }
+        if (order_.size() != rows_.size()) {
+            ResetOrder();
+        }
+        ImGuiListClipper clipper;
+        clipper.Begin((int)order_.size());
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+                const int index = order_[row];
+                FormatRow(index);
+                ImGui::TableNextRow();
+                for (size_t column = 0; column < columns_.size(); column++) {
+                    if (!ImGui::TableSetColumnIndex((int)column)) {
+                        continue;
+                    }
+                    const std::string& cell = columns_[column].cells[index];
+                    if (column == 0) {
+                        const bool is_selected = (select_index_ == index);
+                        ImGui::PushID(index);
+                        if (ImGui::Selectable(cell.c_str(), is_selected, ImGuiSelectableFlags_SpanAllColumns | ImGuiSelectableFlags_AllowOverlap)) {
+                            select_index_ = index;
+                        }
+                        ImGui::PopID();
+                    }
+                    else {
+                        ImGui::TextUnformatted(cell.c_str(), cell.c_str() + cell.size());
+                    }
+                }
+            }
+        }
+    }
+
+    /*
+    * Event
+    */
+    template<class Fn>
+    void SelectEvent(Fn&& event) {
+        if (end_select_index_ != select_index_) {
+            IMGUI_EX_PROFILE_SCOPE(GetLabel(), "SelectEvent");
+            event();
+        }
+    }
+
+    template<class Fn>
+    void SortEvent(Fn&& event) {
+        if (sort_) {
+            IMGUI_EX_PROFILE_SCOPE(GetLabel(), "SortEvent");
+            event();
+        }
+    }
+
+    /*
+    * Control
+    */
+    // Without compare the column sorts by its formatted text
+    void AddColumn(const std::string& name, std::function<std::string(const Row&)> format, std::function<int(const Row&, const Row&)> compare = nullptr, ImGuiTableColumnFlags flags = 0) {
+        Column column;
+        column.name = name;
+        column.format = std::move(format);
+        column.compare = std::move(compare);
+        column.flags = flags;
+        column.cells.resize(rows_.size());
+        columns_.push_back(std::move(column));
+        InvalidateRows();
+    }
+
+    void SetRows(std::vector<Row>&& rows) {
+        rows_ = std::move(rows);
+        for (auto& column : columns_) {
+            column.cells.clear();
+            column.cells.resize(rows_.size());
+        }
+        formatted_.assign(rows_.size(), false);
+        if (select_index_ >= (int)rows_.size()) {
+            select_index_ = -1;
+        }
+        ResetOrder();
+        Sort();
+    }
+
+    std::vector<Row>& GetRows() {
+        return rows_;
+    }
+
+    void ClearRows() {
+        SetRows(std::vector<Row>());
+    }
+
+    // Under a header sort the row moves to its new place, the other rows keep theirs
+    void SetRow(size_t index, Row&& row) {
+        rows_.at(index) = std::move(row);
+        formatted_[index] = false;
+        Reposition((int)index);
+    }
+
+    void InvalidateRow(size_t index) {
+        formatted_.at(index) = false;
+        Reposition((int)index);
+    }
+
+    void InvalidateRows() {
+        formatted_.assign(rows_.size(), false);
+    }
+
+    // Re-apply the current header sort, e.g. after rows were changed in place through GetRows
+    void Sort() {
+        if (order_.size() != rows_.size()) {
+            ResetOrder();
+        }
+        if (sort_specs_.empty()) {
+            return;
+        }
+        FormatSortColumns();
+        std::sort(order_.begin(), order_.end(), [this](int a, int b) { return Less(a, b); });
+    }
+
+    // Row index as passed to SetRows, not the on-screen position
+    int GetSelectIndex() {
+        return select_index_;
+    }
+
+    void SetSelectIndex(int select_index) {
+        select_index_ = select_index;
+    }
+
+    Row& GetSelectItem() {
+        return rows_.at(select_index_);
+    }
+
+    // Row index shown at the given on-screen position
+    int GetOrderIndex(int position) {
+        return order_.at(position);
+    }
+
+    void SetSize(const ImVec2& size) {
+        size_ = size;
+    }
+
+    ImVec2& GetSize() {
+        return size_;
+    }
+
+    ImGuiTableFlags GetFlags() {
+        return flags_;
+    }
+
+    void SetFlags(ImGuiTableFlags flags) {
+        flags_ = flags;
+    }
+
+private:
+    struct Column {
+        std::string name;
+        std::function<std::string(const Row&)> format;
+        std::function<int(const Row&, const Row&)> compare;
+        ImGuiTableColumnFlags flags;
+        std::vector<std::string> cells;
+    };
+
+    void ResetOrder() {
+        order_.resize(rows_.size());
+        for (size_t i = 0; i < order_.size(); i++) {
+            order_[i] = (int)i;
+        }
+        formatted_.resize(rows_.size(), false);
+        for (auto& column : columns_) {
+            column.cells.resize(rows_.size());
+        }
+    }
+
+    void FormatRow(int index) {
+        if (formatted_[index]) {
+            return;
+        }
+        for (auto& column : columns_) {
+            column.cells[index] = column.format(rows_[index]);
+        }
+        formatted_[index] = true;
+    }
+
+    void FormatAll() {
+        for (size_t i = 0; i < rows_.size(); i++) {
+            FormatRow((int)i);
+        }
+    }
+
+    // Columns without compare sort by their text, every row needs it
+    void FormatSortColumns() {
+        for (auto& spec : sort_specs_) {
+            if (!columns_[spec.ColumnUserID].compare) {
+                FormatAll();
+                return;
+            }
+        }
+    }
+
+    bool Less(int a, int b) {
+        for (auto& spec : sort_specs_) {
+            auto& column = columns_[spec.ColumnUserID];
+            int order = column.compare ? column.compare(rows_[a], rows_[b]) : column.cells[a].compare(column.cells[b]);
+            if (order != 0) {
+                return spec.SortDirection == ImGuiSortDirection_Ascending ? order < 0 : order > 0;
+            }
+        }
+        return a < b;
+    }
+
+    // Takes one changed row out of the sorted order and inserts it again, O(n) moves instead of a full sort
+    void Reposition(int index) {
+        if (sort_specs_.empty()) {
+            return;
+        }
+        if (order_.size() != rows_.size()) {
+            Sort();
+            return;
+        }
+        FormatSortColumns();
+        order_.erase(std::find(order_.begin(), order_.end(), index));
+        order_.insert(std::lower_bound(order_.begin(), order_.end(), index, [this](int a, int b) { return Less(a, b); }), index);
+    }
+
+private:
+    std::vector<Row> rows_;
+    std::vector<Column> columns_;
+    std::vector<bool> formatted_;
+    std::vector<int> order_;
+    std::vector<ImGuiTableColumnSortSpecs> sort_specs_;
+
+    ImGuiTableFlags flags_;
+    ImVec2 size_;
+
+    bool entry_;
+    bool sort_;
+
+    int end_select_index_;
+    int select_index_;
+};
+
+/*
+* Tree with lazily loaded children.
+* Expanded nodes are flattened into one visible list, so only the rows inside the
+* clip rect are submitted no matter how deep or large the tree is.
+* Nodes are addressed by index; indices stay valid until SetRoots/ClearRoots,
+* or until Reload drops them, their slots then hold the nodes loaded next.
+*/
+template<class Node>
+class Tree : public Widget {
+public:
+    Tree(const std::string& label) : Widget(label), load_state_(std::make_shared<LoadState>()), size_(-FLT_MIN, -FLT_MIN) {
+        entry_ = false;
+        async_load_ = false;
+        visible_dirty_ = true;
+        end_select_index_ = -1;
+        select_index_ = -1;
+    }
+
+    ~Tree() {
+        ++load_state_->generation;
+    }
+
+    void Begin() {
+        Widget::Begin();
+        ApplyLoaded();
+        entry_ = ImGui::BeginChild(GetLabel().c_str(), size_);
+    }
+
+    void End() {
+        if (entry_) {
+            ImGui::EndChild();
+            entry_ = false;
+        }
+        for (int index : changed_) {
+            items_[index].end_expand = items_[index].expand;
+        }
+        changed_.clear();
+        end_select_index_ = select_index_;
+        Widget::End();
+    }
+
+    /*
+    * Update
+    */
+    void InsertUpdate() {
+        if (entry_ == false) {
+            return;
+        }
+        if (visible_dirty_) {
+            RebuildVisible();
+        }
+        FrameVector<std::pair<int, bool>> toggles;
+        const float indent_spacing = ImGui::GetStyle().IndentSpacing;
+        ImGuiListClipper clipper;
+        clipper.Begin((int)visible_.size());
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+                const VisibleRow& visible = visible_[row];
+                Item& item = items_[visible.index];
+                const float indent = (item.depth + (visible.loading ? 1 : 0)) * indent_spacing;
+                if (indent > 0.0f) {
+                    ImGui::Indent(indent);
+                }
+                if (visible.loading) {
+                    ImGui::TextDisabled("...");
+                }
+                else {
+                    if (item.label_dirty) {
+                        item.label = label_func_ ? label_func_(item.node) : std::string();
+                        item.label_dirty = false;
+                    }
+                    ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_OpenOnDoubleClick | ImGuiTreeNodeFlags_NoTreePushOnOpen | ImGuiTreeNodeFlags_SpanAvailWidth;
+                    if (IsLeaf(item)) {
+                        flags |= ImGuiTreeNodeFlags_Leaf;
+                    }
+                    if (select_index_ == visible.index) {
+                        flags |= ImGuiTreeNodeFlags_Selected;
+                    }
+                    ImGui::SetNextItemOpen(item.expand, ImGuiCond_Always);
+                    const bool expand = ImGui::TreeNodeEx((void*)(intptr_t)visible.index, flags, "%s", item.label.c_str());
+                    if (ImGui::IsItemClicked() && !ImGui::IsItemToggledOpen()) {
+                        select_index_ = visible.index;
+                    }
+                    if (expand != item.expand) {
+                        toggles.emplace_back(visible.index, expand);
+                    }
+                }
+                if (indent > 0.0f) {
+                    ImGui::Unindent(indent);
+                }
+            }
+        }
+        // The visible list must not change while the clipper walks it
+        for (auto& toggle : toggles) {
+            SetExpand(toggle.first, toggle.second);
+        }
+    }
+
+    /*
+    * Event
+    */
+    template<class Fn>
+    void ExpandEvent(Fn&& event) {
+        for (int index : changed_) {
+            if (items_[index].expand == true && items_[index].expand != items_[index].end_expand) {
+                IMGUI_EX_PROFILE_SCOPE(GetLabel(), "ExpandEvent");
+                event(items_[index].node);
+            }
+        }
+    }
+
+    template<class Fn>
+    void CollapsingEvent(Fn&& event) {
+        for (int index : changed_) {
+            if (items_[index].expand == false && items_[index].expand != items_[index].end_expand) {
+                IMGUI_EX_PROFILE_SCOPE(GetLabel(), "CollapsingEvent");
+                event(items_[index].node);
+            }
+        }
+    }
+
+    template<class Fn>
+    void SelectEvent(Fn&& event) {
+        if (end_select_index_ != select_index_) {
+            IMGUI_EX_PROFILE_SCOPE(GetLabel(), "SelectEvent");
+            event();
+        }
+    }
+
+    /*
+    * Control
+    */
+    void SetRoots(std::vector<Node>&& roots) {
+        ClearRoots();
+        for (auto& node : roots) {
+            roots_.push_back(AddItem(std::move(node), -1, 0));
+        }
+    }
+
+    void ClearRoots() {
+        ++load_state_->generation;
+        items_.clear();
+        free_.clear();
+        roots_.clear();
+        changed_.clear();
+        visible_.clear();
+        visible_dirty_ = true;
+        select_index_ = -1;
+    }
+
+    // Called once per node, on its first expand
+    void SetChildrenLoader(std::function<std::vector<Node>(const Node&)> loader) {
+        loader_ = std::move(loader);
+    }
+
+    // Optional, lets nodes show as leaves before anything was loaded
+    void SetLeafFunc(std::function<bool(const Node&)> leaf) {
+        leaf_func_ = std::move(leaf);
+    }
+
+    void SetLabelFunc(std::function<std::string(Node&)> label) {
+        label_func_ = std::move(label);
+        InvalidateLabels();
+    }
+
+    // Run the loader on the worker pool, the node shows a placeholder row until it returns
+    void SetAsyncLoad(bool async_load) {
+        async_load_ = async_load;
+    }
+
+    void SetExpand(int index, bool expand) {
+        Item& item = items_.at(index);
+        if (item.expand == expand) {
+            return;
+        }
+        item.expand = expand;
+        if (expand && !item.loaded && !item.loading) {
+            Load(index);
+        }
+        changed_.push_back(index);
+        visible_dirty_ = true;
+    }
+
+    // Drops the loaded children, the next expand loads them again.
+    // A selection inside the dropped subtree is cleared, periodic reloads reuse the dropped slots.
+    void Reload(int index) {
+        Item& item = items_.at(index);
+        ReleaseChildren(index);
+        item.loaded = false;
+        item.loading = false;
+        if (item.expand) {
+            Load(index);
+        }
+        visible_dirty_ = true;
+    }
+
+    void InvalidateLabel(int index) {
+        items_.at(index).label_dirty = true;
+    }
+
+    void InvalidateLabels() {
+        for (auto& item : items_) {
+            item.label_dirty = true;
+        }
+    }
+
+    Node& GetNode(int index) {
+        return items_.at(index).node;
+    }
+
+    int GetParentIndex(int index) {
+        return items_.at(index).parent;
+    }
+
+    const std::vector<int>& GetChildIndices(int index) {
+        return items_.at(index).children;
+    }
+
+    const std::vector<int>& GetRootIndices() {
+        return roots_;
+    }
+
+    int GetSelectIndex() {
+        return select_index_;
+    }
+
+    void SetSelectIndex(int select_index) {
+        select_index_ = select_index;
+    }
+
+    Node& GetSelectItem() {
+        return items_.at(select_index_).node;
+    }
+
+    size_t GetVisibleCount() {
+        if (visible_dirty_) {
+            RebuildVisible();
+        }
+        return visible_.size();
+    }
+
+    // Nodes held, visible or not, without the slots waiting for reuse
+    size_t GetItemCount() {
+        return items_.size() - free_.size();
+    }
+
+    void SetSize(const ImVec2& size) {
+        size_ = size;
+    }
+
+    ImVec2& GetSize() {
+        return size_;
+    }
+
+private:
+    struct Item {
+        Node node;
+        std::string label;
+        std::vector<int> children;
+        int parent;
+        int depth;
+        unsigned load_ticket;   // bumped per load, stale async results are dropped
+        bool label_dirty;
+        bool loaded;
+        bool loading;
+        bool expand;
+        bool end_expand;
+    };
+
+    struct VisibleRow {
+        int index;
+        bool loading;       // placeholder under a node whose children are still loading
+    };
+
+    struct LoadResult {
+        uint64_t generation;
+        int index;
+        unsigned load_ticket;
+        std::vector<Node> children;
+    };
+
+    struct LoadState {
+        LoadState() : generation(0) {
+        }
+
+        std::atomic<uint64_t> generation;
+        std::mutex mutex;
+        std::vector<LoadResult> loaded;
+    };
+
+    int AddItem(Node&& node, int parent, int depth) {
+        if (!free_.empty()) {
+            const int index = free_.back();
+            free_.pop_back();
+            Item& item = items_[index];
+            // The ticket carries on, a load still running for the dropped node must not match the new one
+            item = Item{ std::move(node), std::string(), {}, parent, depth, item.load_ticket, true, false, false, false, false };
+            return index;
+        }
+        Item item{ std::move(node), std::string(), {}, parent, depth, 0, true, false, false, false, false };
+        items_.push_back(std::move(item));
+        return (int)items_.size() - 1;
+    }
+
+    void ReleaseChildren(int index) {
+        std::vector<int> stack;
+        stack.swap(items_[index].children);
+        while (!stack.empty()) {
+            const int child = stack.back();
+            stack.pop_back();
+            Item& item = items_[child];
+            stack.insert(stack.end(), item.children.begin(), item.children.end());
+            item.children.clear();
+            item.label.clear();
+            item.loaded = false;
+            item.loading = false;
+            item.expand = false;
+            if (select_index_ == child) {
+                select_index_ = -1;
+            }
+            changed_.erase(std::remove(changed_.begin(), changed_.end(), child), changed_.end());
+            free_.push_back(child);
+        }
+    }
+
+    bool IsLeaf(const Item& item) {
+        if (item.loaded) {
+            return item.children.empty();
+        }
+        return !loader_ || (leaf_func_ && leaf_func_(item.node));
+    }
+
+    void Load(int index) {
+        Item& item = items_[index];
+        if (!loader_) {
+            item.loaded = true;
+            return;
+        }
+        if (!async_load_) {
+            AddChildren(index, loader_(item.node));
+            return;
+        }
+        item.loading = true;
+        const unsigned load_ticket = ++item.load_ticket;
+        auto state = load_state_;
+        const uint64_t generation = state->generation;
+        GetWorkerPool().Submit([state, generation, index, load_ticket, loader = loader_, node = item.node]() {
+            auto children = loader(node);
+            if (state->generation != generation) {
+                return;
+            }
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->loaded.push_back(LoadResult{ generation, index, load_ticket, std::move(children) });
+        });
+    }
+
+    void ApplyLoaded() {
+        std::vector<LoadResult> loaded;
+        {
+            std::lock_guard<std::mutex> lock(load_state_->mutex);
+            loaded.swap(load_state_->loaded);
+        }
+        for (auto& result : loaded) {
+            // Skip results for trees cleared or nodes reloaded meanwhile
+            if (result.generation != load_state_->generation) {
+                continue;
+            }
+            Item& item = items_[result.index];
+            if (item.loading && item.load_ticket == result.load_ticket) {
+                AddChildren(result.index, std::move(result.children));
+            }
+        }
+    }
+
+    void AddChildren(int index, std::vector<Node>&& children) {
+        const int depth = items_[index].depth + 1;
+        for (auto& child : children) {
+            const int child_index = AddItem(std::move(child), index, depth);
+            items_[index].children.push_back(child_index);
+        }
+        items_[index].loaded = true;
+        items_[index].loading = false;
+        visible_dirty_ = true;
+    }
+
+    void RebuildVisible() {
+        visible_.clear();
+        std::vector<int> stack(roots_.rbegin(), roots_.rend());
+        while (!stack.empty()) {
+            const int index = stack.back();
+            stack.pop_back();
+            visible_.push_back(VisibleRow{ index, false });
+            const Item& item = items_[index];
+            if (!item.expand) {
+                continue;
+            }
+            if (item.loading) {
+                visible_.push_back(VisibleRow{ index, true });
+                continue;
+            }
+            stack.insert(stack.end(), item.children.rbegin(), item.children.rend());
+        }
+        visible_dirty_ = false;
+    }
+
+private:
+    std::deque<Item> items_;
+    std::vector<int> free_;
+    std::vector<int> roots_;
+    std::vector<VisibleRow> visible_;
+    std::vector<int> changed_;
+    bool visible_dirty_;
+
+    std::function<std::vector<Node>(const Node&)> loader_;
+    std::function<bool(const Node&)> leaf_func_;
+    std::function<std::string(Node&)> label_func_;
+    bool async_load_;
+    std::shared_ptr<LoadState> load_state_;
+
+    ImVec2 size_;
+    bool entry_;
+
+    int end_select_index_;
+    int select_index_;
+};
+
+namespace internal {
+// Folds count floats into [io_min, io_max], 4 lanes per step on SSE2.
+static void MinMax(const float* data, size_t count, float& io_min, float& io_max) {
+    float lo = io_min;
+    float hi = io_max;
+    size_t i = 0;
+#if IMGUI_EX_SSE2
+    if (count >= 4) {
+        __m128 vmin = _mm_set1_ps(lo);
+        __m128 vmax = _mm_set1_ps(hi);
+        for (; i + 4 <= count; i += 4) {
+            const __m128 v = _mm_loadu_ps(data + i);
+            vmin = _mm_min_ps(vmin, v);
+            vmax = _mm_max_ps(vmax, v);
+        }
+        float mins[4], maxs[4];
+        _mm_storeu_ps(mins, vmin);
+        _mm_storeu_ps(maxs, vmax);
+        for (int j = 0; j < 4; j++) {
+            lo = mins[j] < lo ? mins[j] : lo;
+            hi = maxs[j] > hi ? maxs[j] : hi;
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        lo = data[i] < lo ? data[i] : lo;
+        hi = data[i] > hi ? data[i] : hi;
+    }
+    io_min = lo;
+    io_max = hi;
+}
+} // namespace internal
+
+/*
+* Line plot over a ring buffer of samples.
+* Every 16 samples are folded into a min/max pair, every 16 pairs into the next level and
+* so on as samples arrive, so drawing reads at most one min/max per pixel column
+* from the level matching the zoom, however much history is kept.
+* Push from the UI thread.
+*/
+class Plot : public Widget {
+public:
+    Plot(const std::string& label, size_t capacity, const ImVec2& size = ImVec2(-FLT_MIN, 80.0f)) : Widget(label), size_(size) {
+        capacity_ = 16;
+        while (capacity_ < capacity) {
+            capacity_ <<= 1;
+        }
+        samples_.resize(capacity_);
+        for (size_t level_capacity = capacity_ >> kBlockShift; level_capacity >= 2; level_capacity >>= kBlockShift) {
+            Level level;
+            level.min.resize(level_capacity);
+            level.max.resize(level_capacity);
+            levels_.push_back(std::move(level));
+        }
+        count_ = 0;
+        block_min_ = FLT_MAX;
+        block_max_ = -FLT_MAX;
+        visible_count_ = capacity_;
+        range_min_ = 0.0f;
+        range_max_ = 0.0f;
+    }
+
+    void Begin() {
+        Widget::Begin();
+        const ImVec2 size = ImGui::CalcItemSize(size_, ImGui::CalcItemWidth(), 80.0f);
+        const ImVec2 pos = ImGui::GetCursorScreenPos();
+        ImGui::Dummy(size);
+        if (!ImGui::IsItemVisible()) {
+            return;
+        }
+        ImDrawList* draw_list = ImGui::GetWindowDrawList();
+        const ImVec2 max(pos.x + size.x, pos.y + size.y);
+        draw_list->AddRectFilled(pos, max, ImGui::GetColorU32(ImGuiCol_FrameBg), ImGui::GetStyle().FrameRounding);
+        BuildColumns((int)size.x);
+        if (columns_.empty()) {
+            return;
+        }
+
+        float lo = range_min_;
+        float hi = range_max_;
+        if (lo == hi) {
+            lo = FLT_MAX;
+            hi = -FLT_MAX;
+            for (auto& column : columns_) {
+                lo = column.x < lo ? column.x : lo;
+                hi = column.y > hi ? column.y : hi;
+            }
+        }
+        const float scale = hi > lo ? (size.y - 2.0f) / (hi - lo) : 0.0f;
+        auto to_y = [&](float value) { return max.y - 1.0f - (value - lo) * scale; };
+
+        // Zig-zag through each column's min and max so neighbours stay connected
+        points_.clear();
+        const float step = columns_.size() > 1 ? (size.x - 1.0f) / (float)(columns_.size() - 1) : 0.0f;
+        for (size_t i = 0; i < columns_.size(); i++) {
+            const float x = pos.x + 0.5f + step * (float)i;
+            const float first = (i & 1) ? columns_[i].y : columns_[i].x;
+            const float second = (i & 1) ? columns_[i].x : columns_[i].y;
+            points_.push_back(ImVec2(x, to_y(first)));
+            if (second != first) {
+                points_.push_back(ImVec2(x, to_y(second)));
+            }
+        }
+        draw_list->PushClipRect(pos, max, true);
+        draw_list->AddPolyline(points_.data(), (int)points_.size(), ImGui::GetColorU32(ImGuiCol_PlotLines), 0, 1.0f);
+        draw_list->PopClipRect();
+    }
+
+    void End() {
+        Widget::End();
+    }
+
+    /*
+    * Control
+    */
+    void Push(float value) {
+        Push(&value, 1);
+    }
+
+    void Push(const float* values, size_t count) {
+        while (count > 0) {
+            const size_t offset = (size_t)(count_ & (kBlockSize - 1));
+            const size_t take = (std::min)(count, kBlockSize - offset);
+            if (offset == 0) {
+                block_min_ = FLT_MAX;
+                block_max_ = -FLT_MAX;
+            }
+            internal::MinMax(values, take, block_min_, block_max_);
+
+            const size_t pos = (size_t)(count_ & (capacity_ - 1));
+            const size_t first = (std::min)(take, capacity_ - pos);
+            memcpy(&samples_[pos], values, first * sizeof(float));
+            memcpy(&samples_[0], values + first, (take - first) * sizeof(float));
+
+            count_ += take;
+            values += take;
+            count -= take;
+            if ((count_ & (kBlockSize - 1)) == 0) {
+                EmitBlock(0, block_min_, block_max_);
+            }
+        }
+    }
+
+    void Clear() {
+        count_ = 0;
+        block_min_ = FLT_MAX;
+        block_max_ = -FLT_MAX;
+        for (auto& level : levels_) {
+            level.count = 0;
+            level.block_min = FLT_MAX;
+            level.block_max = -FLT_MAX;
+        }
+    }
+
+    // Samples pushed so far, the newest GetCapacity() of them are kept
+    uint64_t GetCount() {
+        return count_;
+    }
+
+    size_t GetCapacity() {
+        return capacity_;
+    }
+
+    // Show only the newest count samples
+    void SetVisibleCount(size_t count) {
+        visible_count_ = (std::min)(count, capacity_);
+    }
+
+    // min == max scales to the visible samples
+    void SetRange(float min, float max) {
+        range_min_ = min;
+        range_max_ = max;
+    }
+
+    void SetSize(const ImVec2& size) {
+        size_ = size;
+    }
+
+    ImVec2& GetSize() {
+        return size_;
+    }
+
+private:
+    static const int kBlockShift = 4;
+    static const size_t kBlockSize = (size_t)1 << kBlockShift;
+
+    struct Level {
+        std::vector<float> min;
+        std::vector<float> max;
+        uint64_t count = 0;             // blocks emitted so far
+        float block_min = FLT_MAX;      // partial block of the level above
+        float block_max = -FLT_MAX;
+    };
+
+    void EmitBlock(size_t index, float min, float max) {
+        Level& level = levels_[index];
+        const size_t pos = (size_t)(level.count & (level.min.size() - 1));
+        level.min[pos] = min;
+        level.max[pos] = max;
+        level.count++;
+        if (index + 1 >= levels_.size()) {
+            return;
+        }
+        level.block_min = min < level.block_min ? min : level.block_min;
+        level.block_max = max > level.block_max ? max : level.block_max;
+        if ((level.count & (kBlockSize - 1)) == 0) {
+            EmitBlock(index + 1, level.block_min, level.block_max);
+            level.block_min = FLT_MAX;
+            level.block_max = -FLT_MAX;
+        }
+    }
+
+    // Min/max of ring entries [first, last) given as absolute positions
+    static void RingMinMax(const float* data, size_t size, uint64_t first, uint64_t last, float& io_min, float& io_max) {
+        if (first >= last) {
+            return;
+        }
+        const size_t begin = (size_t)(first & (size - 1));
+        const size_t count = (size_t)(last - first);
+        const size_t head = (std::min)(count, size - begin);
+        internal::MinMax(data + begin, head, io_min, io_max);
+        internal::MinMax(data, count - head, io_min, io_max);
+    }
+
+    void RangeMinMax(uint64_t first, uint64_t last, float& io_min, float& io_max) {
+        // Deepest level whose blocks still fit into the range at least twice
+        size_t index = levels_.size();
+        while (index > 0 && (last - first) < ((uint64_t)2 << (kBlockShift * index))) {
+            index--;
+        }
+        if (index == 0) {
+            RingMinMax(samples_.data(), capacity_, first, last, io_min, io_max);
+            return;
+        }
+        const int shift = kBlockShift * (int)index;
+        const Level& level = levels_[index - 1];
+        uint64_t block_first = (first + ((uint64_t)1 << shift) - 1) >> shift;
+        uint64_t block_last = (std::min)(last >> shift, level.count);
+        if (block_first >= block_last) {
+            RingMinMax(samples_.data(), capacity_, first, last, io_min, io_max);
+            return;
+        }
+        RingMinMax(level.min.data(), level.min.size(), block_first, block_last, io_min, io_max);
+        float ignore = FLT_MAX;
+        RingMinMax(level.max.data(), level.max.size(), block_first, block_last, ignore, io_max);
+        // Edges not covered by whole blocks
+        RangeMinMax(first, block_first << shift, io_min, io_max);
+        RangeMinMax(block_last << shift, last, io_min, io_max);
+    }
+
+    void BuildColumns(int width) {
+        columns_.clear();
+        const uint64_t retained = (std::min)((uint64_t)capacity_, count_);
+        const uint64_t visible = (std::min)((uint64_t)visible_count_, retained);
+        if (visible == 0 || width <= 0) {
+            return;
+        }
+        const uint64_t first = count_ - visible;
+        if (visible <= (uint64_t)width * 2) {
+            for (uint64_t i = first; i < count_; i++) {
+                const float value = samples_[(size_t)(i & (capacity_ - 1))];
+                columns_.push_back(ImVec2(value, value));
+            }
+            return;
+        }
+        for (int x = 0; x < width; x++) {
+            const uint64_t begin = first + visible * x / width;
+            const uint64_t end = first + visible * (x + 1) / width;
+            float lo = FLT_MAX;
+            float hi = -FLT_MAX;
+            RangeMinMax(begin, end, lo, hi);
+            columns_.push_back(ImVec2(lo, hi));
+        }
+    }
+
+private:
+    std::vector<float> samples_;
+    size_t capacity_;
+    uint64_t count_;
+    float block_min_;
+    float block_max_;
+    std::vector<Level> levels_;
+
+    std::vector<ImVec2> columns_;   // x = min, y = max
+    std::vector<ImVec2> points_;
+
+    size_t visible_count_;
+    float range_min_;
+    float range_max_;
+    ImVec2 size_;
+};
+
+class RadioButtonGroup : public Widget {
+public:
+    RadioButtonGroup(std::vector<std::string> label_list) : Widget(""), label_list_(label_list){
+        push_index_ = 0;
+        select_index_ = 0;
+        end_select_index_ = 0;
+    }
+
+    template<class Fn>
+    void Begin(Fn&& push) {
+        Widget::Begin();
+        push_index_ = 0;
+        for (size_t i = 0; i < label_list_.size(); i++) {
+            ImGui::RadioButton(label_list_[i].c_str(), &select_index_, push_index_++);
+            push(i);
+        }
+    }
+
+    void Begin() {
+        Begin([](size_t i) {});
+    }
+
+    void End() {
+        end_select_index_ = select_index_;
+        Widget::End();
+    }
+
+
+    template<class Fn>
+    void SelectEvent(Fn&& event) {
+        if (end_select_index_ != select_index_) {
+            IMGUI_EX_PROFILE_SCOPE(GetLabel(), "SelectEvent");
+            event();
+        }
+    }
+
+    int GetSelectIndex() {
+        return select_index_;
+    }
+
+    void SetSelectIndex(int select_index) {
+        select_index_ = select_index;
+    }
+
+private:
+    std::vector<std::string> label_list_;
+
+    int push_index_;
+    int end_select_index_;
+    int select_index_;
+};
+
+
+namespace layout {
+    static void Indent() {
+        ImGui::Indent();
+    }
+
+    static void Unindent() {
+        ImGui::Unindent();
+    }
+
+    static void Spacing() {
+        ImGui::Spacing();
+    }
+
+    static void SameLine() {
+        ImGui::SameLine();
+    }
+
+    // Layout calls as Panel elements
+    struct Op {};
+
+    struct SameLineOp : Op {
+        void Run() {
+            ImGui::SameLine();
+        }
+    };
+
+    struct IndentOp : Op {
+        void Run() {
+            ImGui::Indent();
+        }
+    };
+
+    struct UnindentOp : Op {
+        void Run() {
+            ImGui::Unindent();
+        }
+    };
+
+    struct SpacingOp : Op {
+        void Run() {
+            ImGui::Spacing();
+        }
+    };
+}
+
+
+/*
+* Panel
+* A fixed dialog as one type, its widgets stored in a single tuple and the Begin/End sequence unrolled at compile time.
+*
+*   Panel<Window, Text, Button, layout::SameLineOp, CheckBox, Panel<CollapsingHeader, InputText>> panel(
+*       Window("Tools"), Text("Status"), Button("Run"), {}, CheckBox("Verbose"), { CollapsingHeader("Advanced"), InputText("Path", 260) });
+*
+*   panel.Run([&](auto& widget, auto index) {
+*       if constexpr (decltype(index)::value == 2) {
+*           widget.ClickEvent([&]() { ... });
+*       }
+*   });
+*
+* When the first element is a Window, CollapsingHeader or TreeNode the others are its children and skipped while it is
+* closed. The handler is called between each widget's Begin and End with the widget's index in its own panel,
+* nested panels pass it on with their own indices.
+*/
+template<class... Ts>
+class Panel {
+public:
+    Panel(Ts... elements) : elements_(std::move(elements)...) {
+
+    }
+
+    template<size_t I>
+    auto& Get() {
+        return std::get<I>(elements_);
+    }
+
+    void Run() {
+        Run([](auto& widget, auto index) {});
+    }
+
+    template<class Fn>
+    void Run(Fn&& handler) {
+        RunElement<0>(handler);
+    }
+
+private:
+    template<class T>
+    struct IsPanel : std::false_type {};
+
+    template<class... Us>
+    struct IsPanel<Panel<Us...>> : std::true_type {};
+
+    template<size_t I, class Fn>
+    void RunElement(Fn& handler) {
+        if constexpr (I < sizeof...(Ts)) {
+            using T = std::tuple_element_t<I, std::tuple<Ts...>>;
+            T& element = std::get<I>(elements_);
+            if constexpr (std::is_base_of_v<layout::Op, T>) {
+                element.Run();
+                RunElement<I + 1>(handler);
+            }
+            else if constexpr (IsPanel<T>::value) {
+                element.Run(handler);
+                RunElement<I + 1>(handler);
+            }
+            else if constexpr (I == 0 && std::is_base_of_v<Expandable, T>) {
+                element.Begin();
+                handler(element, std::integral_constant<size_t, I>());
+                bool open = element.GetExpand();
+                if constexpr (std::is_base_of_v<Window, T>) {
+                    open = open && element.GetCreate();
+                }
+                if (open) {
+                    RunElement<I + 1>(handler);
+                }
+                element.End();
+            }
+            else {
+                element.Begin();
+                handler(element, std::integral_constant<size_t, I>());
+                element.End();
+                RunElement<I + 1>(handler);
+            }
+        }
+    }
+
+private:
+    std::tuple<Ts...> elements_;
+};
+
+
+/*
+* LayoutProgram
+* A panel described in a text file, compiled into a flat op array that Run() walks every frame.
+*
+*   # comment
+*   window "Tools" docking=0 move=1
+*       text "Status"
+*       button "Run"
+*       sameline
+*       checkbox "Verbose" check=1
+*       header "Advanced"
+*           input "Path" 260
+*           help "(?)" "Where the output goes"
+*       end
+*   end
+*
+* Containers are window, header and tree, each closed by end. Leaves are button, text, bullet, separator,
+* checkbox, input and help; sameline, indent, unindent and spacing are layout calls.
+* Options given in the file are applied on every successful load: flags, docking, move, collapse, autoresize, top,
+* disabled. main, check and the input size are only read when the widget is constructed.
+*
+* Widgets are addressed by their label path ("Tools/Advanced/Path"). A reload keeps every widget whose
+* path and type did not change, together with its state and its Bind() handler.
+*/
+struct LayoutStats {
+    size_t ops;
+    size_t widgets;
+    size_t reused;          // Widgets kept by the last load
+    size_t created;         // Widgets constructed by the last load
+    uint64_t loads;
+};
+
+enum LayoutOpCode : uint8_t {
+    LayoutOp_Window,
+    LayoutOp_WindowEnd,
+    LayoutOp_Header,
+    LayoutOp_HeaderEnd,
+    LayoutOp_Tree,
+    LayoutOp_TreeEnd,
+    LayoutOp_Button,
+    LayoutOp_Text,
+    LayoutOp_BulletText,
+    LayoutOp_SeparatorText,
+    LayoutOp_CheckBox,
+    LayoutOp_InputText,
+    LayoutOp_HelpMarker,
+    LayoutOp_SameLine,
+    LayoutOp_Indent,
+    LayoutOp_Unindent,
+    LayoutOp_Spacing,
+};
+
+class LayoutProgram {
+public:
+    LayoutProgram() {
+        hot_reload_ = false;
+        reload_interval_ = 0.5;
+        stats_ = {};
+    }
+
+    // Runs the handler between the widget's Begin and End every frame, the place of the hand-written event calls
+    template<class T, class Fn>
+    void Bind(const std::string& path, Fn&& handler) {
+        const ImGuiID id = PathId(path);
+        Binding& binding = bindings_[id];
+        binding.type = TypeTag<T>();
+        binding.handler = [handler = std::forward<Fn>(handler)](void* widget) mutable { handler(*(T*)widget); };
+        for (auto& op : ops_) {
+            if (op.id == id && op.widget != nullptr) {
+                auto slot = slots_.find(id);
+                op.binding = slot != slots_.end() && slot->second.type == binding.type ? &binding : nullptr;
+            }
+        }
+    }
+
+    template<class T>
+    T* Find(const std::string& path) {
+        auto slot = slots_.find(PathId(path));
+        if (slot == slots_.end() || slot->second.type != TypeTag<T>()) {
+            return nullptr;
+        }
+        return (T*)slot->second.widget.get();
+    }
+
+    // On failure the previous program keeps running, untouched, and GetError() tells the line
+    bool Load(const std::string& source) {
+        std::vector<LayoutOp> ops;
+        std::unordered_map<ImGuiID, Slot> slots;
+        std::vector<Options> options;
+        size_t reused = 0;
+        if (!Compile(source, ops, slots, options, reused)) {
+            return false;
+        }
+        // Kept widgets belong to the running program, they only change once the new one replaces it
+        for (const Options& widget_options : options) {
+            ApplyOptions(widget_options);
+        }
+        ops_ = std::move(ops);
+        slots_ = std::move(slots);
+        error_.clear();
+        stats_.ops = ops_.size();
+        stats_.widgets = slots_.size();
+        stats_.reused = reused;
+        stats_.created = slots_.size() - reused;
+        stats_.loads++;
+        return true;
+    }
+
+    bool LoadFile(const std::string& path) {
+        path_ = path;
+        std::error_code ec;
+        write_time_ = std::filesystem::last_write_time(path_, ec);
+        last_check_ = std::chrono::steady_clock::now();
+        std::string source;
+        if (!ReadFile(path_, source)) {
+            error_ = "cannot read " + path_;
+            return false;
+        }
+        return Load(source);
+    }
+
+    // Run() reloads the file when its write time changes, checked at most once per interval
+    void SetHotReload(bool enable, double interval_seconds = 0.5) {
+        hot_reload_ = enable;
+        reload_interval_ = interval_seconds;
+    }
+
+    void Run() {
+        if (hot_reload_ && !path_.empty()) {
+            CheckReload();
+        }
+        const LayoutOp* ops = ops_.data();
+        const size_t count = ops_.size();
+        size_t pc = 0;
+        while (pc < count) {
+            const LayoutOp& op = ops[pc];
+            switch (op.code) {
+            case LayoutOp_Window: {
+                Window* window = (Window*)op.widget;
+                window->Begin();
+                Handle(op);
+                if (!window->GetCreate() || !window->GetExpand()) {
+                    pc = op.jump;
+                    continue;
+                }
+                break;
+            }
+            case LayoutOp_WindowEnd:
+                ((Window*)op.widget)->End();
+                break;
+            case LayoutOp_Header: {
+                CollapsingHeader* header = (CollapsingHeader*)op.widget;
+                header->Begin();
+                Handle(op);
+                if (!header->GetExpand()) {
+                    pc = op.jump;
+                    continue;
+                }
+                break;
+            }
+            case LayoutOp_HeaderEnd:
+                ((CollapsingHeader*)op.widget)->End();
+                break;
+            case LayoutOp_Tree: {
+                TreeNode* tree = (TreeNode*)op.widget;
+                tree->Begin();
+                Handle(op);
+                if (!tree->GetExpand()) {
+                    pc = op.jump;
+                    continue;
+                }
+                break;
+            }
+            case LayoutOp_TreeEnd:
+                ((TreeNode*)op.widget)->End();
+                break;
+            case LayoutOp_Button:
+                RunLeaf<Button>(op);
+                break;
+            case LayoutOp_Text:
+                RunLeaf<Text>(op);
+                break;
+            case LayoutOp_BulletText:
+                RunLeaf<BulletText>(op);
+                break;
+            case LayoutOp_SeparatorText:
+                RunLeaf<SeparatorText>(op);
+                break;
+            case LayoutOp_CheckBox:
+                RunLeaf<CheckBox>(op);
+                break;
+            case LayoutOp_InputText:
+                RunLeaf<InputText>(op);
+                break;
+            case LayoutOp_HelpMarker:
+                RunLeaf<HelpMarker>(op);
+                break;
+            case LayoutOp_SameLine:
+                ImGui::SameLine();
+                break;
+            case LayoutOp_Indent:
+                ImGui::Indent();
+                break;
+            case LayoutOp_Unindent:
+                ImGui::Unindent();
+                break;
+            case LayoutOp_Spacing:
+                ImGui::Spacing();
+                break;
+            }
+            pc++;
+        }
+    }
+
+    const std::string& GetError() {
+        return error_;
+    }
+
+    LayoutStats GetStats() {
+        return stats_;
+    }
+
+private:
+    struct Binding {
+        const void* type;
+        std::function<void(void*)> handler;
+    };
+
+    struct Slot {
+        const void* type;
+        std::shared_ptr<void> widget;
+    };
+
+    struct LayoutOp {
+        LayoutOpCode code;
+        uint32_t jump;          // Containers: index of the matching end op
+        ImGuiID id;
+        void* widget;
+        Binding* binding;
+    };
+
+    struct Token {
+        std::string text;
+        bool quoted;
+    };
+
+    struct Scope {
+        LayoutOpCode end;
+        size_t begin;
+        ImGuiID id;
+        int line;
+    };
+
+    struct Options {
+        Widget* widget;
+        Window* window;         // Same widget when it is a window
+        std::unordered_map<std::string, int> values;
+    };
+
+    template<class T>
+    static const void* TypeTag() {
+        static const char tag = 0;
+        return &tag;
+    }
+
+    static ImGuiID PathId(const std::string& path) {
+        ImGuiID id = 0;
+        size_t begin = 0;
+        while (begin <= path.size()) {
+            size_t end = path.find('/', begin);
+            if (end == std::string::npos) {
+                end = path.size();
+            }
+            id = ImHashStr(path.c_str() + begin, end - begin, id);
+            begin = end + 1;
+        }
+        return id;
+    }
+
+    static bool ReadFile(const std::string& path, std::string& text) {
+        FILE* file = fopen(path.c_str(), "rb");
+        if (file == nullptr) {
+            return false;
+        }
+        text.clear();
+        char buffer[4096];
+        size_t size;
+        while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+            text.append(buffer, size);
+        }
+        fclose(file);
+        return true;
+    }
+
+    static bool Tokenize(const std::string& line, std::vector<Token>& tokens) {
+        tokens.clear();
+        size_t i = 0;
+        while (i < line.size()) {
+            const char c = line[i];
+            if (c == ' ' || c == '\t' || c == '\r') {
+                i++;
+            }
+            else if (c == '#') {
+                break;
+            }
+            else if (c == '"') {
+                Token token = { "", true };
+                for (i++; i < line.size() && line[i] != '"'; i++) {
+                    if (line[i] == '\\' && i + 1 < line.size()) {
+                        i++;
+                    }
+                    token.text.push_back(line[i]);
+                }
+                if (i >= line.size()) {
+                    return false;
+                }
+                i++;
+                tokens.push_back(std::move(token));
+            }
+            else {
+                Token token = { "", false };
+                while (i < line.size() && line[i] != ' ' && line[i] != '\t' && line[i] != '\r' && line[i] != '#') {
+                    token.text.push_back(line[i++]);
+                }
+                tokens.push_back(std::move(token));
+            }
+        }
+        return true;
+    }
+
+    bool Compile(const std::string& source, std::vector<LayoutOp>& ops, std::unordered_map<ImGuiID, Slot>& slots, std::vector<Options>& widget_options, size_t& reused) {
+        std::vector<Scope> scopes;
+        std::vector<Token> tokens;
+        std::vector<std::string> args;
+        std::unordered_map<std::string, int> options;
+        int line_number = 0;
+        size_t line_begin = 0;
+        while (line_begin < source.size()) {
+            size_t line_end = source.find('\n', line_begin);
+            if (line_end == std::string::npos) {
+                line_end = source.size();
+            }
+            const std::string line = source.substr(line_begin, line_end - line_begin);
+            line_begin = line_end + 1;
+            line_number++;
+
+            if (!Tokenize(line, tokens)) {
+                return Fail(line_number, "unterminated string");
+            }
+            if (tokens.empty()) {
+                continue;
+            }
+            args.clear();
+            options.clear();
+            for (size_t i = 1; i < tokens.size(); i++) {
+                const size_t equal = tokens[i].quoted ? std::string::npos : tokens[i].text.find('=');
+                if (equal == std::string::npos) {
+                    args.push_back(tokens[i].text);
+                    continue;
+                }
+                char* end = nullptr;
+                const std::string value = tokens[i].text.substr(equal + 1);
+                const long number = strtol(value.c_str(), &end, 0);
+                if (value.empty() || *end != '\0') {
+                    return Fail(line_number, "option " + tokens[i].text + " is not a number");
+                }
+                options[tokens[i].text.substr(0, equal)] = (int)number;
+            }
+
+            const std::string& keyword = tokens[0].text;
+            if (keyword == "end") {
+                if (scopes.empty()) {
+                    return Fail(line_number, "end without a container");
+                }
+                const Scope scope = scopes.back();
+                scopes.pop_back();
+                ops[scope.begin].jump = (uint32_t)ops.size();
+                ops.push_back({ scope.end, 0, scope.id, ops[scope.begin].widget, nullptr });
+                continue;
+            }
+
+            LayoutOpCode code;
+            if (keyword == "sameline") {
+                code = LayoutOp_SameLine;
+            }
+            else if (keyword == "indent") {
+                code = LayoutOp_Indent;
+            }
+            else if (keyword == "unindent") {
+                code = LayoutOp_Unindent;
+            }
+            else if (keyword == "spacing") {
+                code = LayoutOp_Spacing;
+            }
+            else {
+                if (args.empty()) {
+                    return Fail(line_number, keyword + " needs a label");
+                }
+                const ImGuiID parent = scopes.empty() ? 0 : scopes.back().id;
+                ImGuiID id = ImHashStr(args[0].c_str(), args[0].size(), parent);
+                if (keyword == "help" && args.size() > 1) {
+                    // The description is only passed to the constructor
+                    id = ImHashStr(args[1].c_str(), args[1].size(), id);
+                }
+                while (slots.count(id)) {
+                    id = ImHashData(&id, sizeof(id), parent);
+                }
+
+                LayoutOp op = { LayoutOp_Spacing, 0, id, nullptr, nullptr };
+                Widget* widget = nullptr;
+                Window* window = nullptr;
+                if (keyword == "window") {
+                    window = Acquire<Window>(id, slots, reused, args[0], Option(options, "main", 0) != 0);
+                    op.code = LayoutOp_Window;
+                    op.widget = widget = window;
+                    scopes.push_back({ LayoutOp_WindowEnd, ops.size(), id, line_number });
+                }
+                else if (keyword == "header") {
+                    op.code = LayoutOp_Header;
+                    op.widget = widget = Acquire<CollapsingHeader>(id, slots, reused, args[0]);
+                    scopes.push_back({ LayoutOp_HeaderEnd, ops.size(), id, line_number });
+                }
+                else if (keyword == "tree") {
+                    op.code = LayoutOp_Tree;
+                    op.widget = widget = Acquire<TreeNode>(id, slots, reused, args[0]);
+                    scopes.push_back({ LayoutOp_TreeEnd, ops.size(), id, line_number });
+                }
+                else if (keyword == "button") {
+                    op.code = LayoutOp_Button;
+                    op.widget = widget = Acquire<Button>(id, slots, reused, args[0]);
+                }
+                else if (keyword == "text") {
+                    op.code = LayoutOp_Text;
+                    op.widget = widget = Acquire<Text>(id, slots, reused, args[0].c_str());
+                }
+                else if (keyword == "bullet") {
+                    op.code = LayoutOp_BulletText;
+                    op.widget = widget = Acquire<BulletText>(id, slots, reused, args[0].c_str());
+                }
+                else if (keyword == "separator") {
+                    op.code = LayoutOp_SeparatorText;
+                    op.widget = widget = Acquire<SeparatorText>(id, slots, reused, args[0]);
+                }
+                else if (keyword == "checkbox") {
+                    op.code = LayoutOp_CheckBox;
+                    op.widget = widget = Acquire<CheckBox>(id, slots, reused, args[0], Option(options, "check", 0) != 0);
+                }
+                else if (keyword == "input") {
+                    const long size = args.size() > 1 ? strtol(args[1].c_str(), nullptr, 0) : 256;
+                    if (size <= 0) {
+                        return Fail(line_number, "input size must be positive");
+                    }
+                    op.code = LayoutOp_InputText;
+                    op.widget = widget = Acquire<InputText>(id, slots, reused, args[0], (size_t)size);
+                }
+                else if (keyword == "help") {
+                    op.code = LayoutOp_HelpMarker;
+                    op.widget = widget = Acquire<HelpMarker>(id, slots, reused, args[0], args.size() > 1 ? args[1] : std::string());
+                }
+                else {
+                    return Fail(line_number, "unknown statement " + keyword);
+                }
+                if (!options.empty()) {
+                    widget_options.push_back({ widget, window, options });
+                }
+                auto binding = bindings_.find(id);
+                if (binding != bindings_.end() && binding->second.type == slots[id].type) {
+                    op.binding = &binding->second;
+                }
+                ops.push_back(op);
+                continue;
+            }
+            ops.push_back({ code, 0, 0, nullptr, nullptr });
+        }
+        if (!scopes.empty()) {
+            return Fail(scopes.back().line, "missing end");
+        }
+        return true;
+    }
+
+    // Keeps the widget of the running program when path and type match
+    template<class T, class... Args>
+    T* Acquire(ImGuiID id, std::unordered_map<ImGuiID, Slot>& slots, size_t& reused, Args&&... args) {
+        Slot& slot = slots[id];
+        auto old = slots_.find(id);
+        if (old != slots_.end() && old->second.type == TypeTag<T>()) {
+            slot = old->second;
+            reused++;
+        }
+        else {
+            slot.type = TypeTag<T>();
+            slot.widget = std::make_shared<T>(std::forward<Args>(args)...);
+        }
+        return (T*)slot.widget.get();
+    }
+
+    static int Option(const std::unordered_map<std::string, int>& options, const char* name, int default_value) {
+        auto option = options.find(name);
+        return option != options.end() ? option->second : default_value;
+    }
+
+    static void ApplyOptions(const Options& options) {
+        const auto& values = options.values;
+        if (Window* window = options.window) {
+            if (values.count("flags")) {
+                window->SetFlags(values.at("flags"));
+            }
+            if (values.count("docking")) {
+                window->SetDocking(values.at("docking") != 0);
+            }
+            if (values.count("move")) {
+                window->SetMove(values.at("move") != 0);
+            }
+            if (values.count("collapse")) {
+                window->SetCollapse(values.at("collapse") != 0);
+            }
+            if (values.count("autoresize")) {
+                window->SetAlwaysAutoResize(values.at("autoresize") != 0);
+            }
+            if (values.count("top")) {
+                window->SetTop(values.at("top") != 0);
+            }
+        }
+        if (values.count("disabled")) {
+            options.widget->SetDisable(values.at("disabled") != 0);
+        }
+    }
+
+    bool Fail(int line, const std::string& message) {
+        error_ = "line " + std::to_string(line) + ": " + message;
+        return false;
+    }
+
+    void CheckReload() {
+        const auto now = std::chrono::steady_clock::now();
+        if (std::chrono::duration<double>(now - last_check_).count() < reload_interval_) {
+            return;
+        }
+        last_check_ = now;
+        std::error_code ec;
+        const auto write_time = std::filesystem::last_write_time(path_, ec);
+        if (ec || write_time == write_time_) {
+            return;
+        }
+        write_time_ = write_time;
+        std::string source;
+        if (ReadFile(path_, source)) {
+            Load(source);
+        }
+    }
+
+    static void Handle(const LayoutOp& op) {
+        if (op.binding != nullptr) {
+            op.binding->handler(op.widget);
+        }
+    }
+
+    template<class T>
+    static void RunLeaf(const LayoutOp& op) {
+        T* widget = (T*)op.widget;
+        widget->Begin();
+        Handle(op);
+        widget->End();
+    }
+
+private:
+    std::vector<LayoutOp> ops_;
+    std::unordered_map<ImGuiID, Slot> slots_;
+    std::unordered_map<ImGuiID, Binding> bindings_;
+
+    std::string path_;
+    std::filesystem::file_time_type write_time_;
+    bool hot_reload_;
+    double reload_interval_;
+    std::chrono::steady_clock::time_point last_check_;
+
+    std::string error_;
+    LayoutStats stats_;
+};
+
+
+/*
+* State snapshot
+* Registered widgets write their user facing state (open windows, checks, texts, selections, expand states) into one
+* binary blob that is restored in a single pass before the first frame. Restored values fire their events on the
+* first frame like a user change would, so the application rebuilds its own state through the usual event handlers.
+*
+* Layout, little endian, every offset relative to the start of the blob:
+*   StateFileHeader
+*   StateFileEntry[count]       sorted by id
+*   payloads                    4 byte aligned
+* Nothing in the blob is a pointer, it can be restored straight from a mapped file.
+*
+* A delta holds the widgets whose state changed since the previous delta:
+*   StateDeltaHeader
+*   { ImGuiID id, uint16_t type, uint32_t size, payload }[count]   packed
+*/
+struct StateStats {
+    size_t widgets;
+    size_t bytes;                   // Size of the last snapshot
+    size_t restored;                // Widgets found in the last restore
+    size_t skipped;                 // Entries without a matching widget or with another type
+    double save_ms;                 // Serialization on the UI thread
+    double write_ms;                // File write on the worker pool
+    double restore_ms;
+    int saves_pending;
+    size_t delta_bytes;             // Size of the last delta, 0 when nothing changed
+    size_t delta_changes;
+    double delta_ms;
+    double apply_ms;
+};
+
+namespace internal {
+static const uint32_t kStateMagic = 0x53584749; // "IGXS"
+static const uint16_t kStateVersion = 1;
+
+struct StateFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t entry_size;
+    uint32_t count;
+    uint32_t size;
+};
+
+struct StateFileEntry {
+    ImGuiID id;
+    uint16_t type;
+    uint16_t reserved;
+    uint32_t offset;
+    uint32_t size;
+};
+
+static const uint32_t kStateDeltaMagic = 0x44584749; // "IGXD"
+static const size_t kStateDeltaRecordSize = sizeof(ImGuiID) + sizeof(uint16_t) + sizeof(uint32_t);
+
+struct StateDeltaHeader {
+    uint32_t magic;
+    uint32_t frame;
+    uint32_t count;
+    uint32_t size;
+};
+
+enum StateType : uint16_t {
+    StateType_Window = 1,
+    StateType_CheckBox,
+    StateType_InputText,
+    StateType_InputTextMultiline,
+    StateType_Expand,
+    StateType_Select,
+};
+
+class StateWriter {
+public:
+    explicit StateWriter(std::vector<uint8_t>& data) : data_(data) {
+
+    }
+
+    template<class T>
+    void Write(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "StateWriter only writes plain values");
+        const uint8_t* bytes = (const uint8_t*)&value;
+        data_.insert(data_.end(), bytes, bytes + sizeof(T));
+    }
+
+    void WriteString(std::string_view text) {
+        Write((uint32_t)text.size());
+        data_.insert(data_.end(), text.begin(), text.end());
+    }
+
+private:
+    std::vector<uint8_t>& data_;
+};
+
+// Reads fail instead of running past the payload of a truncated or foreign entry
+class StateReader {
+public:
+    StateReader(const uint8_t* data, size_t size) {
+        data_ = data;
+        size_ = size;
+        offset_ = 0;
+    }
+
+    template<class T>
+    bool Read(T& value) {
+        if (size_ - offset_ < sizeof(T)) {
+            return false;
+        }
+        memcpy(&value, data_ + offset_, sizeof(T));
+        offset_ += sizeof(T);
+        return true;
+    }
+
+    bool ReadString(std::string& text) {
+        uint32_t size;
+        if (!Read(size) || size_ - offset_ < size) {
+            return false;
+        }
+        text.assign((const char*)data_ + offset_, size);
+        offset_ += size;
+        return true;
+    }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t offset_;
+};
+
+template<class T>
+struct WidgetState;
+
+template<>
+struct WidgetState<Window> {
+    static const uint16_t type = StateType_Window;
+    static void Save(StateWriter& out, Window& window) {
+        out.Write((uint8_t)window.GetCreate());
+        out.Write((uint8_t)window.GetTop());
+    }
+    static bool Load(StateReader& in, Window& window) {
+        uint8_t create, top;
+        if (!in.Read(create) || !in.Read(top)) {
+            return false;
+        }
+        if (create) {
+            window.Create();
+        }
+        else {
+            window.Close();
+        }
+        window.SetTop(top != 0);
+        return true;
+    }
+};
+
+template<>
+struct WidgetState<CheckBox> {
+    static const uint16_t type = StateType_CheckBox;
+    static void Save(StateWriter& out, CheckBox& check_box) {
+        out.Write((uint8_t)check_box.GetCheck());
+    }
+    static bool Load(StateReader& in, CheckBox& check_box) {
+        uint8_t check;
+        if (!in.Read(check)) {
+            return false;
+        }
+        check_box.SetCheck(check != 0);
+        return true;
+    }
+};
+
+template<>
+struct WidgetState<InputText> {
+    static const uint16_t type = StateType_InputText;
+    static void Save(StateWriter& out, InputText& input) {
+        out.WriteString(input.GetText());
+    }
+    static bool Load(StateReader& in, InputText& input) {
+        std::string text;
+        if (!in.ReadString(text)) {
+            return false;
+        }
+        input.SetText(text);
+        return true;
+    }
+};
+
+template<>
+struct WidgetState<InputTextMultiline> {
+    static const uint16_t type = StateType_InputTextMultiline;
+    static void Save(StateWriter& out, InputTextMultiline& input) {
+        out.WriteString(input.GetText());
+    }
+    static bool Load(StateReader& in, InputTextMultiline& input) {
+        std::string text;
+        if (!in.ReadString(text)) {
+            return false;
+        }
+        input.SetText(text);
+        return true;
+    }
+};
+
+struct ExpandState {
+    static const uint16_t type = StateType_Expand;
+    template<class T>
+    static void Save(StateWriter& out, T& widget) {
+        out.Write((uint8_t)widget.GetExpand());
+    }
+    template<class T>
+    static bool Load(StateReader& in, T& widget) {
+        uint8_t expand;
+        if (!in.Read(expand)) {
+            return false;
+        }
+        widget.SetExpand(expand != 0);
+        return true;
+    }
+};
+
+template<>
+struct WidgetState<CollapsingHeader> : ExpandState {};
+
+template<>
+struct WidgetState<TreeNode> : ExpandState {};
+
+// Any widget with GetSelectIndex/SetSelectIndex, the index is only meaningful if the list is rebuilt in the same order
+struct SelectState {
+    static const uint16_t type = StateType_Select;
+    template<class T>
+    static void Save(StateWriter& out, T& widget) {
+        out.Write((int32_t)widget.GetSelectIndex());
+    }
+    template<class T>
+    static bool Load(StateReader& in, T& widget) {
+        int32_t select_index;
+        if (!in.Read(select_index)) {
+            return false;
+        }
+        widget.SetSelectIndex(select_index);
+        return true;
+    }
+};
+
+template<class Element, class Key>
+struct WidgetState<Combo<Element, Key>> : SelectState {};
+
+template<class Element, class Key>
+struct WidgetState<ListBox<Element, Key>> : SelectState {};
+
+template<class Row>
+struct WidgetState<Table<Row>> : SelectState {};
+
+template<class Node>
+struct WidgetState<Tree<Node>> : SelectState {};
+
+template<>
+struct WidgetState<RadioButtonGroup> : SelectState {};
+} // namespace internal
+
+class StateRegistry {
+public:
+    StateRegistry() : async_(std::make_shared<Async>()) {
+        sorted_ = true;
+        delta_valid_ = false;
+        delta_frame_ = 0;
+        stats_ = {};
+    }
+
+    // Widgets keyed by their label, the same hash ImGui uses for an ID. The label has to be unique among the
+    // registered widgets, a label that repeats in several windows needs the owner or a key.
+    template<class T>
+    void Register(T& widget) {
+        Register(ImHashStr(widget.GetLabel().c_str()), widget);
+    }
+
+    // Keyed by the label inside the owner, the way ImGui seeds an item's ID with its window's
+    template<class T>
+    void Register(Widget& owner, T& widget) {
+        Register(ImHashStr(widget.GetLabel().c_str(), 0, ImHashStr(owner.GetLabel().c_str())), widget);
+    }
+
+    template<class T>
+    void Register(const std::string& key, T& widget) {
+        Register(ImHashStr(key.c_str()), widget);
+    }
+
+    // An id belongs to one widget. Registering the same widget again replaces its entry, another widget
+    // under a registered id asserts, Unregister the old one first.
+    template<class T>
+    void Register(ImGuiID id, T& widget) {
+        Entry entry;
+        entry.id = id;
+        entry.type = internal::WidgetState<T>::type;
+        entry.widget = &widget;
+        entry.save = [](internal::StateWriter& out, void* widget) { internal::WidgetState<T>::Save(out, *(T*)widget); };
+        entry.load = [](internal::StateReader& in, void* widget) { return internal::WidgetState<T>::Load(in, *(T*)widget); };
+        sorted_ = sorted_ && (entries_.empty() || entries_.back().id < id);
+        entries_.push_back(entry);
+        delta_valid_ = false;
+    }
+
+    void Unregister(ImGuiID id) {
+        entries_.erase(std::remove_if(entries_.begin(), entries_.end(), [id](const Entry& entry) { return entry.id == id; }), entries_.end());
+        delta_valid_ = false;
+    }
+
+    void Save(std::vector<uint8_t>& data) {
+        const auto start = std::chrono::steady_clock::now();
+        Sort();
+        const size_t table_size = sizeof(internal::StateFileHeader) + entries_.size() * sizeof(internal::StateFileEntry);
+        data.clear();
+        data.reserve((std::max)(stats_.bytes, table_size));
+        data.resize(table_size);
+        internal::StateWriter writer(data);
+        for (size_t i = 0; i < entries_.size(); i++) {
+            const size_t offset = data.size();
+            entries_[i].save(writer, entries_[i].widget);
+            internal::StateFileEntry file_entry = { entries_[i].id, entries_[i].type, 0, (uint32_t)offset, (uint32_t)(data.size() - offset) };
+            memcpy(&data[sizeof(internal::StateFileHeader) + i * sizeof(file_entry)], &file_entry, sizeof(file_entry));
+            data.resize((data.size() + 3) & ~(size_t)3);
+        }
+        internal::StateFileHeader header = { internal::kStateMagic, internal::kStateVersion, (uint16_t)sizeof(internal::StateFileEntry), (uint32_t)entries_.size(), (uint32_t)data.size() };
+        memcpy(&data[0], &header, sizeof(header));
+
+        stats_.widgets = entries_.size();
+        stats_.bytes = data.size();
+        stats_.save_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // One merge pass over the sorted entry table and the sorted registry
+    bool Restore(const void* data, size_t size) {
+        const auto start = std::chrono::steady_clock::now();
+        internal::StateFileHeader header;
+        if (size < sizeof(header)) {
+            return false;
+        }
+        memcpy(&header, data, sizeof(header));
+        if (header.magic != internal::kStateMagic || header.version > internal::kStateVersion || header.size > size ||
+            header.entry_size < sizeof(internal::StateFileEntry) || (size - sizeof(header)) / header.entry_size < header.count) {
+            return false;
+        }
+        Sort();
+        const uint8_t* bytes = (const uint8_t*)data;
+        size_t restored = 0;
+        size_t skipped = 0;
+        size_t index = 0;
+        for (uint32_t i = 0; i < header.count; i++) {
+            internal::StateFileEntry file_entry;
+            memcpy(&file_entry, bytes + sizeof(header) + (size_t)i * header.entry_size, sizeof(file_entry));
+            while (index < entries_.size() && entries_[index].id < file_entry.id) {
+                index++;
+            }
+            if (index == entries_.size() || entries_[index].id != file_entry.id || entries_[index].type != file_entry.type ||
+                file_entry.offset > header.size || header.size - file_entry.offset < file_entry.size) {
+                skipped++;
+                continue;
+            }
+            internal::StateReader reader(bytes + file_entry.offset, file_entry.size);
+            if (entries_[index].load(reader, entries_[index].widget)) {
+                restored++;
+            }
+            else {
+                skipped++;
+            }
+        }
+        stats_.restored = restored;
+        stats_.skipped = skipped;
+        stats_.restore_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return true;
+    }
+
+    // Widgets whose state changed since the last SaveDelta, compared by a hash of their serialized state.
+    // The first delta, and the first after Register, Unregister or ResetDelta, holds every widget.
+    // Returns false and leaves data empty when nothing changed.
+    bool SaveDelta(std::vector<uint8_t>& data) {
+        const auto start = std::chrono::steady_clock::now();
+        Sort();
+        if (!delta_valid_) {
+            delta_hashes_.assign(entries_.size(), 0);
+        }
+        data.clear();
+        data.resize(sizeof(internal::StateDeltaHeader));
+        uint32_t count = 0;
+        internal::StateWriter writer(delta_scratch_);
+        for (size_t i = 0; i < entries_.size(); i++) {
+            delta_scratch_.clear();
+            entries_[i].save(writer, entries_[i].widget);
+            uint64_t hash = 14695981039346656037ull;
+            for (uint8_t byte : delta_scratch_) {
+                hash = (hash ^ byte) * 1099511628211ull;
+            }
+            if (delta_valid_ && delta_hashes_[i] == hash) {
+                continue;
+            }
+            delta_hashes_[i] = hash;
+            const uint32_t size = (uint32_t)delta_scratch_.size();
+            const size_t offset = data.size();
+            data.resize(offset + internal::kStateDeltaRecordSize + size);
+            memcpy(&data[offset], &entries_[i].id, sizeof(ImGuiID));
+            memcpy(&data[offset + sizeof(ImGuiID)], &entries_[i].type, sizeof(uint16_t));
+            memcpy(&data[offset + sizeof(ImGuiID) + sizeof(uint16_t)], &size, sizeof(size));
+            memcpy(&data[offset + internal::kStateDeltaRecordSize], delta_scratch_.data(), size);
+            count++;
+        }
+        delta_valid_ = true;
+
+        stats_.delta_changes = count;
+        stats_.delta_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (count == 0) {
+            data.clear();
+            stats_.delta_bytes = 0;
+            return false;
+        }
+        internal::StateDeltaHeader header = { internal::kStateDeltaMagic, delta_frame_++, count, (uint32_t)data.size() };
+        memcpy(&data[0], &header, sizeof(header));
+        stats_.delta_bytes = data.size();
+        return true;
+    }
+
+    bool ApplyDelta(const void* data, size_t size) {
+        const auto start = std::chrono::steady_clock::now();
+        internal::StateDeltaHeader header;
+        if (size < sizeof(header)) {
+            return false;
+        }
+        memcpy(&header, data, sizeof(header));
+        if (header.magic != internal::kStateDeltaMagic || header.size > size) {
+            return false;
+        }
+        Sort();
+        const uint8_t* bytes = (const uint8_t*)data;
+        size_t offset = sizeof(header);
+        for (uint32_t i = 0; i < header.count; i++) {
+            if (header.size - offset < internal::kStateDeltaRecordSize) {
+                return false;
+            }
+            ImGuiID id;
+            uint16_t type;
+            uint32_t payload_size;
+            memcpy(&id, bytes + offset, sizeof(id));
+            memcpy(&type, bytes + offset + sizeof(id), sizeof(type));
+            memcpy(&payload_size, bytes + offset + sizeof(id) + sizeof(type), sizeof(payload_size));
+            offset += internal::kStateDeltaRecordSize;
+            if (header.size - offset < payload_size) {
+                return false;
+            }
+            auto entry = std::lower_bound(entries_.begin(), entries_.end(), id, [](const Entry& entry, ImGuiID id) { return entry.id < id; });
+            if (entry != entries_.end() && entry->id == id && entry->type == type) {
+                internal::StateReader reader(bytes + offset, payload_size);
+                entry->load(reader, entry->widget);
+            }
+            offset += payload_size;
+        }
+        stats_.apply_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return true;
+    }
+
+    void ResetDelta() {
+        delta_valid_ = false;
+    }
+
+    bool SaveFile(const std::string& path) {
+        std::vector<uint8_t> data;
+        Save(data);
+        return WriteFile(path, data, *async_);
+    }
+
+    // Serializes now, the file is written on the worker pool into a temporary and renamed over the old snapshot
+    void SaveFileAsync(const std::string& path) {
+        auto data = std::make_shared<std::vector<uint8_t>>();
+        Save(*data);
+        std::shared_ptr<Async> async = async_;
+        async->pending++;
+        GetWorkerPool().Submit([async, data, path]() {
+            std::lock_guard<std::mutex> lock(async->write_mutex);
+            WriteFile(path, *data, *async);
+            async->pending--;
+        });
+    }
+
+    bool RestoreFile(const std::string& path) {
+        FILE* file = fopen(path.c_str(), "rb");
+        if (file == nullptr) {
+            return false;
+        }
+        std::vector<uint8_t> data;
+        if (fseek(file, 0, SEEK_END) == 0) {
+            const long size = ftell(file);
+            if (size > 0) {
+                data.resize((size_t)size);
+                fseek(file, 0, SEEK_SET);
+                data.resize(fread(data.data(), 1, data.size(), file));
+            }
+        }
+        fclose(file);
+        return Restore(data.data(), data.size());
+    }
+
+    StateStats GetStats() {
+        StateStats stats = stats_;
+        stats.write_ms = async_->write_ms;
+        stats.saves_pending = async_->pending;
+        return stats;
+    }
+
+private:
+    struct Entry {
+        ImGuiID id;
+        uint16_t type;
+        void* widget;
+        void (*save)(internal::StateWriter& out, void* widget);
+        bool (*load)(internal::StateReader& in, void* widget);
+    };
+
+    // Outlives the registry while a write is still queued
+    struct Async {
+        std::mutex write_mutex;
+        std::atomic<int> pending{ 0 };
+        std::atomic<double> write_ms{ 0.0 };
+    };
+
+    void Sort() {
+        if (sorted_) {
+            return;
+        }
+        std::stable_sort(entries_.begin(), entries_.end(), [](const Entry& a, const Entry& b) { return a.id < b.id; });
+        size_t count = 0;
+        for (size_t i = 0; i < entries_.size(); i++) {
+            if (i + 1 < entries_.size() && entries_[i + 1].id == entries_[i].id) {
+                // Two labels that hash alike would otherwise share one snapshot entry
+                IM_ASSERT(entries_[i + 1].widget == entries_[i].widget && "Two widgets registered under one id, register them with an owner or a key");
+                continue;
+            }
+            entries_[count++] = entries_[i];
+        }
+        entries_.resize(count);
+        sorted_ = true;
+    }
+
+    static bool WriteFile(const std::string& path, const std::vector<uint8_t>& data, Async& async) {
+        const auto start = std::chrono::steady_clock::now();
+        const std::string temp_path = path + ".tmp";
+        FILE* file = fopen(temp_path.c_str(), "wb");
+        if (file == nullptr) {
+            return false;
+        }
+        const bool written = fwrite(data.data(), 1, data.size(), file) == data.size();
+        const bool closed = fclose(file) == 0;
+        std::error_code ec;
+        if (written && closed) {
+            std::filesystem::rename(temp_path, path, ec);
+        }
+        else {
+            std::filesystem::remove(temp_path, ec);
+        }
+        async.write_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return written && closed && !ec;
+    }
+
+private:
+    std::vector<Entry> entries_;
+    bool sorted_;
+    std::shared_ptr<Async> async_;
+
+    bool delta_valid_;
+    uint32_t delta_frame_;
+    std::vector<uint64_t> delta_hashes_;    // Parallel to entries_
+    std::vector<uint8_t> delta_scratch_;
+
+    StateStats stats_;
+};
+
+StateRegistry& GetStateRegistry();
+
+namespace internal {
+// Single producer, single consumer message ring placed in memory shared by two processes.
+// Offsets are free running counters, the capacity is a power of two.
+class StateRing {
+public:
+    struct Header {
+        uint32_t magic;
+        uint32_t capacity;
+        std::atomic<uint32_t> head;     // Written by the producer
+        std::atomic<uint32_t> tail;     // Written by the consumer
+        std::atomic<uint32_t> resync;   // Consumer asks for every widget in the next message
+    };
+
+    static size_t GetMemorySize(uint32_t capacity) {
+        return sizeof(Header) + capacity;
+    }
+
+    StateRing() {
+        header_ = nullptr;
+        data_ = nullptr;
+    }
+
+    void Create(void* memory, uint32_t capacity) {
+        IM_ASSERT(capacity >= 16 && (capacity & (capacity - 1)) == 0);
+        header_ = new (memory) Header;
+        header_->capacity = capacity;
+        header_->head = 0;
+        header_->tail = 0;
+        header_->resync = 1;
+        header_->magic = kStateRingMagic;
+        data_ = (uint8_t*)memory + sizeof(Header);
+    }
+
+    bool Attach(void* memory) {
+        Header* header = (Header*)memory;
+        if (header->magic != kStateRingMagic) {
+            return false;
+        }
+        header_ = header;
+        data_ = (uint8_t*)memory + sizeof(Header);
+        header_->resync = 1;
+        return true;
+    }
+
+    void Detach() {
+        header_ = nullptr;
+        data_ = nullptr;
+    }
+
+    bool IsAttached() {
+        return header_ != nullptr;
+    }
+
+    // False when the consumer is too far behind, the message is dropped
+    bool Push(const void* data, uint32_t size) {
+        const uint32_t head = header_->head.load(std::memory_order_relaxed);
+        const uint32_t tail = header_->tail.load(std::memory_order_acquire);
+        if ((uint64_t)header_->capacity - (head - tail) < sizeof(size) + (uint64_t)size) {
+            return false;
+        }
+        Copy(head, &size, sizeof(size));
+        Copy(head + sizeof(size), data, size);
+        header_->head.store(head + sizeof(size) + size, std::memory_order_release);
+        return true;
+    }
+
+    bool Pop(std::vector<uint8_t>& data) {
+        const uint32_t tail = header_->tail.load(std::memory_order_relaxed);
+        const uint32_t head = header_->head.load(std::memory_order_acquire);
+        if (head == tail) {
+            return false;
+        }
+        uint32_t size;
+        Read(tail, &size, sizeof(size));
+        data.resize(size);
+        Read(tail + sizeof(size), data.data(), size);
+        header_->tail.store(tail + sizeof(size) + size, std::memory_order_release);
+        return true;
+    }
+
+    void RequestResync() {
+        header_->resync = 1;
+    }
+
+    bool TakeResync() {
+        return header_->resync.exchange(0) != 0;
+    }
+
+private:
+    static const uint32_t kStateRingMagic = 0x52584749; // "IGXR"
+
+    void Copy(uint32_t offset, const void* data, uint32_t size) {
+        const uint32_t begin = offset & (header_->capacity - 1);
+        const uint32_t first = (std::min)(size, header_->capacity - begin);
+        memcpy(data_ + begin, data, first);
+        memcpy(data_, (const uint8_t*)data + first, size - first);
+    }
+
+    void Read(uint32_t offset, void* data, uint32_t size) {
+        const uint32_t begin = offset & (header_->capacity - 1);
+        const uint32_t first = (std::min)(size, header_->capacity - begin);
+        memcpy(data, data_ + begin, first);
+        memcpy((uint8_t*)data + first, data_, size - first);
+    }
+
+private:
+    Header* header_;
+    uint8_t* data_;
+};
+} // namespace internal
+
+/*
+* State mirror
+* A headless tool streams its registered widget state to a viewer process on the same machine through a named
+* shared memory ring. The tool sends the changes of every frame after ImGuiUpdate, the viewer applies them before its
+* own ImGuiUpdate so they surface as regular events. The capacity has to hold a message with every widget.
+*/
+bool StartStateMirror(const char* name, uint32_t capacity = 1 << 20);
+bool ConnectStateMirror(const char* name);
+void StopStateMirror();
+
+
+/*
+* Draw stream
+* The frame's draw data is encoded after ImGui::Render and replayed by a viewer process. A draw list whose hash matches
+* the list at the same index in the previous message is sent as a reference, the others as the XOR against that list's
+* previous buffers (or against the previous vertex for a new list) with the zero runs removed.
+*
+*   DrawStreamHeader
+*   per list: uint8_t mode
+*             mode != Same: uint32_t cmd_count, vtx_count, idx_count, commands, vertices, indices
+*   encoded buffer: uint32_t size, { varint zero_run, varint literal_count, literal bytes }...
+*
+* User callbacks do not cross processes and are dropped, the viewer maps the tool's font texture to its own and
+* drops commands with any other texture.
+*/
+struct DrawStreamStats {
+    uint64_t frames;
+    size_t raw_bytes;           // Draw data of the last frame, unencoded
+    size_t encoded_bytes;       // Message of the last frame
+    double compression_ratio;   // Raw over encoded, all frames
+    int lists_skipped;          // Unchanged lists in the last frame
+    double encode_ms;
+    double decode_ms;
+    double latency_ms;          // Encode to decode, viewer side, averaged
+};
+
+namespace internal {
+static const uint32_t kDrawStreamMagic = 0x56584749; // "IGXV"
+
+enum DrawStreamList : uint8_t {
+    DrawStreamList_Same,
+    DrawStreamList_Delta,
+    DrawStreamList_Full,
+};
+
+struct DrawStreamHeader {
+    uint32_t magic;
+    uint32_t frame;
+    uint64_t timestamp_ns;      // steady_clock, shared by processes on one machine
+    ImVec2 display_pos;
+    ImVec2 display_size;
+    ImVec2 framebuffer_scale;
+    uint64_t font_texture;
+    uint32_t list_count;
+    uint32_t raw_size;
+};
+
+struct DrawStreamCmd {
+    ImVec4 clip_rect;
+    uint64_t texture;
+    uint32_t vtx_offset;
+    uint32_t idx_offset;
+    uint32_t elem_count;
+    uint32_t reserved;          // Zero, the padding is hashed and sent, it must not hold stack garbage
+};
+
+class DrawStreamCodec {
+protected:
+    template<class T>
+    static void Put(std::vector<uint8_t>& out, const T& value) {
+        const uint8_t* bytes = (const uint8_t*)&value;
+        out.insert(out.end(), bytes, bytes + sizeof(T));
+    }
+
+    static void PutVarint(std::vector<uint8_t>& out, size_t value) {
+        while (value >= 0x80) {
+            out.push_back((uint8_t)(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back((uint8_t)value);
+    }
+
+    // XOR against base where it exists, otherwise against the element stride bytes back, then zero runs are dropped
+    static void EncodeBytes(std::vector<uint8_t>& out, const uint8_t* data, size_t size, const uint8_t* base, size_t base_size, size_t stride) {
+        auto code = [&](size_t i) -> uint8_t {
+            if (base != nullptr) {
+                return i < base_size ? data[i] ^ base[i] : data[i];
+            }
+            return i >= stride ? data[i] ^ data[i - stride] : data[i];
+        };
+        const size_t size_offset = out.size();
+        Put(out, (uint32_t)0);
+        size_t i = 0;
+        while (i < size) {
+            size_t zeros = 0;
+            while (i + zeros < size && code(i + zeros) == 0) {
+                zeros++;
+            }
+            i += zeros;
+            // A literal ends at a run of four zero bytes, shorter runs cost more as tokens than as literals
+            size_t literal = 0;
+            while (i + literal < size) {
+                size_t run = 0;
+                while (run < 4 && i + literal + run < size && code(i + literal + run) == 0) {
+                    run++;
+                }
+                if (run == 4 || i + literal + run == size) {
+                    break;
+                }
+                literal += run + 1;
+            }
+            PutVarint(out, zeros);
+            PutVarint(out, literal);
+            for (size_t j = 0; j < literal; j++) {
+                out.push_back(code(i + j));
+            }
+            i += literal;
+        }
+        const uint32_t encoded_size = (uint32_t)(out.size() - size_offset - sizeof(uint32_t));
+        memcpy(&out[size_offset], &encoded_size, sizeof(encoded_size));
+    }
+
+    class Reader {
+    public:
+        Reader(const uint8_t* data, size_t size) {
+            data_ = data;
+            size_ = size;
+            offset_ = 0;
+        }
+
+        template<class T>
+        bool Get(T& value) {
+            if (size_ - offset_ < sizeof(T)) {
+                return false;
+            }
+            memcpy(&value, data_ + offset_, sizeof(T));
+            offset_ += sizeof(T);
+            return true;
+        }
+
+        bool GetVarint(size_t& value) {
+            value = 0;
+            for (int shift = 0; shift < 64 && offset_ < size_; shift += 7) {
+                const uint8_t byte = data_[offset_++];
+                value |= (size_t)(byte & 0x7f) << shift;
+                if ((byte & 0x80) == 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Decodes in place: data holds the previous buffer in its first base_size bytes
+        bool DecodeBytes(uint8_t* data, size_t size, size_t base_size, size_t stride, bool delta) {
+            uint32_t encoded_size;
+            if (!Get(encoded_size) || size_ - offset_ < encoded_size) {
+                return false;
+            }
+            Reader tokens(data_ + offset_, encoded_size);
+            offset_ += encoded_size;
+            auto decode = [&](size_t i, uint8_t code) {
+                if (delta) {
+                    data[i] = i < base_size ? data[i] ^ code : code;
+                }
+                else {
+                    data[i] = i >= stride ? data[i - stride] ^ code : code;
+                }
+            };
+            size_t i = 0;
+            while (i < size) {
+                size_t zeros, literal;
+                if (!tokens.GetVarint(zeros) || !tokens.GetVarint(literal) || size - i < zeros || size - i - zeros < literal ||
+                    tokens.size_ - tokens.offset_ < literal) {
+                    return false;
+                }
+                for (size_t end = i + zeros; i < end; i++) {
+                    decode(i, 0);
+                }
+                for (size_t end = i + literal; i < end; i++) {
+                    decode(i, tokens.data_[tokens.offset_++]);
+                }
+            }
+            return true;
+        }
+
+    private:
+        const uint8_t* data_;
+        size_t size_;
+        size_t offset_;
+    };
+};
+
+class DrawStreamEncoder : public DrawStreamCodec {
+public:
+    DrawStreamEncoder() {
+        frame_ = 0;
+        raw_total_ = 0;
+        encoded_total_ = 0;
+        stats_ = {};
     }
 
+    // The next message sends every list in full, for a new viewer or after a dropped message
+    void Reset() {
+        lists_.clear();
+    }
 
-    std::string GetText() {
-        return GetLabel();
+    void Encode(const ImDrawData* draw_data, ImTextureID font_texture, std::vector<uint8_t>& out) {
+        const auto start = std::chrono::steady_clock::now();
+        out.clear();
+        out.resize(sizeof(DrawStreamHeader));
+        const int list_count = draw_data->Valid ? draw_data->CmdListsCount : 0;
+        size_t raw_size = 0;
+        int skipped = 0;
+        for (int i = 0; i < list_count; i++) {
+            const ImDrawList* list = draw_data->CmdLists[i];
+            const size_t vtx_size = (size_t)list->VtxBuffer.Size * sizeof(ImDrawVert);
+            const size_t idx_size = (size_t)list->IdxBuffer.Size * sizeof(ImDrawIdx);
+            raw_size += vtx_size + idx_size + (size_t)list->CmdBuffer.Size * sizeof(ImDrawCmd);
+
+            commands_.clear();
+            for (const ImDrawCmd& cmd : list->CmdBuffer) {
+                if (cmd.UserCallback == nullptr && cmd.ElemCount > 0) {
+                    commands_.push_back({ cmd.ClipRect, (uint64_t)(uintptr_t)cmd.GetTexID(), cmd.VtxOffset, cmd.IdxOffset, cmd.ElemCount, 0 });
+                }
+            }
+            ImGuiID hash = ImHashData(list->VtxBuffer.Data, vtx_size);
+            hash = ImHashData(list->IdxBuffer.Data, idx_size, hash);
+            hash = ImHashData(commands_.data(), commands_.size() * sizeof(DrawStreamCmd), hash);
+
+            const bool has_base = i < (int)lists_.size();
+            if (has_base && lists_[i].hash == hash && lists_[i].vtx.size() == vtx_size && lists_[i].idx.size() == idx_size) {
+                out.push_back(DrawStreamList_Same);
+                skipped++;
+                continue;
+            }
+            if (!has_base) {
+                lists_.emplace_back();
+            }
+            List& previous = lists_[i];
+            out.push_back(has_base ? DrawStreamList_Delta : DrawStreamList_Full);
+            Put(out, (uint32_t)commands_.size());
+            Put(out, (uint32_t)list->VtxBuffer.Size);
+            Put(out, (uint32_t)list->IdxBuffer.Size);
+            out.insert(out.end(), (const uint8_t*)commands_.data(), (const uint8_t*)(commands_.data() + commands_.size()));
+            EncodeBytes(out, (const uint8_t*)list->VtxBuffer.Data, vtx_size, has_base ? previous.vtx.data() : nullptr, previous.vtx.size(), sizeof(ImDrawVert));
+            EncodeBytes(out, (const uint8_t*)list->IdxBuffer.Data, idx_size, has_base ? previous.idx.data() : nullptr, previous.idx.size(), sizeof(ImDrawIdx));
+            previous.hash = hash;
+            previous.vtx.assign((const uint8_t*)list->VtxBuffer.Data, (const uint8_t*)list->VtxBuffer.Data + vtx_size);
+            previous.idx.assign((const uint8_t*)list->IdxBuffer.Data, (const uint8_t*)list->IdxBuffer.Data + idx_size);
+        }
+        lists_.resize((std::min)(lists_.size(), (size_t)list_count));
+
+        DrawStreamHeader header = {};
+        header.magic = kDrawStreamMagic;
+        header.frame = frame_++;
+        header.timestamp_ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        header.display_pos = draw_data->DisplayPos;
+        header.display_size = draw_data->DisplaySize;
+        header.framebuffer_scale = draw_data->FramebufferScale;
+        header.font_texture = (uint64_t)(uintptr_t)font_texture;
+        header.list_count = (uint32_t)list_count;
+        header.raw_size = (uint32_t)raw_size;
+        memcpy(out.data(), &header, sizeof(header));
+
+        raw_total_ += raw_size;
+        encoded_total_ += out.size();
+        stats_.frames++;
+        stats_.raw_bytes = raw_size;
+        stats_.encoded_bytes = out.size();
+        stats_.compression_ratio = encoded_total_ > 0 ? (double)raw_total_ / (double)encoded_total_ : 0.0;
+        stats_.lists_skipped = skipped;
+        stats_.encode_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
     }
 
-    void SetText(const std::string& text) {
-        return SetLabel(text);
+    DrawStreamStats GetStats() {
+        return stats_;
     }
 
 private:
-    std::string text_;
+    struct List {
+        ImGuiID hash = 0;
+        std::vector<uint8_t> vtx;
+        std::vector<uint8_t> idx;
+    };
+
+    std::vector<List> lists_;
+    std::vector<DrawStreamCmd> commands_;
+    uint32_t frame_;
+    uint64_t raw_total_;
+    uint64_t encoded_total_;
+    DrawStreamStats stats_;
 };
 
-class SeparatorText : public Widget {
+class DrawStreamDecoder : public DrawStreamCodec {
 public:
-    SeparatorText(const std::string& label) : Widget(label) {
-        
+    DrawStreamDecoder() {
+        font_texture_ = ImTextureID();
+        has_frame_ = false;
+        stats_ = {};
     }
 
-    void Begin() {
-        Widget::Begin();
-        ImGui::SeparatorText(GetLabel().c_str());
+    DrawStreamDecoder(const DrawStreamDecoder&) = delete;
+    DrawStreamDecoder& operator=(const DrawStreamDecoder&) = delete;
+
+    ~DrawStreamDecoder() {
+        Reset();
     }
 
-    void End() {
-        Widget::End();
+    void SetFontTexture(ImTextureID font_texture) {
+        font_texture_ = font_texture;
     }
-};
 
-class BulletText : public Widget {
-public:
-    template<typename ... Args>
-    BulletText(const char* fmt, Args... args) : Widget(fmt) {
-        ImGui:;BulletText(fmt, args...);
+    // Messages have to be decoded in order, false means the viewer needs a full message again
+    bool Decode(const void* data, size_t size) {
+        const auto start = std::chrono::steady_clock::now();
+        Reader reader((const uint8_t*)data, size);
+        DrawStreamHeader header;
+        if (!reader.Get(header) || header.magic != kDrawStreamMagic) {
+            return Fail();
+        }
+        while (lists_.size() < header.list_count) {
+            lists_.push_back(IM_NEW(ImDrawList)(ImGui::GetDrawListSharedData()));
+            valid_.push_back(false);
+        }
+        for (uint32_t i = 0; i < header.list_count; i++) {
+            uint8_t mode;
+            if (!reader.Get(mode) || mode > DrawStreamList_Full || (mode != DrawStreamList_Full && !valid_[i])) {
+                return Fail();
+            }
+            if (mode == DrawStreamList_Same) {
+                continue;
+            }
+            uint32_t cmd_count, vtx_count, idx_count;
+            if (!reader.Get(cmd_count) || !reader.Get(vtx_count) || !reader.Get(idx_count)) {
+                return Fail();
+            }
+            ImDrawList* list = lists_[i];
+            valid_[i] = false;
+            list->CmdBuffer.resize(0);
+            for (uint32_t c = 0; c < cmd_count; c++) {
+                DrawStreamCmd cmd;
+                if (!reader.Get(cmd)) {
+                    return Fail();
+                }
+                if (cmd.texture != header.font_texture || cmd.idx_offset + (uint64_t)cmd.elem_count > idx_count) {
+                    continue;
+                }
+                if (cmd.elem_count > 0 && cmd.vtx_offset >= vtx_count) {
+                    continue;
+                }
+                ImDrawCmd draw_cmd;
+                draw_cmd.ClipRect = cmd.clip_rect;
+                draw_cmd.TextureId = font_texture_;
+                draw_cmd.VtxOffset = cmd.vtx_offset;
+                draw_cmd.IdxOffset = cmd.idx_offset;
+                draw_cmd.ElemCount = cmd.elem_count;
+                list->CmdBuffer.push_back(draw_cmd);
+            }
+            const size_t vtx_base = (size_t)list->VtxBuffer.Size * sizeof(ImDrawVert);
+            const size_t idx_base = (size_t)list->IdxBuffer.Size * sizeof(ImDrawIdx);
+            list->VtxBuffer.resize((int)vtx_count);
+            list->IdxBuffer.resize((int)idx_count);
+            const bool delta = mode == DrawStreamList_Delta;
+            if (!reader.DecodeBytes((uint8_t*)list->VtxBuffer.Data, (size_t)vtx_count * sizeof(ImDrawVert), vtx_base, sizeof(ImDrawVert), delta) ||
+                !reader.DecodeBytes((uint8_t*)list->IdxBuffer.Data, (size_t)idx_count * sizeof(ImDrawIdx), idx_base, sizeof(ImDrawIdx), delta)) {
+                return Fail();
+            }
+            DropOutOfRangeCmds(list);
+            valid_[i] = true;
+        }
+        for (size_t i = header.list_count; i < valid_.size(); i++) {
+            valid_[i] = false;
+        }
+
+        draw_data_.Valid = true;
+        draw_data_.CmdListsCount = (int)header.list_count;
+        draw_data_.CmdLists.resize((int)header.list_count);
+        draw_data_.TotalVtxCount = 0;
+        draw_data_.TotalIdxCount = 0;
+        for (uint32_t i = 0; i < header.list_count; i++) {
+            draw_data_.CmdLists[i] = lists_[i];
+            draw_data_.TotalVtxCount += lists_[i]->VtxBuffer.Size;
+            draw_data_.TotalIdxCount += lists_[i]->IdxBuffer.Size;
+        }
+        draw_data_.DisplayPos = header.display_pos;
+        draw_data_.DisplaySize = header.display_size;
+        draw_data_.FramebufferScale = header.framebuffer_scale;
+        draw_data_.OwnerViewport = nullptr;
+        has_frame_ = true;
+
+        const auto now = std::chrono::steady_clock::now();
+        const double latency_ms = (double)((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count() - header.timestamp_ns) / 1e6;
+        stats_.latency_ms = stats_.frames == 0 ? latency_ms : stats_.latency_ms * 0.9 + latency_ms * 0.1;
+        stats_.frames++;
+        stats_.raw_bytes = header.raw_size;
+        stats_.encoded_bytes = size;
+        stats_.decode_ms = std::chrono::duration<double, std::milli>(now - start).count();
+        return true;
     }
 
-    void Begin() {
-        Widget::Begin();
-        ImGui::BulletText(GetLabel().c_str());
+    void Reset() {
+        for (auto list : lists_) {
+            IM_DELETE(list);
+        }
+        lists_.clear();
+        valid_.clear();
+        draw_data_.CmdLists.clear();
+        draw_data_.CmdListsCount = 0;
+        has_frame_ = false;
     }
 
-    void End() {
-        Widget::End();
+    // Last decoded frame, the lists stay valid until the next Decode or Reset
+    ImDrawData* Get() {
+        return has_frame_ ? &draw_data_ : nullptr;
     }
-};
 
-class HelpMarker : public Widget {
-public:
-    HelpMarker(const std::string& title, const std::string& desc) : Widget(title), desc_(desc) {
-        
+    DrawStreamStats GetStats() {
+        return stats_;
     }
 
-    void Begin() {
-        Widget::Begin();
-        
-        ImGui::TextDisabled(GetLabel().c_str());
-        if (ImGui::BeginItemTooltip()) {
-            ImGui::PushTextWrapPos(ImGui::GetFontSize() * 35.0f);
-            ImGui::TextUnformatted(desc_.c_str());
-            ImGui::PopTextWrapPos();
-            ImGui::EndTooltip();
-        }
+private:
+    bool Fail() {
+        Reset();
+        return false;
     }
 
-    void End() {
-        Widget::End();
+    // Indices are relative to VtxOffset, one past the decoded vertices would have the GPU read past the buffer
+    static void DropOutOfRangeCmds(ImDrawList* list) {
+        const uint64_t vtx_count = (uint64_t)list->VtxBuffer.Size;
+        int kept = 0;
+        for (int c = 0; c < list->CmdBuffer.Size; c++) {
+            const ImDrawCmd& cmd = list->CmdBuffer[c];
+            const ImDrawIdx* idx = list->IdxBuffer.Data + cmd.IdxOffset;
+            ImDrawIdx max_idx = 0;
+            for (unsigned int e = 0; e < cmd.ElemCount; e++) {
+                max_idx = idx[e] > max_idx ? idx[e] : max_idx;
+            }
+            if (cmd.ElemCount > 0 && cmd.VtxOffset + (uint64_t)max_idx >= vtx_count) {
+                continue;
+            }
+            list->CmdBuffer[kept++] = cmd;
+        }
+        list->CmdBuffer.resize(kept);
     }
 
 private:
-    std::string desc_;
+    ImTextureID font_texture_;
+    std::vector<ImDrawList*> lists_;
+    std::vector<bool> valid_;
+    ImDrawData draw_data_;
+    bool has_frame_;
+    DrawStreamStats stats_;
 };
+} // namespace internal
 
+// The tool side encodes after ImGui::Render, the viewer draws the last decoded frame instead of its own main viewport
+bool StartDrawStream(const char* name, uint32_t capacity = 8 << 20);
+bool ConnectDrawStream(const char* name);
+void StopDrawStream();
+DrawStreamStats GetDrawStreamStats();
 
-class CollapsingHeader : public Widget,
-                         public Expandable
-{
-public:
-    CollapsingHeader(const std::string& label) : Widget(label) {
-        
-    }
 
-    void Begin() {
-        Widget::Begin();
-        expand_ = ImGui::CollapsingHeader(GetLabel().c_str());
+/*
+* Benchmarks
+* Synthetic UIs built from the widgets above, each run on a fresh ImGui context without a platform or renderer backend.
+* Starting the application with --benchmark <results.json> [--baseline <baseline.json>] runs them instead of the UI,
+* the exit code is 2 when a result regressed past the baseline.
+*/
+struct BenchmarkConfig {
+    int frames;
+    int windows;
+    int buttons;            // Buttons and checkboxes per window
+    int list_items;         // ListBox and Combo items
+    int text_lines;         // InputTextMultiline lines
+    int tree_depth;         // Nested expanded TreeNodes
+    int form_labels;        // Text widgets of the label form, run with and without their TextSizeMemo
+    int static_lines;       // Text lines of the static Window page, run with and without SetStatic
+    int plot_samples;       // Samples held by the Plot, drawn fully zoomed out
+    int state_widgets;      // Widgets in the StateRegistry save and restore
+    double tolerance;       // Allowed growth over the baseline, 0.1 = 10%
+
+    BenchmarkConfig() {
+        frames = 300;
+        windows = 16;
+        buttons = 64;
+        list_items = 100000;
+        text_lines = 5000;
+        tree_depth = 64;
+        form_labels = 20000;
+        static_lines = 2000;
+        plot_samples = 10000000;
+        state_widgets = 100000;
+        tolerance = 0.1;
     }
+};
 
-    void End() {
-        end_expand_ = expand_;
-        Widget::End();
-    }
+struct BenchmarkResult {
+    std::string name;
+    int frames;
+    double cpu_ms_mean;
+    double cpu_ms_p95;
+    double allocations_per_frame;       // ImGui allocations and operator new, on any thread
+    double vertices_per_frame;
+    double throughput_mb_s;     // Only set by throughput benchmarks, lower is worse
+    double bytes_per_frame;     // Only set by the streaming benchmarks, wire bytes
+    double latency_ms;          // Only set by the streaming benchmarks, send to apply
+    double compression_ratio;   // Only set by the draw stream benchmark, lower is worse
+};
+
+std::vector<BenchmarkResult> RunBenchmarks(const BenchmarkConfig& config = BenchmarkConfig());
+bool WriteBenchmarkJson(const char* path, const std::vector<BenchmarkResult>& results);
+bool ReadBenchmarkJson(const char* path, std::vector<BenchmarkResult>& results);
+// One line per metric that grew past baseline * (1 + tolerance), or that the baseline lacks
+std::vector<std::string> FindBenchmarkRegressions(const std::vector<BenchmarkResult>& results, const std::vector<BenchmarkResult>& baseline, double tolerance);
 
-private:
 
+/*
+* UI driver
+* Runs widget code on a private ImGui context without a platform or renderer backend and feeds it scripted input,
+* so a test can click a Button by label and check that its ClickEvent fired on the expected frame.
+*
+*   ImGuiEx::UiDriver driver;
+*   ImGuiEx::Window window("Tools");
+*   ImGuiEx::Button run("Run");
+*   auto frame = [&]() {
+*       window.Begin();
+*       window.ExpandUpdate([&]() { run.Begin(); run.End(); });
+*       window.End();
+*       run.ClickEvent([&]() { driver.Fire("run"); });
+*   };
+*   driver.Run(2, frame);
+*   driver.Click("Run");
+*   driver.Run(3, frame);
+*   driver.ExpectFired("run", driver.GetFrame() - 1);
+*
+* Items are located through ImGui's test engine hooks by the label they were submitted with, windows by name.
+* Only items that were visible on the last frame can be found.
+* Define IMGUI_EX_UI_DRIVER before including ImGui to build the hooks in, release builds leave it undefined.
+*/
+#ifdef IMGUI_EX_UI_DRIVER
+struct UiDriverItem {
+    ImGuiID id;
+    std::string label;
+    std::string window;
+    ImRect rect;
 };
 
-class TreeNode : public Widget,
-                 public Expandable
-{
+class UiDriver {
 public:
-    TreeNode(const std::string& label) : Widget(label) {
-        end_expand_ = false;
-        expand_ = false;
+    UiDriver(const ImVec2& display_size = ImVec2(1280.0f, 720.0f)) {
+        ImGuiContext* previous = ImGui::GetCurrentContext();
+        context_ = ImGui::CreateContext();
+        ImGui::SetCurrentContext(context_);
+        ImGuiIO& io = ImGui::GetIO();
+        io.IniFilename = nullptr;
+        io.LogFilename = nullptr;
+        io.DisplaySize = display_size;
+        io.DeltaTime = 1.0f / 60.0f;
+        unsigned char* pixels;
+        int width, height;
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+        context_->TestEngine = this;
+        context_->TestEngineHookItems = true;
+        ImGui::SetCurrentContext(previous);
+        frame_ = 0;
     }
 
-    void Begin() {
-        Widget::Begin();
-        expand_ = ImGui::TreeNode(GetLabel().c_str());
+    ~UiDriver() {
+        ImGui::DestroyContext(context_);
     }
 
-    void End() {
-        if (expand_) {
-            ImGui::TreePop();
-        }
-        end_expand_ = expand_;
-        Widget::End();
-    }
+    UiDriver(const UiDriver&) = delete;
+    UiDriver& operator=(const UiDriver&) = delete;
 
 
     /*
-    * Event
+    * Input, delay is counted in frames from the next one
     */
-private:
-};
+    void MouseMove(const ImVec2& pos, int delay = 0) {
+        Input input = Input(Input_MousePos, delay);
+        input.pos = pos;
+        Schedule(input);
+    }
 
-class CheckBox : public Widget {
-public:
-    CheckBox(const std::string& label, bool check = false) : Widget(label) {
-        end_check_ = false;
-        check_ = check;
+    void MouseButton(ImGuiMouseButton button, bool down, int delay = 0) {
+        Input input = Input(Input_MouseButton, delay);
+        input.code = button;
+        input.down = down;
+        Schedule(input);
     }
 
-    void Begin() {
-        Widget::Begin();
-        ImGui::Checkbox(GetLabel().c_str(), &check_);
+    void MouseWheel(float wheel, int delay = 0) {
+        Input input = Input(Input_MouseWheel, delay);
+        input.pos = ImVec2(0.0f, wheel);
+        Schedule(input);
     }
 
-    void End() {
-        end_check_ = check_;
-        Widget::End();
+    void Key(ImGuiKey key, bool down, int delay = 0) {
+        Input input = Input(Input_Key, delay);
+        input.code = key;
+        input.down = down;
+        Schedule(input);
     }
 
+    // Down, then up on the following frame
+    void PressKey(ImGuiKey key, int delay = 0) {
+        Key(key, true, delay);
+        Key(key, false, delay + 1);
+    }
 
-    /*
-    * Event
-    */
-    void CheckEvent(std::function<void()> event) {
-        if (end_check_ == false && check_ == true) {
-            event();
-        }
+    void Text(const std::string& text, int delay = 0) {
+        Input input = Input(Input_Text, delay);
+        input.text = text;
+        Schedule(input);
     }
 
-    void UncheckEvent(std::function<void()> event) {
-        if (end_check_ == true && check_ == false) {
-            event();
+    // Move, press and release on three consecutive frames, the widget reports the click on the release frame
+    bool Click(const std::string& label, const char* window = nullptr, int delay = 0) {
+        const UiDriverItem* item = Find(label, window);
+        if (item == nullptr) {
+            Expect(false, "Click: no item \"" + label + "\"");
+            return false;
         }
+        MouseMove(item->rect.GetCenter(), delay);
+        MouseButton(ImGuiMouseButton_Left, true, delay + 1);
+        MouseButton(ImGuiMouseButton_Left, false, delay + 2);
+        return true;
     }
 
+
     /*
-    * Control
+    * Frames
     */
-    void SetCheck(bool check) {
-        check_ = check;
+    template<class Fn>
+    void Step(Fn&& frame) {
+        ImGuiContext* previous = ImGui::GetCurrentContext();
+        ImGui::SetCurrentContext(context_);
+        ApplyInput();
+        frame_items_.clear();
+        ImGui::NewFrame();
+        context_->TestEngineHookItems = true;
+        frame();
+        ImGui::EndFrame();
+        CollectWindows();
+        // As in the main loop, nothing of the frame's arena text outlives it
+        GetFrameArena().Reset();
+        items_.swap(frame_items_);
+        frame_++;
+        ImGui::SetCurrentContext(previous);
     }
 
-private:
-    bool end_check_;
-    bool check_;
-};
-
-template<class Element = std::string>
-class ListBox : public Widget {
-public:
-    ListBox(const std::string& label) : Widget(label), size_(-FLT_MIN, -FLT_MIN) {
-        entry_ = false;
-        end_select_index_ = -1;
-        select_index_ = -1;
+    template<class Fn>
+    void Run(int frames, Fn&& frame) {
+        for (int i = 0; i < frames; i++) {
+            Step(frame);
+        }
     }
 
-    void Begin() {
-        Widget::Begin();
-        entry_ = ImGui::BeginListBox(GetLabel().c_str(), size_);
+    // Frames run so far, Fire inside a Step records the current value
+    int GetFrame() const {
+        return frame_;
     }
 
-    void End() {
-        if (entry_) {
-            ImGui::EndListBox();
-        }
-        Widget::End();
+    ImGuiContext* GetContext() {
+        return context_;
     }
 
+
     /*
-    * Update
+    * Locator
     */
-    void InsertUpdate(std::function<std::string(Element&)> insert) {
-        for (int i = 0; i < list_.size(); i++) {
-            const bool is_selected = (select_index_ == i);
-            auto temp = insert(list_[i]);
-
-            if (temp.empty()) {
-                continue;
-            }
-
-            if (ImGui::Selectable(temp.c_str(), is_selected)) {
-                select_index_ = i;
-            }
-
-            if (is_selected) {
-                ImGui::SetItemDefaultFocus();
+    const UiDriverItem* Find(const std::string& label, const char* window = nullptr) const {
+        for (const UiDriverItem& item : items_) {
+            if (item.label == label && (window == nullptr || item.window == window)) {
+                return &item;
             }
         }
+        return nullptr;
     }
 
-    /*
-    * Event
-    */
-    void SelectEvent(std::function<void()> event) {
-        if (end_select_index_ != select_index_) {
-            event();
-        }
+    const std::vector<UiDriverItem>& GetItems() const {
+        return items_;
     }
 
+
     /*
-    * Control
+    * Assertions
     */
-    Element& GetSelectItem() {
-        return list_.at(select_index_);
-    }
-
-    int GetSelectIndex() {
-        return select_index_;
+    // Call from an event handler to record that it ran on this frame
+    void Fire(const std::string& event) {
+        fired_.emplace_back(event, frame_);
     }
 
-    int SetSelectIndex(int select_index) {
-        select_index_ = select_index;
+    int GetFireCount(const std::string& event, int frame) const {
+        int count = 0;
+        for (const auto& fired : fired_) {
+            if (fired.second == frame && fired.first == event) {
+                count++;
+            }
+        }
+        return count;
     }
 
-    void SetSize(const ImVec2& size) {
-        size_ = size;
+    bool Expect(bool condition, const std::string& what) {
+        if (!condition) {
+            failures_.push_back("frame " + std::to_string(frame_) + ": " + what);
+        }
+        return condition;
     }
 
-    ImVec2& GetSize() {
-        return size_;
+    bool ExpectFired(const std::string& event, int frame) {
+        return Expect(GetFireCount(event, frame) > 0, event + " did not fire on frame " + std::to_string(frame));
     }
 
-    void SetList(std::vector<Element>&& list) {
-        list_ = std::move(list);
+    bool ExpectNotFired(const std::string& event, int frame) {
+        return Expect(GetFireCount(event, frame) == 0, event + " fired on frame " + std::to_string(frame));
     }
 
-    std::vector<Element>& GetList() {
-        return list_;
+    const std::vector<std::string>& GetFailures() const {
+        return failures_;
     }
 
-    void ClearList() {
-        list_.clear();
+    void ClearFired() {
+        fired_.clear();
     }
 
-private:
-    std::vector<Element> list_;
-
-    ImVec2 size_;
-
-    bool entry_;
-
-    int end_select_index_;
-    int select_index_;
-};
-
-class RadioButtonGroup : public Widget {
-public:
-    RadioButtonGroup(std::vector<std::string> label_list) : Widget(""), label_list_(label_list){
-        push_index_ = 0;
-        select_index_ = 0;
-        end_select_index_ = 0;
-    }
 
-    void Begin(std::function<void(size_t)> push) {
-        Widget::Begin();
-        push_index_ = 0;
-        for (size_t i = 0; i < label_list_.size(); i++) {
-            ImGui::RadioButton(label_list_[i].c_str(), &select_index_, push_index_++);
-            push(i);
+    /*
+    * Test engine hooks, called by ImGui for every submitted item
+    */
+    void ItemAdd(ImGuiID id, const ImRect& rect) {
+        UiDriverItem item;
+        item.id = id;
+        item.rect = rect;
+        ImGuiWindow* window = context_->CurrentWindow;
+        if (window != nullptr) {
+            item.window = window->RootWindow->Name;
         }
+        frame_items_.push_back(std::move(item));
     }
 
-    void Begin() {
-        Begin([](size_t i) {});
-    }
-
-    void End() {
-        end_select_index_ = select_index_;
-        Widget::End();
-    }
-
-
-    void SelectEvent(std::function<void()> event) {
-        if (end_select_index_ != select_index_) {
-            event();
+    void ItemInfo(ImGuiID id, const char* label) {
+        // Widgets report the label right after adding the item
+        for (auto item = frame_items_.rbegin(); item != frame_items_.rend(); ++item) {
+            if (item->id == id) {
+                item->label = label;
+                return;
+            }
         }
     }
 
 private:
-    std::vector<std::string> label_list_;
-
-    int push_index_;
-    int end_select_index_;
-    int select_index_;
-};
-
-
-namespace layout {
-    static void Indent() {
-        ImGui::Indent();
+    enum InputType {
+        Input_MousePos,
+        Input_MouseButton,
+        Input_MouseWheel,
+        Input_Key,
+        Input_Text
+    };
+
+    struct Input {
+        Input(InputType type, int delay) : type(type), frame(delay), code(0), down(false) {}
+
+        InputType type;
+        int frame;
+        int code;
+        bool down;
+        ImVec2 pos;
+        std::string text;
+    };
+
+    void Schedule(Input input) {
+        input.frame += frame_;
+        // Stable on equal frames so a script runs in the order it was written
+        auto at = std::upper_bound(inputs_.begin(), inputs_.end(), input.frame, [](int frame, const Input& other) { return frame < other.frame; });
+        inputs_.insert(at, std::move(input));
     }
 
-    static void Unindent() {
-        ImGui::Unindent();
+    void ApplyInput() {
+        ImGuiIO& io = ImGui::GetIO();
+        size_t count = 0;
+        for (; count < inputs_.size() && inputs_[count].frame <= frame_; count++) {
+            const Input& input = inputs_[count];
+            switch (input.type) {
+            case Input_MousePos:
+                io.AddMousePosEvent(input.pos.x, input.pos.y);
+                break;
+            case Input_MouseButton:
+                io.AddMouseButtonEvent(input.code, input.down);
+                break;
+            case Input_MouseWheel:
+                io.AddMouseWheelEvent(input.pos.x, input.pos.y);
+                break;
+            case Input_Key:
+                io.AddKeyEvent((ImGuiKey)input.code, input.down);
+                break;
+            case Input_Text:
+                io.AddInputCharactersUTF8(input.text.c_str());
+                break;
+            }
+        }
+        inputs_.erase(inputs_.begin(), inputs_.begin() + count);
     }
 
-    static void Spacing() {
-        ImGui::Spacing();
+    // Windows are located by the title bar
+    void CollectWindows() {
+        for (ImGuiWindow* window : context_->Windows) {
+            if (!window->Active || window->Hidden || (window->Flags & ImGuiWindowFlags_ChildWindow)) {
+                continue;
+            }
+            UiDriverItem item;
+            item.id = window->ID;
+            item.label = window->Name;
+            item.window = window->Name;
+            item.rect = window->TitleBarRect();
+            frame_items_.push_back(std::move(item));
+        }
     }
 
-    static void SameLine() {
-        ImGui::SameLine();
-    }
-}
+    ImGuiContext* context_;
+    int frame_;
+    std::vector<Input> inputs_;
+    std::vector<UiDriverItem> items_;
+    std::vector<UiDriverItem> frame_items_;
+    std::vector<std::pair<std::string, int>> fired_;
+    std::vector<std::string> failures_;
+};
+#endif // IMGUI_EX_UI_DRIVER
 
 } // namespace ImGuiEx
 
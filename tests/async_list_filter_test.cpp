@@ -0,0 +1,112 @@
+// AsyncListFilter: only the newest query is applied, older jobs leave its progress alone
+#include "imgui_ex_test.h"
+
+#include <chrono>
+
+using ImGuiEx::internal::AsyncListFilter;
+using ImGuiEx::internal::LabelArena;
+
+static std::shared_ptr<const LabelArena> MakeArena(size_t count)
+{
+    auto arena = std::make_shared<LabelArena>();
+    arena->Build(count, [](size_t i) -> const std::string& {
+        static std::string label;
+        label = "item " + std::to_string(i);
+        return label;
+    });
+    return arena;
+}
+
+static AsyncListFilter::Result* WaitForResult(AsyncListFilter& filter)
+{
+    for (int i = 0; i < 10000; i++)
+    {
+        if (AsyncListFilter::Result* result = filter.Poll())
+            return result;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return nullptr;
+}
+
+// Holds one pool thread until released, started tells that the thread took it
+struct BlockingTask
+{
+    std::atomic<bool> started{ false };
+    std::atomic<bool> release{ false };
+
+    void Submit()
+    {
+        ImGuiEx::GetWorkerPool().Submit([this]() {
+            started = true;
+            while (!release)
+                std::this_thread::yield();
+        });
+    }
+
+    void WaitStarted()
+    {
+        while (!started)
+            std::this_thread::yield();
+    }
+};
+
+static void TestBackToBackSubmits()
+{
+    const auto arena = MakeArena(200000);
+    AsyncListFilter filter;
+    const char* const queries[] = { "1", "12", "123", "2", "23", "9", "99", "4" };
+    for (const char* query : queries)
+        filter.Submit(arena, 1, query, ImGuiEx::ListSort_None, nullptr);
+
+    AsyncListFilter::Result* result = WaitForResult(filter);
+    IMGUI_EX_CHECK(result != nullptr);
+    if (result == nullptr)
+        return;
+    IMGUI_EX_CHECK(result->filter == "4");
+    std::vector<int> expected;
+    arena->Search("4", expected);
+    IMGUI_EX_CHECK(result->rows == expected);
+    filter.Recycle(result);
+    IMGUI_EX_CHECK(filter.GetProgress() == 1.0f);
+
+    // Nothing older shows up afterwards
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    IMGUI_EX_CHECK(filter.Poll() == nullptr);
+}
+
+// A job that is replaced mid-run still finishes its chunk, the new query's progress must not move
+static void TestStaleProgressIgnored()
+{
+    const auto arena = MakeArena(4000000);
+    AsyncListFilter filter;
+    BlockingTask first_blocker;
+    BlockingTask second_blocker;
+
+    // Thread one: the blocker. Thread two: the old query.
+    first_blocker.Submit();
+    first_blocker.WaitStarted();
+    filter.Submit(arena, 1, "7", ImGuiEx::ListSort_None, nullptr);
+    while (filter.GetProgress() == 0.0f)
+        std::this_thread::yield();
+
+    // The new query queues behind the second blocker, which starts once the old query returned
+    second_blocker.Submit();
+    filter.Submit(arena, 1, "8", ImGuiEx::ListSort_None, nullptr);
+    second_blocker.WaitStarted();
+    IMGUI_EX_CHECK(filter.GetProgress() == 0.0f);
+
+    first_blocker.release = true;
+    second_blocker.release = true;
+    AsyncListFilter::Result* result = WaitForResult(filter);
+    IMGUI_EX_CHECK(result != nullptr && result->filter == "8");
+    if (result != nullptr)
+        filter.Recycle(result);
+    IMGUI_EX_CHECK(filter.GetProgress() == 1.0f);
+}
+
+int main()
+{
+    IMGUI_EX_TEST(TestBackToBackSubmits);
+    IMGUI_EX_TEST(TestStaleProgressIgnored);
+    return TestExitCode();
+}
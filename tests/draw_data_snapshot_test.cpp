@@ -0,0 +1,151 @@
+// DrawDataSnapshot: a copied frame stays intact while the UI thread builds the next ones
+#include "imgui_ex_test.h"
+
+#include <condition_variable>
+
+using ImGuiEx::internal::DrawDataSnapshot;
+
+static uint64_t Mix(uint64_t hash, const void* data, size_t size)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    return hash;
+}
+
+// Everything a renderer reads from the draw data
+static uint64_t Hash(const ImDrawData* draw_data)
+{
+    uint64_t hash = 14695981039346656037ull;
+    hash = Mix(hash, &draw_data->CmdListsCount, sizeof(int));
+    hash = Mix(hash, &draw_data->TotalVtxCount, sizeof(int));
+    hash = Mix(hash, &draw_data->DisplaySize, sizeof(ImVec2));
+    for (int i = 0; i < draw_data->CmdListsCount; i++)
+    {
+        const ImDrawList* list = draw_data->CmdLists[i];
+        hash = Mix(hash, list->VtxBuffer.Data, (size_t)list->VtxBuffer.Size * sizeof(ImDrawVert));
+        hash = Mix(hash, list->IdxBuffer.Data, (size_t)list->IdxBuffer.Size * sizeof(ImDrawIdx));
+        for (const ImDrawCmd& cmd : list->CmdBuffer)
+        {
+            hash = Mix(hash, &cmd.ClipRect, sizeof(ImVec4));
+            hash = Mix(hash, &cmd.VtxOffset, sizeof(unsigned int));
+            hash = Mix(hash, &cmd.IdxOffset, sizeof(unsigned int));
+            hash = Mix(hash, &cmd.ElemCount, sizeof(unsigned int));
+        }
+    }
+    return hash;
+}
+
+// A different number of windows and lines every frame, so the copies grow and shrink
+static ImDrawData* RenderFrame(int frame)
+{
+    ImGui::NewFrame();
+    for (int w = 0; w <= frame % 3; w++)
+    {
+        ImGui::SetNextWindowPos(ImVec2(20.0f * w, 30.0f * w));
+        ImGui::Begin(("Window " + std::to_string(w)).c_str());
+        for (int line = 0; line < 1 + (frame * 7 + w) % 20; line++)
+            ImGui::Text("Frame %d line %d", frame, line);
+        ImGui::End();
+    }
+    ImGui::Render();
+    return ImGui::GetDrawData();
+}
+
+// Copies are independent of the frames rendered after them, and of each other
+static void TestCopySurvivesNextFrames()
+{
+    TestContext context;
+    DrawDataSnapshot snapshot;
+    ImDrawData* draw_data = RenderFrame(0);
+    const uint64_t expected = Hash(draw_data);
+    snapshot.Copy(draw_data);
+    IMGUI_EX_CHECK(Hash(snapshot.Get()) == expected);
+    IMGUI_EX_CHECK(snapshot.Get()->OwnerViewport == nullptr);
+    for (int frame = 1; frame < 5; frame++)
+        RenderFrame(frame);
+    IMGUI_EX_CHECK(Hash(snapshot.Get()) == expected);
+
+    // A smaller frame into the same snapshot keeps no lists of the bigger one
+    snapshot.Copy(RenderFrame(2));
+    const int bigger = snapshot.Get()->CmdListsCount;
+    snapshot.Copy(RenderFrame(0));
+    IMGUI_EX_CHECK(snapshot.Get()->CmdListsCount < bigger);
+    IMGUI_EX_CHECK(Hash(snapshot.Get()) == Hash(ImGui::GetDrawData()));
+
+    snapshot.Clear();
+    IMGUI_EX_CHECK(snapshot.Get()->CmdListsCount == 0);
+}
+
+// Two slots as in the pipelined renderer: the consumer hashes one while the producer fills the other
+static void TestHandoff()
+{
+    TestContext context;
+    DrawDataSnapshot slots[2];
+    uint64_t expected[2] = {};
+    int pending = -1;
+    int active = -1;
+    bool stop = false;
+    std::mutex mutex;
+    std::condition_variable cv;
+    int consumed = 0;
+    int mismatches = 0;
+
+    std::thread consumer([&]() {
+        for (;;)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&]() { return stop || pending != -1; });
+            if (pending == -1)
+                return;
+            active = pending;
+            pending = -1;
+            lock.unlock();
+            cv.notify_all();
+
+            // The producer is free to run the next frame meanwhile
+            const bool same = Hash(slots[active].Get()) == expected[active];
+            std::this_thread::yield();
+            lock.lock();
+            mismatches += same ? 0 : 1;
+            consumed++;
+            active = -1;
+            lock.unlock();
+            cv.notify_all();
+        }
+    });
+
+    const int frames = 200;
+    for (int frame = 0; frame < frames; frame++)
+    {
+        ImDrawData* draw_data = RenderFrame(frame);
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&]() { return pending == -1; });
+        const int slot = active == 0 ? 1 : 0;
+        lock.unlock();
+
+        slots[slot].Copy(draw_data);
+        expected[slot] = Hash(draw_data);
+
+        lock.lock();
+        pending = slot;
+        lock.unlock();
+        cv.notify_all();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    cv.notify_all();
+    consumer.join();
+
+    IMGUI_EX_CHECK(consumed >= 1);
+    IMGUI_EX_CHECK(mismatches == 0);
+}
+
+int main()
+{
+    IMGUI_EX_TEST(TestCopySurvivesNextFrames);
+    IMGUI_EX_TEST(TestHandoff);
+    return TestExitCode();
+}
@@ -0,0 +1,252 @@
+// DrawStreamEncoder and DrawStreamDecoder: round trips, the Same/Delta/Full list modes, and messages the viewer refuses
+#include "imgui_ex_test.h"
+
+using ImGuiEx::internal::DrawStreamCmd;
+using ImGuiEx::internal::DrawStreamDecoder;
+using ImGuiEx::internal::DrawStreamEncoder;
+using ImGuiEx::internal::DrawStreamHeader;
+using ImGuiEx::internal::DrawStreamList_Delta;
+using ImGuiEx::internal::DrawStreamList_Full;
+using ImGuiEx::internal::DrawStreamList_Same;
+
+static const ImTextureID kFontTexture = (ImTextureID)(intptr_t)0x1000;
+
+// Draw lists filled by hand, one quad per row and one command per list
+struct Scene
+{
+    std::vector<std::unique_ptr<ImDrawList>> lists;
+    ImDrawData draw_data;
+
+    Scene(int count)
+    {
+        for (int i = 0; i < count; i++)
+            lists.push_back(std::make_unique<ImDrawList>(ImGui::GetDrawListSharedData()));
+    }
+
+    void Fill(int list, int quads, float x)
+    {
+        ImDrawList& draw_list = *lists[list];
+        draw_list.CmdBuffer.resize(0);
+        draw_list.VtxBuffer.resize(0);
+        draw_list.IdxBuffer.resize(0);
+        for (int q = 0; q < quads; q++)
+        {
+            const ImDrawIdx base = (ImDrawIdx)draw_list.VtxBuffer.Size;
+            const float y = 20.0f * q + list;
+            const ImVec2 corners[4] = { ImVec2(x, y), ImVec2(x + 100.0f, y), ImVec2(x + 100.0f, y + 16.0f), ImVec2(x, y + 16.0f) };
+            for (int c = 0; c < 4; c++)
+            {
+                ImDrawVert vert;
+                vert.pos = corners[c];
+                vert.uv = ImVec2(c == 1 || c == 2 ? 1.0f : 0.0f, c >= 2 ? 1.0f : 0.0f);
+                vert.col = 0xFF000000u | (ImU32)(q * 2654435761u >> 8);
+                draw_list.VtxBuffer.push_back(vert);
+            }
+            const ImDrawIdx indices[6] = { base, (ImDrawIdx)(base + 1), (ImDrawIdx)(base + 2), base, (ImDrawIdx)(base + 2), (ImDrawIdx)(base + 3) };
+            for (ImDrawIdx index : indices)
+                draw_list.IdxBuffer.push_back(index);
+        }
+        ImDrawCmd cmd;
+        cmd.ClipRect = ImVec4(0.0f, 0.0f, 1280.0f, 720.0f);
+        cmd.TextureId = kFontTexture;
+        cmd.VtxOffset = 0;
+        cmd.IdxOffset = 0;
+        cmd.ElemCount = (unsigned int)draw_list.IdxBuffer.Size;
+        draw_list.CmdBuffer.push_back(cmd);
+    }
+
+    // The first count lists make the frame
+    const ImDrawData* Get(int count)
+    {
+        draw_data.Valid = true;
+        draw_data.CmdLists.resize(0);
+        draw_data.TotalVtxCount = 0;
+        draw_data.TotalIdxCount = 0;
+        for (int i = 0; i < count; i++)
+        {
+            draw_data.CmdLists.push_back(lists[i].get());
+            draw_data.TotalVtxCount += lists[i]->VtxBuffer.Size;
+            draw_data.TotalIdxCount += lists[i]->IdxBuffer.Size;
+        }
+        draw_data.CmdListsCount = count;
+        draw_data.DisplayPos = ImVec2(0.0f, 0.0f);
+        draw_data.DisplaySize = ImVec2(1280.0f, 720.0f);
+        draw_data.FramebufferScale = ImVec2(1.0f, 1.0f);
+        return &draw_data;
+    }
+};
+
+static bool SameDrawData(const ImDrawData* a, const ImDrawData* b)
+{
+    if (a == nullptr || b == nullptr || a->CmdListsCount != b->CmdListsCount || a->TotalVtxCount != b->TotalVtxCount ||
+        a->DisplaySize.x != b->DisplaySize.x || a->DisplaySize.y != b->DisplaySize.y)
+        return false;
+    for (int i = 0; i < a->CmdListsCount; i++)
+    {
+        const ImDrawList* x = a->CmdLists[i];
+        const ImDrawList* y = b->CmdLists[i];
+        if (x->VtxBuffer.Size != y->VtxBuffer.Size || x->IdxBuffer.Size != y->IdxBuffer.Size || x->CmdBuffer.Size != y->CmdBuffer.Size)
+            return false;
+        if (memcmp(x->VtxBuffer.Data, y->VtxBuffer.Data, (size_t)x->VtxBuffer.Size * sizeof(ImDrawVert)) != 0 ||
+            memcmp(x->IdxBuffer.Data, y->IdxBuffer.Data, (size_t)x->IdxBuffer.Size * sizeof(ImDrawIdx)) != 0)
+            return false;
+        for (int c = 0; c < x->CmdBuffer.Size; c++)
+        {
+            const ImDrawCmd& p = x->CmdBuffer[c];
+            const ImDrawCmd& q = y->CmdBuffer[c];
+            if (memcmp(&p.ClipRect, &q.ClipRect, sizeof(ImVec4)) != 0 || p.TextureId != q.TextureId || p.VtxOffset != q.VtxOffset ||
+                p.IdxOffset != q.IdxOffset || p.ElemCount != q.ElemCount)
+                return false;
+        }
+    }
+    return true;
+}
+
+// The mode byte of the first list follows the header
+static uint8_t FirstListMode(const std::vector<uint8_t>& message)
+{
+    return message[sizeof(DrawStreamHeader)];
+}
+
+static void TestRoundTrip()
+{
+    TestContext context;
+    Scene scene(3);
+    for (int i = 0; i < 3; i++)
+        scene.Fill(i, 40 + i * 10, 10.0f);
+    DrawStreamEncoder encoder;
+    DrawStreamDecoder decoder;
+    decoder.SetFontTexture(kFontTexture);
+    std::vector<uint8_t> message;
+
+    for (int frame = 0; frame < 20; frame++)
+    {
+        // One list scrolls, one grows every few frames, one stays as it is
+        scene.Fill(0, 40, 10.0f + frame);
+        if (frame % 4 == 0)
+            scene.Fill(1, 50 + frame, 10.0f);
+        encoder.Encode(scene.Get(3), kFontTexture, message);
+        IMGUI_EX_CHECK(decoder.Decode(message.data(), message.size()));
+        IMGUI_EX_CHECK(SameDrawData(decoder.Get(), scene.Get(3)));
+    }
+    IMGUI_EX_CHECK(encoder.GetStats().lists_skipped == 2);
+    IMGUI_EX_CHECK(encoder.GetStats().compression_ratio > 1.0);
+    IMGUI_EX_CHECK(decoder.GetStats().frames == 20);
+}
+
+// Full for a list the viewer has not seen, Same when nothing changed, Delta against the previous frame
+static void TestListModes()
+{
+    TestContext context;
+    Scene scene(3);
+    for (int i = 0; i < 3; i++)
+        scene.Fill(i, 30, 10.0f);
+    DrawStreamEncoder encoder;
+    DrawStreamDecoder decoder;
+    decoder.SetFontTexture(kFontTexture);
+    std::vector<uint8_t> message;
+
+    encoder.Encode(scene.Get(2), kFontTexture, message);
+    IMGUI_EX_CHECK(FirstListMode(message) == DrawStreamList_Full);
+    IMGUI_EX_CHECK(decoder.Decode(message.data(), message.size()));
+    const size_t full_size = message.size();
+
+    encoder.Encode(scene.Get(2), kFontTexture, message);
+    IMGUI_EX_CHECK(FirstListMode(message) == DrawStreamList_Same);
+    IMGUI_EX_CHECK(encoder.GetStats().lists_skipped == 2);
+    IMGUI_EX_CHECK(decoder.Decode(message.data(), message.size()));
+    IMGUI_EX_CHECK(SameDrawData(decoder.Get(), scene.Get(2)));
+
+    // A moved quad: a delta, smaller than the full list
+    scene.Fill(0, 30, 12.0f);
+    encoder.Encode(scene.Get(2), kFontTexture, message);
+    IMGUI_EX_CHECK(FirstListMode(message) == DrawStreamList_Delta);
+    IMGUI_EX_CHECK(message.size() < full_size);
+    IMGUI_EX_CHECK(decoder.Decode(message.data(), message.size()));
+    IMGUI_EX_CHECK(SameDrawData(decoder.Get(), scene.Get(2)));
+
+    // A third list appears, then the frame shrinks back to one
+    encoder.Encode(scene.Get(3), kFontTexture, message);
+    IMGUI_EX_CHECK(decoder.Decode(message.data(), message.size()));
+    IMGUI_EX_CHECK(SameDrawData(decoder.Get(), scene.Get(3)));
+    encoder.Encode(scene.Get(1), kFontTexture, message);
+    IMGUI_EX_CHECK(decoder.Decode(message.data(), message.size()));
+    IMGUI_EX_CHECK(SameDrawData(decoder.Get(), scene.Get(1)));
+
+    // A viewer that joins now cannot apply Same or Delta, Reset sends everything again
+    DrawStreamDecoder late;
+    late.SetFontTexture(kFontTexture);
+    encoder.Encode(scene.Get(1), kFontTexture, message);
+    IMGUI_EX_CHECK(!late.Decode(message.data(), message.size()));
+    encoder.Reset();
+    encoder.Encode(scene.Get(1), kFontTexture, message);
+    IMGUI_EX_CHECK(FirstListMode(message) == DrawStreamList_Full);
+    IMGUI_EX_CHECK(late.Decode(message.data(), message.size()));
+    IMGUI_EX_CHECK(SameDrawData(late.Get(), scene.Get(1)));
+}
+
+// Every prefix of a message is refused, and so are a foreign magic, an unknown mode and a lying buffer size
+static void TestRejectsBadMessages()
+{
+    TestContext context;
+    Scene scene(2);
+    scene.Fill(0, 20, 10.0f);
+    scene.Fill(1, 25, 10.0f);
+    DrawStreamEncoder encoder;
+    std::vector<uint8_t> full;
+    encoder.Encode(scene.Get(2), kFontTexture, full);
+    scene.Fill(0, 20, 14.0f);
+    std::vector<uint8_t> delta;
+    encoder.Encode(scene.Get(2), kFontTexture, delta);
+    IMGUI_EX_CHECK(FirstListMode(delta) == DrawStreamList_Delta);
+
+    DrawStreamDecoder decoder;
+    decoder.SetFontTexture(kFontTexture);
+    for (size_t size = 0; size < full.size(); size++)
+    {
+        IMGUI_EX_CHECK(!decoder.Decode(full.data(), size));
+        IMGUI_EX_CHECK(decoder.Get() == nullptr);
+    }
+    IMGUI_EX_CHECK(decoder.Decode(full.data(), full.size()));
+
+    std::vector<uint8_t> bad = full;
+    bad[0] ^= 0xFF;
+    IMGUI_EX_CHECK(!decoder.Decode(bad.data(), bad.size()));
+
+    // A mode past Full on a list the viewer holds
+    IMGUI_EX_CHECK(decoder.Decode(full.data(), full.size()));
+    bad = delta;
+    bad[sizeof(DrawStreamHeader)] = DrawStreamList_Full + 1;
+    IMGUI_EX_CHECK(!decoder.Decode(bad.data(), bad.size()));
+    // The failure dropped the lists, a delta needs a full message first
+    IMGUI_EX_CHECK(decoder.Get() == nullptr);
+    IMGUI_EX_CHECK(!decoder.Decode(delta.data(), delta.size()));
+
+    // The vertex buffer claims more bytes than the message holds
+    const size_t counts = sizeof(DrawStreamHeader) + 1;
+    uint32_t cmd_count;
+    memcpy(&cmd_count, &full[counts], sizeof(cmd_count));
+    const size_t vtx_buffer = counts + 3 * sizeof(uint32_t) + cmd_count * sizeof(DrawStreamCmd);
+    bad = full;
+    const uint32_t huge = 0x7FFFFFFF;
+    memcpy(&bad[vtx_buffer], &huge, sizeof(huge));
+    IMGUI_EX_CHECK(!decoder.Decode(bad.data(), bad.size()));
+
+    // A command past the indices is dropped, the message itself is fine
+    bad = full;
+    DrawStreamCmd cmd;
+    memcpy(&cmd, &bad[counts + 3 * sizeof(uint32_t)], sizeof(cmd));
+    cmd.elem_count = 0x7FFFFFFF;
+    memcpy(&bad[counts + 3 * sizeof(uint32_t)], &cmd, sizeof(cmd));
+    IMGUI_EX_CHECK(decoder.Decode(bad.data(), bad.size()));
+    IMGUI_EX_CHECK(decoder.Get()->CmdLists[0]->CmdBuffer.Size == 0);
+    IMGUI_EX_CHECK(decoder.Get()->CmdLists[1]->CmdBuffer.Size == 1);
+}
+
+int main()
+{
+    IMGUI_EX_TEST(TestRoundTrip);
+    IMGUI_EX_TEST(TestListModes);
+    IMGUI_EX_TEST(TestRejectsBadMessages);
+    return TestExitCode();
+}
@@ -0,0 +1,99 @@
+// FindSubstring: the SSE2 blocks must find what FindSubstringScalar finds, at every position
+#include "imgui_ex_test.h"
+
+using ImGuiEx::internal::FindSubstring;
+using ImGuiEx::internal::FindSubstringScalar;
+
+static int gs_compared = 0;
+
+// Copies the haystack to a heap block of exactly its size, so reads past the end leave the allocation
+static void CheckSame(const std::string& hay, const std::string& needle)
+{
+    std::unique_ptr<char[]> buffer(new char[hay.size() + 1]);
+    char* begin = buffer.get() + 1;
+    memcpy(begin, hay.data(), hay.size());
+    const char* fast = FindSubstring(begin, hay.size(), needle.data(), needle.size());
+    const char* scalar = FindSubstringScalar(begin, hay.size(), needle.data(), needle.size());
+    const size_t expected = hay.find(needle);
+    gs_compared++;
+    const bool same = fast == scalar && (expected == std::string::npos ? scalar == nullptr : scalar == begin + expected);
+    if (!same)
+        fprintf(stderr, "  mismatch: hay %d bytes, needle \"%s\", fast %d scalar %d find %d\n", (int)hay.size(), needle.c_str(),
+            fast ? (int)(fast - begin) : -1, scalar ? (int)(scalar - begin) : -1, expected == std::string::npos ? -1 : (int)expected);
+    IMGUI_EX_CHECK(same);
+}
+
+// Every needle length at every position of haystacks around the 16 byte blocks, including the last byte
+static void TestEveryPosition()
+{
+    for (int hay_len = 0; hay_len <= 50; hay_len++)
+    {
+        const std::string filler(hay_len, 'a');
+        for (int needle_len = 1; needle_len <= 20; needle_len++)
+        {
+            std::string needle(needle_len, 'b');
+            needle[0] = 'x';
+            needle[needle_len - 1] = 'y';
+            CheckSame(filler, needle);
+            for (int at = 0; at + needle_len <= hay_len; at++)
+            {
+                std::string hay = filler;
+                hay.replace(at, needle_len, needle);
+                CheckSame(hay, needle);
+            }
+        }
+    }
+}
+
+// First and last byte match but the middle does not, the real hit comes later or never
+static void TestNearMisses()
+{
+    for (int hay_len = 0; hay_len <= 50; hay_len++)
+    {
+        for (int needle_len = 3; needle_len <= 18; needle_len++)
+        {
+            std::string needle(needle_len, 'm');
+            needle[0] = 'x';
+            needle[needle_len - 1] = 'y';
+            std::string decoy = needle;
+            decoy[needle_len / 2] = 'q';
+            std::string hay;
+            while ((int)hay.size() < hay_len)
+                hay += decoy;
+            hay.resize(hay_len);
+            CheckSame(hay, needle);
+            for (int at = 0; at + needle_len <= hay_len; at++)
+            {
+                std::string with_hit = hay;
+                with_hit.replace(at, needle_len, needle);
+                CheckSame(with_hit, needle);
+            }
+        }
+    }
+}
+
+// Repeated bytes, the first of overlapping hits wins; empty and too long needles
+static void TestEdges()
+{
+    CheckSame("", "");
+    CheckSame("abc", "");
+    CheckSame("ab", "abc");
+    CheckSame(std::string(40, 'a'), "aa");
+    CheckSame(std::string(40, 'a'), "a");
+    CheckSame(std::string(33, 'a') + "b", std::string(17, 'a') + "b");
+    CheckSame(std::string("item 1\0item 12\0item 123", 23), "item 123");
+    std::string bytes;
+    for (int i = 0; i < 64; i++)
+        bytes.push_back((char)(0xc0 + i % 8));
+    CheckSame(bytes, "\xc3\xc4\xc5");
+    CheckSame(bytes, "\xc7\xc0");
+}
+
+int main()
+{
+    IMGUI_EX_TEST(TestEveryPosition);
+    IMGUI_EX_TEST(TestNearMisses);
+    IMGUI_EX_TEST(TestEdges);
+    printf("%d searches compared\n", gs_compared);
+    return TestExitCode();
+}
@@ -0,0 +1,117 @@
+#ifndef IMGUI_EX_TESTS_IMGUI_EX_TEST_H_
+#define IMGUI_EX_TESTS_IMGUI_EX_TEST_H_
+
+/*
+* Test support
+* Each test is one translation unit that builds ImGui and ImGuiEx the way imgui_ex_win32.cpp does, without a backend.
+* Build from the directory holding imgui/ and imgui_ex/, no Windows SDK is needed:
+*
+*   g++ -std=c++17 -O2 -pthread -I. imgui_ex/tests/overlay_test.cpp -o overlay_test && ./overlay_test
+*   cl /std:c++17 /O2 /EHsc /I. imgui_ex\tests\overlay_test.cpp && overlay_test.exe
+*
+* Every failed check is printed with its line, the exit code is 1 when any failed.
+*/
+#ifdef IMGUI_EX_UI_DRIVER
+#define IMGUI_ENABLE_TEST_ENGINE
+#endif
+#include <imgui/imgui.cpp>
+#include <imgui/imgui_draw.cpp>
+#include <imgui/imgui_tables.cpp>
+#include <imgui/imgui_widgets.cpp>
+
+#define IMGUI_EX_CPP
+#include <imgui_ex/imgui_ex_win32.h>
+
+static int gs_test_failures = 0;
+
+#define IMGUI_EX_CHECK(expr) \
+    do { if (!(expr)) { gs_test_failures++; fprintf(stderr, "%s(%d): check failed: %s\n", __FILE__, __LINE__, #expr); } } while (0)
+
+// The name goes out first so a crash points at the test
+#define IMGUI_EX_TEST(fn) \
+    do { printf("%s\n", #fn); fflush(stdout); fn(); } while (0)
+
+static int TestExitCode()
+{
+    if (gs_test_failures != 0)
+    {
+        printf("%d checks failed\n", gs_test_failures);
+        return 1;
+    }
+    printf("passed\n");
+    return 0;
+}
+
+// Headless context with a built font atlas, the previous context is current again once it goes out of scope
+struct TestContext
+{
+    ImGuiContext* previous;
+    ImGuiContext* context;
+
+    TestContext()
+    {
+        previous = ImGui::GetCurrentContext();
+        context = ImGui::CreateContext();
+        ImGui::SetCurrentContext(context);
+        ImGuiIO& io = ImGui::GetIO();
+        io.IniFilename = nullptr;
+        io.LogFilename = nullptr;
+        io.DisplaySize = ImVec2(1280.0f, 720.0f);
+        io.DeltaTime = 1.0f / 60.0f;
+        unsigned char* pixels;
+        int width, height;
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    }
+
+    ~TestContext()
+    {
+        ImGui::DestroyContext(context);
+        ImGui::SetCurrentContext(previous);
+    }
+};
+
+// What imgui_ex_win32.cpp provides to the header, without the application around it
+namespace ImGuiEx {
+
+void ExitApplication() {
+}
+
+void SlowDown() {
+}
+
+internal::WorkerPool& GetWorkerPool() {
+    static internal::WorkerPool pool(2);
+    return pool;
+}
+
+internal::FrameArena& GetFrameArena() {
+    static internal::FrameArena arena;
+    return arena;
+}
+
+} // namespace ImGuiEx
+
+#ifdef IMGUI_EX_UI_DRIVER
+void ImGuiTestEngineHook_ItemAdd(ImGuiContext* ctx, ImGuiID id, const ImRect& bb, const ImGuiLastItemData* item_data)
+{
+    if (ctx->TestEngine != nullptr)
+        ((ImGuiEx::UiDriver*)ctx->TestEngine)->ItemAdd(id, bb);
+}
+
+void ImGuiTestEngineHook_ItemInfo(ImGuiContext* ctx, ImGuiID id, const char* label, ImGuiItemStatusFlags flags)
+{
+    if (ctx->TestEngine != nullptr)
+        ((ImGuiEx::UiDriver*)ctx->TestEngine)->ItemInfo(id, label);
+}
+
+void ImGuiTestEngineHook_Log(ImGuiContext* ctx, const char* fmt, ...)
+{
+}
+
+const char* ImGuiTestEngine_FindItemDebugLabel(ImGuiContext* ctx, ImGuiID id)
+{
+    return nullptr;
+}
+#endif
+
+#endif // IMGUI_EX_TESTS_IMGUI_EX_TEST_H_
@@ -0,0 +1,145 @@
+// InputCoalescer: what is folded, what goes out right away, and in which order
+#include "imgui_ex_test.h"
+
+using ImGuiEx::InputMessage;
+using ImGuiEx::internal::InputCoalescer;
+
+// Win32 message numbers, the coalescer only compares them
+static const uint32_t kMouseMove = 0x0200;
+static const uint32_t kLeftButtonDown = 0x0201;
+static const uint32_t kMouseWheel = 0x020A;
+static const uint32_t kKeyDown = 0x0100;
+
+static void* const kWindowA = (void*)0x10;
+static void* const kWindowB = (void*)0x20;
+
+static InputMessage Move(void* window, int x, int y, uintptr_t buttons = 0, uint32_t time = 0)
+{
+    return InputMessage{ window, kMouseMove, buttons, (intptr_t)((y << 16) | x), time, 1000 + x, 1000 + y, ImGuiEx::InputMessageKind_MouseMove };
+}
+
+static InputMessage Wheel(void* window, int delta, uintptr_t keys = 0)
+{
+    return InputMessage{ window, kMouseWheel, ((uintptr_t)(uint16_t)(int16_t)delta << 16) | keys, 0, 0, 0, 0, ImGuiEx::InputMessageKind_MouseWheel };
+}
+
+static InputMessage Other(void* window, uint32_t message, uintptr_t wparam = 0)
+{
+    return InputMessage{ window, message, wparam, 0, 0, 0, 0, ImGuiEx::InputMessageKind_Other };
+}
+
+static int WheelDelta(const InputMessage& message)
+{
+    return (int)(int16_t)(uint16_t)(message.wparam >> 16);
+}
+
+// Other messages are dispatched while they are pushed, held moves go out first
+static void TestOtherDispatchedImmediately()
+{
+    InputCoalescer coalescer;
+    std::vector<InputMessage> dispatched;
+    auto dispatch = [&](const InputMessage& message) { dispatched.push_back(message); };
+
+    coalescer.Push(Other(kWindowA, kKeyDown, 'A'), dispatch);
+    IMGUI_EX_CHECK(dispatched.size() == 1);
+
+    coalescer.Push(Move(kWindowA, 1, 1), dispatch);
+    coalescer.Push(Move(kWindowA, 2, 2, 0, 20), dispatch);
+    IMGUI_EX_CHECK(dispatched.size() == 1);
+
+    coalescer.Push(Other(kWindowA, kLeftButtonDown, 1), dispatch);
+    IMGUI_EX_CHECK(dispatched.size() == 3);
+    IMGUI_EX_CHECK(dispatched[1].message == kMouseMove && dispatched[1].lparam == ((2 << 16) | 2));
+    IMGUI_EX_CHECK(dispatched[1].x == 1002 && dispatched[1].y == 1002 && dispatched[1].time == 20);
+    IMGUI_EX_CHECK(dispatched[2].message == kLeftButtonDown);
+
+    coalescer.Flush(dispatch);
+    IMGUI_EX_CHECK(dispatched.size() == 3);
+    IMGUI_EX_CHECK(coalescer.GetStats().received == 4);
+    IMGUI_EX_CHECK(coalescer.GetStats().dispatched == 3);
+}
+
+static void TestMovesFold()
+{
+    InputCoalescer coalescer;
+    std::vector<InputMessage> dispatched;
+    auto dispatch = [&](const InputMessage& message) { dispatched.push_back(message); };
+
+    for (int i = 0; i < 100; i++)
+        coalescer.Push(Move(kWindowA, i, i), dispatch);
+    // Button state changed in between: stays apart
+    coalescer.Push(Move(kWindowA, 200, 200, 1), dispatch);
+    coalescer.Push(Move(kWindowA, 201, 201, 1), dispatch);
+    // Another window: stays apart
+    coalescer.Push(Move(kWindowB, 5, 5, 1), dispatch);
+    IMGUI_EX_CHECK(dispatched.empty());
+    coalescer.Flush(dispatch);
+
+    IMGUI_EX_CHECK(dispatched.size() == 3);
+    if (dispatched.size() == 3)
+    {
+        IMGUI_EX_CHECK(dispatched[0].lparam == ((99 << 16) | 99) && dispatched[0].wparam == 0);
+        IMGUI_EX_CHECK(dispatched[1].lparam == ((201 << 16) | 201) && dispatched[1].wparam == 1);
+        IMGUI_EX_CHECK(dispatched[2].window == kWindowB);
+    }
+    IMGUI_EX_CHECK(coalescer.GetStats().received == 103);
+    IMGUI_EX_CHECK(coalescer.GetStats().dispatched == 3);
+
+    // Stats are per flush
+    coalescer.Flush(dispatch);
+    IMGUI_EX_CHECK(coalescer.GetStats().received == 0 && coalescer.GetStats().dispatched == 0);
+}
+
+static void TestWheelSums()
+{
+    InputCoalescer coalescer;
+    std::vector<InputMessage> dispatched;
+    auto dispatch = [&](const InputMessage& message) { dispatched.push_back(message); };
+
+    coalescer.Push(Wheel(kWindowA, 120), dispatch);
+    coalescer.Push(Wheel(kWindowA, 120), dispatch);
+    coalescer.Push(Wheel(kWindowA, -60), dispatch);
+    // Ctrl held: a different key state stays apart
+    coalescer.Push(Wheel(kWindowA, 120, 0x0008), dispatch);
+    // Saturates instead of wrapping
+    for (int i = 0; i < 400; i++)
+        coalescer.Push(Wheel(kWindowB, 120), dispatch);
+    coalescer.Flush(dispatch);
+
+    IMGUI_EX_CHECK(dispatched.size() == 3);
+    if (dispatched.size() == 3)
+    {
+        IMGUI_EX_CHECK(WheelDelta(dispatched[0]) == 180);
+        IMGUI_EX_CHECK(WheelDelta(dispatched[1]) == 120 && (dispatched[1].wparam & 0xffff) == 0x0008);
+        IMGUI_EX_CHECK(WheelDelta(dispatched[2]) == 32767);
+    }
+}
+
+// A move and a wheel tick in between keep each other apart, order is kept
+static void TestMixedOrder()
+{
+    InputCoalescer coalescer;
+    std::vector<InputMessage> dispatched;
+    auto dispatch = [&](const InputMessage& message) { dispatched.push_back(message); };
+
+    coalescer.Push(Move(kWindowA, 1, 1), dispatch);
+    coalescer.Push(Wheel(kWindowA, 120), dispatch);
+    coalescer.Push(Move(kWindowA, 2, 2), dispatch);
+    coalescer.Push(Other(kWindowA, kKeyDown, 'B'), dispatch);
+    coalescer.Push(Move(kWindowA, 3, 3), dispatch);
+    coalescer.Flush(dispatch);
+
+    const uint32_t expected[] = { kMouseMove, kMouseWheel, kMouseMove, kKeyDown, kMouseMove };
+    IMGUI_EX_CHECK(dispatched.size() == 5);
+    for (size_t i = 0; i < dispatched.size() && i < 5; i++)
+        IMGUI_EX_CHECK(dispatched[i].message == expected[i]);
+}
+
+int main()
+{
+    IMGUI_EX_TEST(TestOtherDispatchedImmediately);
+    IMGUI_EX_TEST(TestMovesFold);
+    IMGUI_EX_TEST(TestWheelSums);
+    IMGUI_EX_TEST(TestMixedOrder);
+    return TestExitCode();
+}
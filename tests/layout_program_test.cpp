@@ -0,0 +1,66 @@
+// LayoutProgram: a failed load leaves the running program and its widgets alone
+#include "imgui_ex_test.h"
+
+static void TestFailedLoadKeepsWidgets()
+{
+    ImGuiEx::LayoutProgram program;
+    IMGUI_EX_CHECK(program.Load("window \"Tools\" move=1 top=1\n    button \"Run\"\nend\n"));
+    ImGuiEx::Window* window = program.Find<ImGuiEx::Window>("Tools");
+    IMGUI_EX_CHECK(window != nullptr);
+    if (window == nullptr)
+        return;
+    const ImGuiWindowFlags flags = window->GetFlags();
+
+    // The options come before the error, none of them may reach the kept window
+    IMGUI_EX_CHECK(!program.Load("window \"Tools\" move=0 top=0 flags=1 disabled=1\n    button \"Run\"\n    bogus \"x\"\nend\n"));
+    IMGUI_EX_CHECK(program.GetError().rfind("line 3", 0) == 0);
+    IMGUI_EX_CHECK(!program.Load("window \"Tools\" move=0 top=0\n    button \"Run\"\n"));
+    IMGUI_EX_CHECK(program.Find<ImGuiEx::Window>("Tools") == window);
+    IMGUI_EX_CHECK(window->GetFlags() == flags);
+    IMGUI_EX_CHECK(window->GetTop());
+    IMGUI_EX_CHECK(program.GetStats().loads == 1);
+
+    // A load that compiles applies them
+    IMGUI_EX_CHECK(program.Load("window \"Tools\" move=0 top=0\n    button \"Run\"\nend\n"));
+    IMGUI_EX_CHECK((window->GetFlags() & ImGuiWindowFlags_NoMove) != 0);
+    IMGUI_EX_CHECK(!window->GetTop());
+    IMGUI_EX_CHECK(program.GetStats().reused == 2);
+    IMGUI_EX_CHECK(program.GetStats().created == 0);
+}
+
+// Every statement compiles and constructs its widget
+static void TestAllStatements()
+{
+    ImGuiEx::LayoutProgram program;
+    const char* source =
+        "window \"Tools\" docking=0 collapse=0 autoresize=1\n"
+        "    text \"Status\"\n"
+        "    bullet \"Point\"\n"
+        "    separator \"Section\"\n"
+        "    button \"Run\" disabled=1\n"
+        "    sameline\n"
+        "    checkbox \"Verbose\" check=1\n"
+        "    header \"Advanced\"\n"
+        "        input \"Path\" 260\n"
+        "        help \"(?)\" \"Where the output goes\"\n"
+        "        tree \"More\"\n"
+        "            indent\n"
+        "            spacing\n"
+        "            unindent\n"
+        "        end\n"
+        "    end\n"
+        "end\n";
+    IMGUI_EX_CHECK(program.Load(source));
+    IMGUI_EX_CHECK(program.GetStats().widgets == 10);
+    IMGUI_EX_CHECK(program.Find<ImGuiEx::BulletText>("Tools/Point") != nullptr);
+    IMGUI_EX_CHECK(program.Find<ImGuiEx::CheckBox>("Tools/Verbose") != nullptr && program.Find<ImGuiEx::CheckBox>("Tools/Verbose")->GetCheck());
+    IMGUI_EX_CHECK(program.Find<ImGuiEx::Button>("Tools/Verbose") == nullptr);
+    IMGUI_EX_CHECK(program.Find<ImGuiEx::InputText>("Tools/Advanced/Path") != nullptr);
+}
+
+int main()
+{
+    IMGUI_EX_TEST(TestFailedLoadKeepsWidgets);
+    IMGUI_EX_TEST(TestAllStatements);
+    return TestExitCode();
+}
@@ -0,0 +1,153 @@
+// OverlayRegions: interactive regions, dirty rects and when the layout is rebuilt
+#include "imgui_ex_test.h"
+
+using ImGuiEx::internal::OverlayRegions;
+
+static void FeedTwoWindows(OverlayRegions& regions, uint64_t content_key)
+{
+    regions.BeginFrame();
+    regions.AddWindow(1, ImRect(0.0f, 0.0f, 100.0f, 100.0f), content_key, true);
+    regions.AddWindow(2, ImRect(200.0f, 0.0f, 300.0f, 100.0f), 7, true);
+    regions.EndFrame();
+}
+
+static void TestRegionsHitTest()
+{
+    OverlayRegions regions;
+    regions.BeginFrame();
+    regions.AddWindow(1, ImRect(0.0f, 0.0f, 100.0f, 100.0f), 0, true);
+    regions.AddWindow(2, ImRect(10.0f, 10.0f, 50.0f, 50.0f), 0, true);         // enclosed by 1
+    regions.AddWindow(3, ImRect(500.0f, 500.0f, 600.0f, 600.0f), 0, false);    // click-through
+    regions.AddWindow(4, ImRect(150.0f, 0.0f, 250.0f, 80.0f), 0, true);
+    regions.EndFrame();
+
+    IMGUI_EX_CHECK(regions.GetRegions().size() == 2);
+    IMGUI_EX_CHECK(regions.HitTest(ImVec2(20.0f, 20.0f)));
+    IMGUI_EX_CHECK(regions.HitTest(ImVec2(200.0f, 40.0f)));
+    IMGUI_EX_CHECK(!regions.HitTest(ImVec2(120.0f, 40.0f)));
+    IMGUI_EX_CHECK(!regions.HitTest(ImVec2(550.0f, 550.0f)));
+    // Max is exclusive
+    IMGUI_EX_CHECK(!regions.HitTest(ImVec2(100.0f, 50.0f)));
+}
+
+static void TestLayoutKeyedOnRect()
+{
+    OverlayRegions regions;
+    FeedTwoWindows(regions, 1);
+    IMGUI_EX_CHECK(regions.LayoutChanged());
+    IMGUI_EX_CHECK(regions.GetRebuildCount() == 1);
+    regions.Presented();
+
+    // Same windows, same keys: nothing to present
+    FeedTwoWindows(regions, 1);
+    IMGUI_EX_CHECK(!regions.LayoutChanged());
+    IMGUI_EX_CHECK(!regions.IsDirty());
+    IMGUI_EX_CHECK(regions.GetRebuildCount() == 1);
+
+    // New content key: the window is dirty, the regions stay
+    FeedTwoWindows(regions, 2);
+    IMGUI_EX_CHECK(!regions.LayoutChanged());
+    IMGUI_EX_CHECK(regions.IsDirty());
+    IMGUI_EX_CHECK(regions.GetDirtyRects().size() == 1);
+    IMGUI_EX_CHECK(regions.GetRebuildCount() == 1);
+
+    // Moved window: old and new rect are dirty and merge, the regions are rebuilt
+    regions.BeginFrame();
+    regions.AddWindow(1, ImRect(50.0f, 0.0f, 150.0f, 100.0f), 2, true);
+    regions.AddWindow(2, ImRect(200.0f, 0.0f, 300.0f, 100.0f), 7, true);
+    regions.EndFrame();
+    IMGUI_EX_CHECK(regions.LayoutChanged());
+    IMGUI_EX_CHECK(regions.GetRebuildCount() == 2);
+    IMGUI_EX_CHECK(regions.GetDirtyRects().size() == 1);
+    IMGUI_EX_CHECK(regions.GetDirtyRects()[0].Min.x == 0.0f && regions.GetDirtyRects()[0].Max.x == 150.0f);
+    IMGUI_EX_CHECK(regions.HitTest(ImVec2(140.0f, 50.0f)));
+
+    // Closed window
+    regions.BeginFrame();
+    regions.AddWindow(1, ImRect(50.0f, 0.0f, 150.0f, 100.0f), 2, true);
+    regions.EndFrame();
+    IMGUI_EX_CHECK(regions.LayoutChanged());
+    IMGUI_EX_CHECK(regions.GetRegions().size() == 1);
+    IMGUI_EX_CHECK(!regions.HitTest(ImVec2(250.0f, 50.0f)));
+}
+
+static void TestRedrawAndInvalidate()
+{
+    OverlayRegions regions;
+    FeedTwoWindows(regions, 1);
+    regions.Presented();
+
+    regions.BeginFrame();
+    regions.AddWindow(1, ImRect(0.0f, 0.0f, 100.0f, 100.0f), 1, true);
+    regions.AddWindow(2, ImRect(200.0f, 0.0f, 300.0f, 100.0f), 7, true);
+    regions.RedrawWindows();
+    regions.EndFrame();
+    IMGUI_EX_CHECK(regions.IsDirty());
+    IMGUI_EX_CHECK(!regions.LayoutChanged());
+    IMGUI_EX_CHECK(regions.GetDirtyRects().size() == 2);
+
+    FeedTwoWindows(regions, 1);
+    IMGUI_EX_CHECK(!regions.IsDirty());
+    regions.Invalidate();
+    IMGUI_EX_CHECK(regions.IsDirty());
+    regions.Presented();
+    IMGUI_EX_CHECK(!regions.IsDirty());
+}
+
+// Idle frames of a real context are not presented again, input is
+static void TestCollectWindows()
+{
+    TestContext context;
+    OverlayRegions regions;
+    int counter = 0;
+    auto frame = [&]() {
+        ImGui::NewFrame();
+        ImGui::SetNextWindowPos(ImVec2(10.0f, 10.0f));
+        ImGui::SetNextWindowSize(ImVec2(200.0f, 100.0f));
+        ImGui::Begin("Overlay A");
+        ImGui::Text("Counter %d", counter);
+        ImGui::End();
+        ImGui::SetNextWindowPos(ImVec2(400.0f, 10.0f));
+        ImGui::SetNextWindowSize(ImVec2(200.0f, 100.0f));
+        ImGui::Begin("Overlay B", nullptr, ImGuiWindowFlags_NoMouseInputs);
+        ImGui::Text("Status");
+        ImGui::End();
+        ImGui::Render();
+        ImGuiEx::internal::CollectOverlayWindows(regions, ImGui::GetMainViewport());
+        regions.Presented();
+    };
+    for (int i = 0; i < 3; i++)
+        frame();
+    IMGUI_EX_CHECK(regions.HitTest(ImVec2(50.0f, 50.0f)));
+    IMGUI_EX_CHECK(!regions.HitTest(ImVec2(450.0f, 50.0f)));
+
+    frame();
+    IMGUI_EX_CHECK(!regions.IsDirty());
+    IMGUI_EX_CHECK(!regions.LayoutChanged());
+
+    // Longer text, more vertices
+    counter = 1000000;
+    frame();
+    IMGUI_EX_CHECK(regions.GetDirtyRects().size() == 1);
+    frame();
+    IMGUI_EX_CHECK(!regions.IsDirty());
+
+    // Other digits, the same number of vertices
+    counter = 2000000;
+    frame();
+    IMGUI_EX_CHECK(regions.GetDirtyRects().size() == 1);
+
+    ImGui::GetIO().AddMousePosEvent(50.0f, 50.0f);
+    frame();
+    IMGUI_EX_CHECK(!regions.GetDirtyRects().empty());
+    IMGUI_EX_CHECK(!regions.LayoutChanged());
+}
+
+int main()
+{
+    IMGUI_EX_TEST(TestRegionsHitTest);
+    IMGUI_EX_TEST(TestLayoutKeyedOnRect);
+    IMGUI_EX_TEST(TestRedrawAndInvalidate);
+    IMGUI_EX_TEST(TestCollectWindows);
+    return TestExitCode();
+}
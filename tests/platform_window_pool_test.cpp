@@ -0,0 +1,191 @@
+// PlatformWindowPool: closed viewports hand their windows to the next ones, driven by fake backend callbacks
+#include "imgui_ex_test.h"
+
+using ImGuiEx::internal::PlatformWindowPool;
+
+// A backend that only counts: user data is a heap int, live windows and renderer data are tracked
+struct FakeBackend
+{
+    static int platform_live;
+    static int renderer_live;
+    static int platform_created;
+    static int renderer_created;
+    static int resized;
+    static int hidden;
+
+    static void Reset()
+    {
+        platform_live = renderer_live = platform_created = renderer_created = resized = hidden = 0;
+    }
+
+    static void PlatformCreate(ImGuiViewport* viewport)
+    {
+        viewport->PlatformUserData = new int(++platform_created);
+        viewport->PlatformHandle = viewport->PlatformUserData;
+        platform_live++;
+    }
+
+    static void PlatformDestroy(ImGuiViewport* viewport)
+    {
+        if (viewport->PlatformUserData == nullptr)
+            return;
+        delete (int*)viewport->PlatformUserData;
+        viewport->PlatformUserData = nullptr;
+        viewport->PlatformHandle = nullptr;
+        platform_live--;
+    }
+
+    static void RendererCreate(ImGuiViewport* viewport)
+    {
+        viewport->RendererUserData = new int(++renderer_created);
+        renderer_live++;
+    }
+
+    static void RendererDestroy(ImGuiViewport* viewport)
+    {
+        if (viewport->RendererUserData == nullptr)
+            return;
+        delete (int*)viewport->RendererUserData;
+        viewport->RendererUserData = nullptr;
+        renderer_live--;
+    }
+
+    static void RendererSetSize(ImGuiViewport*, ImVec2)
+    {
+        resized++;
+    }
+
+    static void Install(ImGuiPlatformIO& platform_io)
+    {
+        platform_io.Platform_CreateWindow = PlatformCreate;
+        platform_io.Platform_DestroyWindow = PlatformDestroy;
+        platform_io.Renderer_CreateWindow = RendererCreate;
+        platform_io.Renderer_DestroyWindow = RendererDestroy;
+        platform_io.Renderer_SetWindowSize = RendererSetSize;
+    }
+};
+
+int FakeBackend::platform_live;
+int FakeBackend::renderer_live;
+int FakeBackend::platform_created;
+int FakeBackend::renderer_created;
+int FakeBackend::resized;
+int FakeBackend::hidden;
+
+// The order ImGui calls the callbacks in
+static void Create(ImGuiPlatformIO& platform_io, ImGuiViewport& viewport, float width, float height)
+{
+    viewport.Size = ImVec2(width, height);
+    platform_io.Platform_CreateWindow(&viewport);
+    platform_io.Renderer_CreateWindow(&viewport);
+}
+
+static void Destroy(ImGuiPlatformIO& platform_io, ImGuiViewport& viewport)
+{
+    platform_io.Renderer_DestroyWindow(&viewport);
+    platform_io.Platform_DestroyWindow(&viewport);
+}
+
+static void TestReuse()
+{
+    TestContext context;
+    FakeBackend::Reset();
+    ImGuiPlatformIO platform_io;
+    FakeBackend::Install(platform_io);
+    {
+        PlatformWindowPool pool(4);
+        pool.Install(platform_io, [](ImGuiViewport*) { FakeBackend::hidden++; });
+
+        ImGuiViewport first;
+        Create(platform_io, first, 300.0f, 200.0f);
+        void* const platform_data = first.PlatformUserData;
+        void* const renderer_data = first.RendererUserData;
+        Destroy(platform_io, first);
+        IMGUI_EX_CHECK(first.PlatformUserData == nullptr && first.RendererUserData == nullptr);
+        IMGUI_EX_CHECK(FakeBackend::platform_live == 1 && FakeBackend::renderer_live == 1);
+        IMGUI_EX_CHECK(FakeBackend::hidden == 1);
+        IMGUI_EX_CHECK(pool.GetStats().released == 1 && pool.GetStats().pooled == 1);
+
+        // Same size: the same window and render target, nothing resized
+        ImGuiViewport second;
+        Create(platform_io, second, 300.0f, 200.0f);
+        IMGUI_EX_CHECK(second.PlatformUserData == platform_data && second.RendererUserData == renderer_data);
+        IMGUI_EX_CHECK(FakeBackend::platform_created == 1 && FakeBackend::renderer_created == 1);
+        IMGUI_EX_CHECK(FakeBackend::resized == 0);
+        IMGUI_EX_CHECK(pool.GetStats().reused == 1 && pool.GetStats().pooled == 0);
+
+        // Another size: reused, the render target follows
+        Destroy(platform_io, second);
+        ImGuiViewport third;
+        Create(platform_io, third, 640.0f, 480.0f);
+        IMGUI_EX_CHECK(third.PlatformUserData == platform_data);
+        IMGUI_EX_CHECK(FakeBackend::resized == 1 && pool.GetStats().resized == 1);
+        Destroy(platform_io, third);
+    }
+    // Uninstall hands the pooled window back to the backend
+    IMGUI_EX_CHECK(FakeBackend::platform_live == 0 && FakeBackend::renderer_live == 0);
+    IMGUI_EX_CHECK(platform_io.Platform_CreateWindow == FakeBackend::PlatformCreate);
+    IMGUI_EX_CHECK(platform_io.Renderer_DestroyWindow == FakeBackend::RendererDestroy);
+}
+
+// A pooled window of the requested size is taken before the most recent one
+static void TestSameSizePreferred()
+{
+    TestContext context;
+    FakeBackend::Reset();
+    ImGuiPlatformIO platform_io;
+    FakeBackend::Install(platform_io);
+    PlatformWindowPool pool(4);
+    pool.Install(platform_io, nullptr);
+
+    ImGuiViewport small;
+    ImGuiViewport large;
+    Create(platform_io, small, 100.0f, 100.0f);
+    Create(platform_io, large, 800.0f, 600.0f);
+    void* const small_data = small.PlatformUserData;
+    Destroy(platform_io, small);
+    Destroy(platform_io, large);
+
+    ImGuiViewport next;
+    Create(platform_io, next, 100.0f, 100.0f);
+    IMGUI_EX_CHECK(next.PlatformUserData == small_data);
+    IMGUI_EX_CHECK(FakeBackend::resized == 0);
+    Destroy(platform_io, next);
+    pool.Uninstall();
+    IMGUI_EX_CHECK(FakeBackend::platform_live == 0 && FakeBackend::renderer_live == 0);
+}
+
+// Beyond the capacity the oldest window is destroyed; capacity 0 destroys right away
+static void TestCapacity()
+{
+    TestContext context;
+    FakeBackend::Reset();
+    ImGuiPlatformIO platform_io;
+    FakeBackend::Install(platform_io);
+    PlatformWindowPool pool(2);
+    pool.Install(platform_io, nullptr);
+
+    ImGuiViewport viewports[3];
+    for (ImGuiViewport& viewport : viewports)
+        Create(platform_io, viewport, 200.0f, 200.0f);
+    for (ImGuiViewport& viewport : viewports)
+        Destroy(platform_io, viewport);
+    IMGUI_EX_CHECK(pool.GetStats().pooled == 2 && pool.GetStats().destroyed == 1);
+    IMGUI_EX_CHECK(FakeBackend::platform_live == 2 && FakeBackend::renderer_live == 2);
+
+    pool.SetCapacity(0);
+    IMGUI_EX_CHECK(pool.GetStats().pooled == 0 && FakeBackend::platform_live == 0 && FakeBackend::renderer_live == 0);
+    ImGuiViewport unpooled;
+    Create(platform_io, unpooled, 200.0f, 200.0f);
+    Destroy(platform_io, unpooled);
+    IMGUI_EX_CHECK(FakeBackend::platform_live == 0 && FakeBackend::renderer_live == 0);
+    IMGUI_EX_CHECK(pool.GetStats().created == 4 && pool.GetStats().released == 3);
+}
+
+int main()
+{
+    IMGUI_EX_TEST(TestReuse);
+    IMGUI_EX_TEST(TestSameSizePreferred);
+    IMGUI_EX_TEST(TestCapacity);
+    return TestExitCode();
+}
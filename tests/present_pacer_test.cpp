@@ -0,0 +1,184 @@
+// Present: what the swap chain does of a PresentConfig, input latency and pacing against a mock swap chain
+#include "imgui_ex_test.h"
+
+using ImGuiEx::PresentCaps;
+using ImGuiEx::PresentConfig;
+using ImGuiEx::PresentPolicy;
+using ImGuiEx::internal::PresentLatencyTracker;
+using ImGuiEx::internal::ResolvePresentPolicy;
+
+using Clock = std::chrono::steady_clock;
+
+struct MockSwapChain
+{
+    bool signaled = true;
+    int waits = 0;
+    std::vector<std::pair<unsigned, bool>> presents;
+
+    bool WaitForFrame(unsigned)
+    {
+        waits++;
+        return signaled;
+    }
+
+    bool Present(unsigned sync_interval, bool tearing)
+    {
+        presents.push_back({ sync_interval, tearing });
+        return true;
+    }
+};
+
+static const PresentCaps kAllCaps = { true, true, true };
+static const PresentCaps kNoCaps = { false, false, false };
+
+static void TestResolveDefaults()
+{
+    const PresentPolicy policy = ResolvePresentPolicy(PresentConfig(), kAllCaps);
+    IMGUI_EX_CHECK(policy.flip_model);
+    IMGUI_EX_CHECK(policy.buffer_count == 2);
+    IMGUI_EX_CHECK(policy.sync_interval == 1);
+    // Tearing is only for presents without vsync
+    IMGUI_EX_CHECK(!policy.tearing);
+    IMGUI_EX_CHECK(policy.waitable && policy.max_frame_latency == 1);
+}
+
+static void TestResolveTearing()
+{
+    PresentConfig config;
+    config.vsync = false;
+    IMGUI_EX_CHECK(ResolvePresentPolicy(config, kAllCaps).tearing);
+    IMGUI_EX_CHECK(ResolvePresentPolicy(config, kAllCaps).sync_interval == 0);
+    config.allow_tearing = false;
+    IMGUI_EX_CHECK(!ResolvePresentPolicy(config, kAllCaps).tearing);
+    config.allow_tearing = true;
+    PresentCaps caps = kAllCaps;
+    caps.tearing = false;
+    IMGUI_EX_CHECK(!ResolvePresentPolicy(config, caps).tearing);
+    // Tearing needs the flip model, asked for or supported
+    config.flip_model = false;
+    IMGUI_EX_CHECK(!ResolvePresentPolicy(config, kAllCaps).tearing);
+}
+
+// Without flip model support: blt model, one buffer allowed, nothing to wait on
+static void TestResolveWithoutCaps()
+{
+    PresentConfig config;
+    config.vsync = false;
+    config.buffer_count = 1;
+    const PresentPolicy policy = ResolvePresentPolicy(config, kNoCaps);
+    IMGUI_EX_CHECK(!policy.flip_model && !policy.tearing && !policy.waitable);
+    IMGUI_EX_CHECK(policy.buffer_count == 1);
+    IMGUI_EX_CHECK(ResolvePresentPolicy(config, kAllCaps).buffer_count == 2);
+}
+
+static void TestResolveClamps()
+{
+    PresentConfig config;
+    config.buffer_count = 100;
+    config.max_frame_latency = 50;
+    IMGUI_EX_CHECK(ResolvePresentPolicy(config, kAllCaps).buffer_count == 16);
+    IMGUI_EX_CHECK(ResolvePresentPolicy(config, kAllCaps).max_frame_latency == 16);
+    config.buffer_count = -4;
+    config.max_frame_latency = -3;
+    const PresentPolicy policy = ResolvePresentPolicy(config, kAllCaps);
+    IMGUI_EX_CHECK(policy.buffer_count == 2);
+    // The driver default latency has no waitable object
+    IMGUI_EX_CHECK(policy.max_frame_latency == 0 && !policy.waitable);
+}
+
+static void TestLatencyTracker()
+{
+    PresentLatencyTracker tracker;
+    const Clock::time_point start = Clock::now();
+    const auto ms = [&](int value) { return start + std::chrono::milliseconds(value); };
+
+    // Nothing latched, or a frame without input: no sample
+    IMGUI_EX_CHECK(tracker.Presented(ms(1)) < 0.0);
+    tracker.Latch();
+    IMGUI_EX_CHECK(tracker.Presented(ms(2)) < 0.0);
+
+    // The earliest input of a frame counts, in either order
+    tracker.Input(ms(15));
+    tracker.Input(ms(10));
+    tracker.Input(ms(12));
+    tracker.Latch();
+    // Input of the next frame arrives before this one is presented
+    tracker.Input(ms(30));
+    tracker.Latch();
+    IMGUI_EX_CHECK(tracker.Presented(ms(40)) == 30.0);
+    IMGUI_EX_CHECK(tracker.Presented(ms(50)) == 20.0);
+
+    ImGuiEx::PresentStats stats = {};
+    tracker.GetStats(stats);
+    IMGUI_EX_CHECK(stats.input_samples == 2);
+    IMGUI_EX_CHECK(stats.input_latency_max_ms == 30.0);
+    IMGUI_EX_CHECK(stats.input_latency_ms == 29.0);
+}
+
+// Frames that are never presented do not pile up, the oldest are dropped
+static void TestLatencyTrackerDropsUnpresented()
+{
+    PresentLatencyTracker tracker;
+    const Clock::time_point start = Clock::now();
+    for (int frame = 0; frame < 20; frame++)
+    {
+        tracker.Input(start + std::chrono::milliseconds(frame));
+        tracker.Latch();
+    }
+    const Clock::time_point now = start + std::chrono::milliseconds(100);
+    IMGUI_EX_CHECK(tracker.Presented(now) == 88.0);
+    int answered = 1;
+    while (tracker.Presented(now) >= 0.0)
+        answered++;
+    IMGUI_EX_CHECK(answered == 8);
+}
+
+static void TestPacer()
+{
+    MockSwapChain main;
+    ImGuiEx::internal::PresentPacer<MockSwapChain> pacer(main);
+    PresentConfig config;
+    config.vsync = false;
+    pacer.SetPolicy(ResolvePresentPolicy(config, kAllCaps));
+
+    pacer.WaitForFrame();
+    main.signaled = false;
+    pacer.WaitForFrame();
+    IMGUI_EX_CHECK(main.waits == 2);
+    IMGUI_EX_CHECK(pacer.GetStats().wait_timeouts == 1);
+
+    pacer.Present();
+    IMGUI_EX_CHECK(main.presents.size() == 1 && main.presents[0].first == 0 && main.presents[0].second);
+
+    // Another swap chain gets the same policy and counts in the same stats
+    MockSwapChain captured;
+    pacer.Present(captured);
+    IMGUI_EX_CHECK(main.presents.size() == 1 && captured.presents.size() == 1 && captured.presents[0].second);
+    IMGUI_EX_CHECK(pacer.GetStats().presents == 2);
+
+    // Without a waitable object the wait is skipped
+    pacer.SetPolicy(ResolvePresentPolicy(PresentConfig(), kNoCaps));
+    pacer.WaitForFrame();
+    IMGUI_EX_CHECK(main.waits == 2);
+    pacer.Present();
+    IMGUI_EX_CHECK(main.presents.back().first == 1 && !main.presents.back().second);
+    IMGUI_EX_CHECK(!pacer.GetStats().policy.flip_model);
+
+    // Presents answer the latched inputs
+    pacer.GetLatencyTracker().Input(Clock::now());
+    pacer.GetLatencyTracker().Latch();
+    pacer.Present();
+    IMGUI_EX_CHECK(pacer.GetStats().input_samples == 1);
+}
+
+int main()
+{
+    IMGUI_EX_TEST(TestResolveDefaults);
+    IMGUI_EX_TEST(TestResolveTearing);
+    IMGUI_EX_TEST(TestResolveWithoutCaps);
+    IMGUI_EX_TEST(TestResolveClamps);
+    IMGUI_EX_TEST(TestLatencyTracker);
+    IMGUI_EX_TEST(TestLatencyTrackerDropsUnpresented);
+    IMGUI_EX_TEST(TestPacer);
+    return TestExitCode();
+}
@@ -0,0 +1,161 @@
+// Profiler: inclusive and exclusive time of nested scopes on a stepped clock, the top offenders and the folded stacks.
+// Built without IMGUI_EX_PROFILER, as a release build is, the widgets' scopes must compile to nothing.
+#include "imgui_ex_test.h"
+
+#include <cmath>
+
+using ImGuiEx::ProfileEntry;
+using ImGuiEx::internal::Profiler;
+
+#ifdef IMGUI_EX_PROFILER
+#error "profiler_test checks the build without IMGUI_EX_PROFILER"
+#endif
+
+#define PROFILER_TEST_STRING2(x) #x
+#define PROFILER_TEST_STRING(x) PROFILER_TEST_STRING2(x)
+static_assert(sizeof(PROFILER_TEST_STRING(IMGUI_EX_PROFILE_SCOPE("label", "event"))) == 1, "IMGUI_EX_PROFILE_SCOPE expands to nothing without IMGUI_EX_PROFILER");
+
+static int64_t gs_now_ns = 0;
+
+static int64_t FakeNow()
+{
+    return gs_now_ns;
+}
+
+static bool Near(double a, double b)
+{
+    return std::fabs(a - b) < 1e-9;
+}
+
+static const ProfileEntry* Find(const std::vector<ProfileEntry>& entries, const char* label)
+{
+    for (const ProfileEntry& entry : entries)
+    {
+        if (entry.label == label)
+            return &entry;
+    }
+    return nullptr;
+}
+
+// A window holding a button and a child with another button, in microseconds:
+// Window 0..10, Button 1..4, Child 5..9, Button 6..8
+static void Frame(Profiler& profiler)
+{
+    int window, button, child, child_button;
+    const int64_t start = gs_now_ns;
+    auto at = [start](int us) { gs_now_ns = start + us * 1000; };
+    at(0);
+    profiler.Push(&window, "Window");
+    at(1);
+    profiler.Push(&button, "Button");
+    at(4);
+    profiler.Pop(&button);
+    at(5);
+    profiler.Push(&child, "Child");
+    at(6);
+    profiler.Push(&child_button, "Button");
+    at(8);
+    profiler.Pop(&child_button);
+    at(9);
+    profiler.Pop(&child);
+    at(10);
+    profiler.Pop(&window);
+    profiler.NewFrame();
+}
+
+static void TestNestedScopes()
+{
+    Profiler profiler;
+    profiler.SetClock(FakeNow);
+    Frame(profiler);
+    Frame(profiler);
+    IMGUI_EX_CHECK(profiler.GetFrameCount() == 2);
+    IMGUI_EX_CHECK(profiler.GetNodes().size() == 4);
+
+    // Per frame, the two buttons are one entry
+    const std::vector<ProfileEntry> entries = profiler.GetEntries();
+    IMGUI_EX_CHECK(entries.size() == 3);
+    const ProfileEntry* window = Find(entries, "Window");
+    const ProfileEntry* child = Find(entries, "Child");
+    const ProfileEntry* button = Find(entries, "Button");
+    IMGUI_EX_CHECK(window && child && button);
+    IMGUI_EX_CHECK(window->top_level && !child->top_level && !button->top_level);
+    IMGUI_EX_CHECK(Near(window->calls, 1.0) && Near(button->calls, 2.0));
+    IMGUI_EX_CHECK(Near(window->inclusive_ms, 0.010) && Near(window->exclusive_ms, 0.003));
+    IMGUI_EX_CHECK(Near(child->inclusive_ms, 0.004) && Near(child->exclusive_ms, 0.002));
+    IMGUI_EX_CHECK(Near(button->inclusive_ms, 0.005) && Near(button->exclusive_ms, 0.005));
+    IMGUI_EX_CHECK(Near(button->max_inclusive_ms, 0.003));
+}
+
+// Scopes left open are closed by their owner, or by the next frame
+static void TestUnclosedScopes()
+{
+    Profiler profiler;
+    profiler.SetClock(FakeNow);
+    int window, button;
+    gs_now_ns = 0;
+    profiler.Push(&window, "Window");
+    gs_now_ns = 1000;
+    profiler.Push(&button, "Save", "ClickEvent");
+    gs_now_ns = 3000;
+    profiler.Pop(&window);
+    // Popping an owner that is not open changes nothing
+    profiler.Pop(&button);
+    profiler.Push(&window, "", "ExpandUpdate");
+    gs_now_ns = 4000;
+    profiler.NewFrame();
+
+    const std::vector<ProfileEntry> entries = profiler.GetEntries();
+    const ProfileEntry* click = Find(entries, "Save ClickEvent");
+    const ProfileEntry* update = Find(entries, "ExpandUpdate");
+    IMGUI_EX_CHECK(click && Near(click->inclusive_ms, 0.002) && Near(click->calls, 1.0));
+    IMGUI_EX_CHECK(update && Near(update->inclusive_ms, 0.001));
+    IMGUI_EX_CHECK(Near(Find(entries, "Window")->exclusive_ms, 0.001));
+}
+
+static void TestTopOffenders()
+{
+    Profiler profiler;
+    profiler.SetClock(FakeNow);
+    Frame(profiler);
+    std::vector<ProfileEntry> entries = profiler.GetEntries();
+
+    ImGuiEx::internal::SortProfileEntries(entries, 3, false);
+    IMGUI_EX_CHECK(entries[0].label == "Button" && entries[1].label == "Window" && entries[2].label == "Child");
+    ImGuiEx::internal::SortProfileEntries(entries, 2, false);
+    IMGUI_EX_CHECK(entries[0].label == "Window" && entries[1].label == "Button" && entries[2].label == "Child");
+    ImGuiEx::internal::SortProfileEntries(entries, 0, true);
+    IMGUI_EX_CHECK(entries[0].label == "Button" && entries[1].label == "Child" && entries[2].label == "Window");
+    ImGuiEx::internal::SortProfileEntries(entries, 1, false);
+    IMGUI_EX_CHECK(entries[0].label == "Button");
+}
+
+// One line per call path with exclusive microseconds, in the order the nodes were first seen
+static void TestFoldedStacks()
+{
+    Profiler profiler;
+    profiler.SetClock(FakeNow);
+    Frame(profiler);
+    Frame(profiler);
+    IMGUI_EX_CHECK(profiler.GetFoldedStacks() == "Window 6\nWindow;Button 6\nWindow;Child 4\nWindow;Child;Button 4\n");
+
+    // A separator inside a label would split the stack, nodes without exclusive time are left out
+    profiler.Reset();
+    int owner;
+    gs_now_ns = 0;
+    profiler.Push(&owner, "a;b");
+    gs_now_ns = 2500;
+    profiler.Pop(&owner);
+    profiler.Push(&owner, "empty");
+    profiler.Pop(&owner);
+    IMGUI_EX_CHECK(profiler.GetFoldedStacks() == "a,b 2\n");
+}
+
+int main()
+{
+    IMGUI_EX_TEST(TestNestedScopes);
+    IMGUI_EX_TEST(TestUnclosedScopes);
+    IMGUI_EX_TEST(TestTopOffenders);
+    IMGUI_EX_TEST(TestFoldedStacks);
+    return TestExitCode();
+}
@@ -0,0 +1,116 @@
+// ResizePolicy: debounced exact sizes without a sub-region presenter, size classes with one
+#include "imgui_ex_test.h"
+
+using ImGuiEx::internal::ResizePolicy;
+
+// A drag from one size to another, one request and one frame every 16 ms; returns the reallocations
+static int Drag(ResizePolicy& policy, int from_width, int to_width, int height, double& now_ms, int steps)
+{
+    int reallocations = 0;
+    ResizePolicy::Action action;
+    for (int i = 1; i <= steps; i++)
+    {
+        policy.Request(from_width + (to_width - from_width) * i / steps, height, now_ms);
+        if (policy.Update(now_ms, action) && action.reallocate)
+            reallocations++;
+        now_ms += 16.0;
+    }
+    return reallocations;
+}
+
+// Frames keep coming after the drag, until the size settled
+static int Settle(ResizePolicy& policy, double& now_ms, ResizePolicy::Action& last)
+{
+    int reallocations = 0;
+    ResizePolicy::Action action;
+    for (int i = 0; i < 20; i++)
+    {
+        if (policy.Update(now_ms, action) && action.reallocate)
+        {
+            reallocations++;
+            last = action;
+        }
+        now_ms += 16.0;
+    }
+    return reallocations;
+}
+
+static void TestDebounce()
+{
+    ResizePolicy policy(256, 150.0, 100.0);
+    policy.Reset(800, 600, false);
+    double now_ms = 1000.0;
+    // One second of dragging: at most one reallocation per 100 ms instead of one per frame
+    const int during = Drag(policy, 800, 1400, 600, now_ms, 60);
+    IMGUI_EX_CHECK(during >= 5 && during <= 11);
+
+    ResizePolicy::Action last = {};
+    const int after = Settle(policy, now_ms, last);
+    IMGUI_EX_CHECK(after <= 1);
+    IMGUI_EX_CHECK(policy.GetStats().buffer_width == 1400 && policy.GetStats().buffer_height == 600);
+    IMGUI_EX_CHECK(policy.GetStats().reallocations == (uint64_t)(during + after));
+    IMGUI_EX_CHECK(policy.GetStats().requests == 60);
+    IMGUI_EX_CHECK(policy.GetStats().region_changes == 0);
+
+    // Nothing pending: no work; the same size again: no reallocation
+    ResizePolicy::Action action;
+    IMGUI_EX_CHECK(!policy.Update(now_ms, action));
+    policy.Request(1400, 600, now_ms);
+    now_ms += 200.0;
+    IMGUI_EX_CHECK(!policy.Update(now_ms, action));
+    // Minimized windows report zero sizes
+    policy.Request(0, 0, now_ms);
+    IMGUI_EX_CHECK(!policy.Update(now_ms + 200.0, action));
+}
+
+static void TestSizeClasses()
+{
+    ResizePolicy policy(256, 150.0, 100.0);
+    IMGUI_EX_CHECK(policy.SizeClass(1) == 256 && policy.SizeClass(256) == 256 && policy.SizeClass(257) == 512);
+    policy.Reset(1024, 768, true);
+    double now_ms = 1000.0;
+    ResizePolicy::Action action;
+
+    // Growing past the buffers: the next size class, drawn into a region of it
+    policy.Request(1100, 700, now_ms);
+    IMGUI_EX_CHECK(policy.Update(now_ms, action));
+    IMGUI_EX_CHECK(action.reallocate && action.change_region);
+    IMGUI_EX_CHECK(action.buffer_width == 1280 && action.buffer_height == 768);
+    IMGUI_EX_CHECK(action.width == 1100 && action.height == 700);
+
+    // Inside the buffers: only the region changes
+    policy.Request(1250, 760, now_ms + 16.0);
+    IMGUI_EX_CHECK(policy.Update(now_ms + 16.0, action));
+    IMGUI_EX_CHECK(!action.reallocate && action.change_region && action.width == 1250 && action.height == 760);
+    IMGUI_EX_CHECK(policy.GetStats().region_changes == 1);
+}
+
+// A drag inside one size class never reallocates, a big shrink gives the memory back once settled
+static void TestDragAndShrink()
+{
+    ResizePolicy policy(256, 150.0, 100.0);
+    policy.Reset(1280, 768, true);
+    double now_ms = 1000.0;
+    IMGUI_EX_CHECK(Drag(policy, 1030, 1280, 700, now_ms, 60) == 0);
+    IMGUI_EX_CHECK(policy.GetStats().region_changes == 60);
+
+    // Shrinking keeps the buffers while the drag goes on
+    IMGUI_EX_CHECK(Drag(policy, 1280, 400, 300, now_ms, 5) == 0);
+    ResizePolicy::Action last = {};
+    IMGUI_EX_CHECK(Settle(policy, now_ms, last) == 1);
+    IMGUI_EX_CHECK(last.buffer_width == 512 && last.buffer_height == 512);
+    IMGUI_EX_CHECK(last.width == 400 && last.height == 300);
+
+    // Less than a size class unused stays as it is
+    policy.Request(300, 300, now_ms);
+    IMGUI_EX_CHECK(Settle(policy, now_ms, last) == 0);
+    IMGUI_EX_CHECK(policy.GetStats().buffer_width == 512 && policy.GetStats().width == 300);
+}
+
+int main()
+{
+    IMGUI_EX_TEST(TestDebounce);
+    IMGUI_EX_TEST(TestSizeClasses);
+    IMGUI_EX_TEST(TestDragAndShrink);
+    return TestExitCode();
+}
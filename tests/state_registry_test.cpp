@@ -0,0 +1,65 @@
+// StateRegistry: keys of repeated labels, save and restore round trips
+#include "imgui_ex_test.h"
+
+// The same label in two windows, told apart by the owner
+static void TestOwnerKeys()
+{
+    ImGuiEx::Window left("Left");
+    ImGuiEx::Window right("Right");
+    ImGuiEx::CheckBox left_enabled("Enabled", true);
+    ImGuiEx::CheckBox right_enabled("Enabled", false);
+    ImGuiEx::StateRegistry registry;
+    registry.Register(left, left_enabled);
+    registry.Register(right, right_enabled);
+    // The same widget again only replaces its entry
+    registry.Register(right, right_enabled);
+
+    std::vector<uint8_t> data;
+    registry.Save(data);
+    IMGUI_EX_CHECK(registry.GetStats().widgets == 2);
+
+    left_enabled.SetCheck(false);
+    right_enabled.SetCheck(true);
+    IMGUI_EX_CHECK(registry.Restore(data.data(), data.size()));
+    IMGUI_EX_CHECK(registry.GetStats().restored == 2);
+    IMGUI_EX_CHECK(left_enabled.GetCheck());
+    IMGUI_EX_CHECK(!right_enabled.GetCheck());
+}
+
+// Entries without a widget or with another type are skipped, the rest still restores
+static void TestRestoreSkips()
+{
+    ImGuiEx::CheckBox logging("Logging", true);
+    ImGuiEx::InputText path("Path", 256);
+    path.SetText("C:\\logs");
+    std::vector<uint8_t> data;
+    {
+        ImGuiEx::StateRegistry registry;
+        registry.Register(logging);
+        registry.Register(path);
+        registry.Register("Removed later", logging);
+        registry.Save(data);
+    }
+
+    ImGuiEx::CheckBox wrong_type("Path");
+    ImGuiEx::StateRegistry registry;
+    logging.SetCheck(false);
+    registry.Register(logging);
+    registry.Register(wrong_type);
+    IMGUI_EX_CHECK(registry.Restore(data.data(), data.size()));
+    IMGUI_EX_CHECK(logging.GetCheck());
+    IMGUI_EX_CHECK(!wrong_type.GetCheck());
+    IMGUI_EX_CHECK(registry.GetStats().restored == 1);
+    IMGUI_EX_CHECK(registry.GetStats().skipped == 2);
+
+    // Truncated snapshots are refused
+    IMGUI_EX_CHECK(!registry.Restore(data.data(), 3));
+    IMGUI_EX_CHECK(!registry.Restore(data.data(), data.size() / 2));
+}
+
+int main()
+{
+    IMGUI_EX_TEST(TestOwnerKeys);
+    IMGUI_EX_TEST(TestRestoreSkips);
+    return TestExitCode();
+}
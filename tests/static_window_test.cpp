@@ -0,0 +1,93 @@
+// Window::SetStatic: replayed geometry, and content that must not be cached
+#include "imgui_ex_test.h"
+
+template<class Fn>
+static void StaticFrame(ImGuiEx::Window& window, Fn&& content)
+{
+    ImGui::NewFrame();
+    ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+    ImGui::SetNextWindowSize(ImVec2(400.0f, 300.0f));
+    window.Begin();
+    window.ExpandUpdate(content);
+    window.End();
+    ImGui::Render();
+}
+
+static void TestReplay()
+{
+    TestContext context;
+    ImGuiEx::Window window("Help");
+    window.SetStatic(true);
+    int runs = 0;
+    std::vector<ImDrawVert> captured;
+    auto content = [&]() {
+        runs++;
+        ImGui::SeparatorText("Help");
+        ImGui::BulletText("First line");
+        ImGui::TextUnformatted("Second line");
+    };
+    for (int i = 0; i < 5; i++)
+    {
+        StaticFrame(window, content);
+        ImGuiWindow* imgui_window = ImGui::FindWindowByName("Help");
+        const ImVector<ImDrawVert>& vtx = imgui_window->DrawList->VtxBuffer;
+        if (i == 1)
+            captured.assign(vtx.Data, vtx.Data + vtx.Size);
+        if (i > 1)
+            IMGUI_EX_CHECK(vtx.Size == (int)captured.size() && memcmp(vtx.Data, captured.data(), captured.size() * sizeof(ImDrawVert)) == 0);
+    }
+    // The first frames lay the window out, then every frame replays
+    IMGUI_EX_CHECK(runs < 5);
+    IMGUI_EX_CHECK(window.GetStaticCache().GetHits() >= 3);
+
+    const int before = runs;
+    window.InvalidateStatic();
+    StaticFrame(window, content);
+    IMGUI_EX_CHECK(runs == before + 1);
+}
+
+static void TestChildAndPopupNotCached()
+{
+    TestContext context;
+    ImGuiEx::Window child_window("With child");
+    ImGuiEx::Window popup_window("With popup");
+    child_window.SetStatic(true);
+    popup_window.SetStatic(true);
+    int child_runs = 0;
+    int popup_runs = 0;
+    for (int i = 0; i < 5; i++)
+    {
+        StaticFrame(child_window, [&]() {
+            child_runs++;
+            ImGui::TextUnformatted("Above");
+            ImGui::BeginChild("Inner", ImVec2(100.0f, 50.0f));
+            ImGui::TextUnformatted("Inside");
+            ImGui::EndChild();
+        });
+    }
+    for (int i = 0; i < 5; i++)
+    {
+        StaticFrame(popup_window, [&]() {
+            popup_runs++;
+            ImGui::TextUnformatted("Menu");
+            if (i == 0)
+                ImGui::OpenPopup("Menu popup");
+            if (ImGui::BeginPopup("Menu popup"))
+            {
+                ImGui::TextUnformatted("Item");
+                ImGui::EndPopup();
+            }
+        });
+    }
+    IMGUI_EX_CHECK(child_runs == 5);
+    IMGUI_EX_CHECK(child_window.GetStaticCache().GetHits() == 0);
+    IMGUI_EX_CHECK(popup_runs == 5);
+    IMGUI_EX_CHECK(popup_window.GetStaticCache().GetHits() == 0);
+}
+
+int main()
+{
+    IMGUI_EX_TEST(TestReplay);
+    IMGUI_EX_TEST(TestChildAndPopupNotCached);
+    return TestExitCode();
+}
@@ -0,0 +1,95 @@
+// Table: rows changed through SetRow keep the header sort
+#include "imgui_ex_test.h"
+
+struct TestRow
+{
+    int id;
+    int value;
+};
+
+static void Frame(ImGuiEx::Table<TestRow>& table, int sort_column, ImGuiSortDirection direction)
+{
+    ImGui::NewFrame();
+    ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+    ImGui::SetNextWindowSize(ImVec2(400.0f, 600.0f));
+    ImGui::Begin("Table");
+    table.Begin();
+    if (sort_column >= 0 && ImGui::GetCurrentTable() != nullptr)
+        ImGui::TableSetColumnSortDirection(sort_column, direction, false);
+    table.InsertUpdate();
+    table.End();
+    ImGui::End();
+    ImGui::EndFrame();
+}
+
+static bool SortedByValue(ImGuiEx::Table<TestRow>& table, bool descending)
+{
+    std::vector<TestRow>& rows = table.GetRows();
+    for (size_t i = 1; i < rows.size(); i++)
+    {
+        const TestRow& a = rows[table.GetOrderIndex((int)i - 1)];
+        const TestRow& b = rows[table.GetOrderIndex((int)i)];
+        if (descending ? a.value < b.value : a.value > b.value)
+            return false;
+        if (a.value == b.value && a.id > b.id)
+            return false;
+    }
+    return true;
+}
+
+static void CheckSetRowKeepsSort(bool by_text)
+{
+    TestContext context;
+    ImGuiEx::Table<TestRow> table("##table");
+    table.AddColumn("Id", [](const TestRow& row) { return std::to_string(row.id); },
+        [](const TestRow& a, const TestRow& b) { return a.id - b.id; });
+    if (by_text)
+        table.AddColumn("Value", [](const TestRow& row) { char text[16]; snprintf(text, sizeof(text), "%08d", row.value); return std::string(text); });
+    else
+        table.AddColumn("Value", [](const TestRow& row) { return std::to_string(row.value); },
+            [](const TestRow& a, const TestRow& b) { return a.value - b.value; });
+    std::vector<TestRow> rows;
+    for (int i = 0; i < 500; i++)
+        rows.push_back(TestRow{ i, (i * 7919) % 500 });
+    table.SetRows(std::move(rows));
+
+    for (ImGuiSortDirection direction : { ImGuiSortDirection_Ascending, ImGuiSortDirection_Descending })
+    {
+        // The sort request is read by the next Begin
+        Frame(table, 1, direction);
+        Frame(table, -1, direction);
+        const bool descending = direction == ImGuiSortDirection_Descending;
+        IMGUI_EX_CHECK(SortedByValue(table, descending));
+
+        // To the front, to the back, into the middle, onto an equal value
+        const int values[] = { -1, 1000, 250, 100 };
+        for (int value : values)
+        {
+            table.SetRow(42, TestRow{ 42, value });
+            IMGUI_EX_CHECK(SortedByValue(table, descending));
+        }
+        table.GetRows()[7].value = 9999;
+        table.InvalidateRow(7);
+        IMGUI_EX_CHECK(SortedByValue(table, descending));
+        IMGUI_EX_CHECK(table.GetOrderIndex(descending ? 0 : 499) == 7);
+        Frame(table, -1, direction);
+    }
+}
+
+static void TestSetRowKeepsSort()
+{
+    CheckSetRowKeepsSort(false);
+}
+
+// Columns without compare sort by their cells, SetRow formats the row before it moves
+static void TestSetRowKeepsTextSort()
+{
+    CheckSetRowKeepsSort(true);
+}
+
+int main()
+{
+    IMGUI_EX_TEST(TestSetRowKeepsSort);
+    IMGUI_EX_TEST(TestSetRowKeepsTextSort);
+    return TestExitCode();
+}
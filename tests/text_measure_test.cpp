@@ -0,0 +1,147 @@
+// Text measurement: CalcTextSizeFast, CalcTextSizeReference and ImFont::CalcTextSizeA must agree to the bit
+#include "imgui_ex_test.h"
+
+#include <random>
+
+using ImGuiEx::internal::CalcTextSizeFast;
+using ImGuiEx::internal::CalcTextSizeReference;
+using ImGuiEx::internal::CalcTextSizeRounded;
+
+// ASCII, line breaks, 2/3/4 byte UTF-8 and malformed sequences
+static const char* const gs_pieces[] = {
+    "a", "W", " ", "~", "\x7f", "\t", "\n", "\r", "\r\n", "##",
+    "\xc3\xa9", "\xe4\xb8\xad", "\xf0\x9f\x98\x80",
+    "\x80", "\xbf", "\xe4\xb8", "\xc3", "\xe0\x80\x80", "\xed\xa0\x80", "\xf8\x88\x80\x80\x80",
+};
+
+static int gs_compared = 0;
+
+// Copies the text to a heap block of exactly its size, so reads past text_end leave the allocation
+static void CheckSame(const ImFont* font, float size, const std::string& text)
+{
+    std::unique_ptr<char[]> buffer(new char[text.size() + 1]);
+    char* begin = buffer.get() + 1;
+    memcpy(begin, text.data(), text.size());
+    const char* end = begin + text.size();
+    const ImVec2 reference = CalcTextSizeReference(font, size, begin, end);
+    const ImVec2 fast = CalcTextSizeFast(font, size, begin, end);
+    const ImVec2 imgui = font->CalcTextSizeA(size, FLT_MAX, 0.0f, begin, end);
+    gs_compared++;
+    const bool same = memcmp(&fast, &reference, sizeof(ImVec2)) == 0 && memcmp(&reference, &imgui, sizeof(ImVec2)) == 0;
+    if (!same)
+    {
+        fprintf(stderr, "  mismatch on %d bytes:", (int)text.size());
+        for (unsigned char c : text)
+            fprintf(stderr, " %02x", c);
+        fprintf(stderr, "\n  fast %.9g,%.9g reference %.9g,%.9g imgui %.9g,%.9g\n", fast.x, fast.y, reference.x, reference.y, imgui.x, imgui.y);
+    }
+    IMGUI_EX_CHECK(same);
+}
+
+// Every length around the 16 byte blocks, with each piece at every position
+static void TestLengthsAndPositions()
+{
+    TestContext context;
+    const ImFont* font = ImGui::GetIO().Fonts->Fonts[0];
+    for (float size : { font->FontSize, 17.0f })
+    {
+        for (int length = 0; length <= 48; length++)
+        {
+            std::string ascii;
+            for (int i = 0; i < length; i++)
+                ascii.push_back((char)('A' + i % 26));
+            CheckSame(font, size, ascii);
+            for (const char* piece : gs_pieces)
+            {
+                for (int at = 0; at <= length; at++)
+                {
+                    std::string text = ascii;
+                    text.insert((size_t)at, piece);
+                    CheckSame(font, size, text);
+                }
+            }
+        }
+    }
+}
+
+static void TestRandom()
+{
+    TestContext context;
+    const ImFont* font = ImGui::GetIO().Fonts->Fonts[0];
+    std::mt19937 random(49);
+    const int piece_count = (int)(sizeof(gs_pieces) / sizeof(gs_pieces[0]));
+    for (int i = 0; i < 20000; i++)
+    {
+        std::string text;
+        const int count = (int)(random() % 24);
+        for (int j = 0; j < count; j++)
+        {
+            // Mostly printable runs, so the 16 byte path is taken
+            if (random() % 3 != 0)
+                text.append((size_t)(random() % 20), (char)(' ' + random() % 95));
+            else
+                text += gs_pieces[random() % piece_count];
+        }
+        CheckSame(font, font->FontSize, text);
+    }
+}
+
+// What ImGuiEx::CalcTextSize returns: hidden text after ## and rounding like ImGui::CalcTextSize
+static void TestCalcTextSize()
+{
+    TestContext context;
+    ImGui::NewFrame();
+    const char* const labels[] = { "", "##id", "Label", "Label##id", "Label###id", "Two\nlines##x", "\xe4\xb8\xad\xe6\x96\x87##cjk", "##", "a##b##c" };
+    for (const char* label : labels)
+    {
+        for (bool hide : { false, true })
+        {
+            const ImVec2 ours = CalcTextSizeRounded(ImGui::GetFont(), ImGui::GetFontSize(), label, nullptr, hide);
+            const ImVec2 imgui = ImGui::CalcTextSize(label, nullptr, hide);
+            IMGUI_EX_CHECK(ours.x == imgui.x && ours.y == imgui.y);
+        }
+    }
+    const char* text = "Label##id and more";
+    const ImVec2 ours = CalcTextSizeRounded(ImGui::GetFont(), ImGui::GetFontSize(), text, text + 9, true);
+    const ImVec2 imgui = ImGui::CalcTextSize(text, text + 9, true);
+    IMGUI_EX_CHECK(ours.x == imgui.x && ours.y == imgui.y);
+    ImGui::EndFrame();
+}
+
+// TextUnformattedCached lays out like ImGui::TextUnformatted, wrapped text included
+static void TestTextUnformattedCached()
+{
+    TestContext context;
+    const char* const texts[] = { "", "Short", "Two\nlines", "\xe4\xb8\xad\xe6\x96\x87 text", "A rather long line that is going to wrap at least once in a narrow window" };
+    for (float wrap : { -1.0f, 0.0f, 60.0f })
+    {
+        for (const char* text : texts)
+        {
+            ImGui::NewFrame();
+            ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+            ImGui::SetNextWindowSize(ImVec2(200.0f, 200.0f));
+            ImGui::Begin("Measure");
+            if (wrap >= 0.0f)
+                ImGui::PushTextWrapPos(wrap);
+            ImGui::TextUnformatted(text);
+            const ImVec2 imgui = ImGui::GetItemRectSize();
+            ImGuiEx::internal::TextUnformattedCached(text);
+            const ImVec2 ours = ImGui::GetItemRectSize();
+            if (wrap >= 0.0f)
+                ImGui::PopTextWrapPos();
+            ImGui::End();
+            ImGui::EndFrame();
+            IMGUI_EX_CHECK(ours.x == imgui.x && ours.y == imgui.y);
+        }
+    }
+}
+
+int main()
+{
+    IMGUI_EX_TEST(TestLengthsAndPositions);
+    IMGUI_EX_TEST(TestRandom);
+    IMGUI_EX_TEST(TestCalcTextSize);
+    IMGUI_EX_TEST(TestTextUnformattedCached);
+    printf("%d strings compared\n", gs_compared);
+    return TestExitCode();
+}
@@ -0,0 +1,131 @@
+// TextSizeMemo: when a widget's text is measured again, and the widgets that lay out with it
+#include "imgui_ex_test.h"
+
+using ImGuiEx::internal::CalcTextSizeFast;
+using ImGuiEx::internal::TextSizeMemo;
+
+static bool Same(const ImVec2& a, const ImVec2& b)
+{
+    return a.x == b.x && a.y == b.y;
+}
+
+// Other text, another font or another size is measured again
+static void TestMemoRemeasures()
+{
+    TestContext context;
+    ImGuiIO& io = ImGui::GetIO();
+    ImFontConfig config;
+    config.SizePixels = 20.0f;
+    ImFont* large = io.Fonts->AddFontDefault(&config);
+    unsigned char* pixels;
+    int width, height;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    const ImFont* small = io.Fonts->Fonts[0];
+
+    TextSizeMemo memo;
+    const std::string texts[] = { "Same label", "Same label", "Same lab3l", "Other label, longer", "" };
+    for (const std::string& text : texts)
+    {
+        const char* end = text.c_str() + text.size();
+        IMGUI_EX_CHECK(Same(memo.Get(small, small->FontSize, text.c_str(), end), CalcTextSizeFast(small, small->FontSize, text.c_str(), end)));
+        IMGUI_EX_CHECK(Same(memo.Get(large, large->FontSize, text.c_str(), end), CalcTextSizeFast(large, large->FontSize, text.c_str(), end)));
+        IMGUI_EX_CHECK(Same(memo.Get(large, 30.0f, text.c_str(), end), CalcTextSizeFast(large, 30.0f, text.c_str(), end)));
+    }
+}
+
+// Rebuilding the atlas replaces the advance tables, even when the font keeps its address
+static void TestAtlasRebuild()
+{
+    TestContext context;
+    ImGuiIO& io = ImGui::GetIO();
+    const char* text = "Rebuilt atlas";
+    const char* end = text + strlen(text);
+    TextSizeMemo memo;
+    memo.Get(io.Fonts->Fonts[0], 13.0f, text, end);
+
+    io.Fonts->Clear();
+    ImFontConfig config;
+    config.SizePixels = 20.0f;
+    io.Fonts->AddFontDefault(&config);
+    unsigned char* pixels;
+    int width, height;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    const ImFont* rebuilt = io.Fonts->Fonts[0];
+    IMGUI_EX_CHECK(Same(memo.Get(rebuilt, 13.0f, text, end), CalcTextSizeFast(rebuilt, 13.0f, text, end)));
+}
+
+// Text widgets in two fonts each keep their own size
+static void TestTextWidgetFonts()
+{
+    TestContext context;
+    ImGuiIO& io = ImGui::GetIO();
+    ImFontConfig config;
+    config.SizePixels = 20.0f;
+    ImFont* large = io.Fonts->AddFontDefault(&config);
+    unsigned char* pixels;
+    int width, height;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+    ImGuiEx::Text small_text("Same label");
+    ImGuiEx::Text large_text("Same label");
+    ImVec2 small_size;
+    ImVec2 large_size;
+    for (int i = 0; i < 3; i++)
+    {
+        ImGui::NewFrame();
+        ImGui::Begin("Fonts");
+        small_text.Begin();
+        small_text.End();
+        small_size = ImGui::GetItemRectSize();
+        ImGui::PushFont(large);
+        large_text.Begin();
+        large_text.End();
+        large_size = ImGui::GetItemRectSize();
+        ImGui::PopFont();
+        ImGui::End();
+        ImGui::EndFrame();
+    }
+    IMGUI_EX_CHECK(large_size.x > small_size.x);
+    IMGUI_EX_CHECK(small_size.x == ImGui::CalcTextSize("Same label").x);
+}
+
+// BulletTextCached draws the same vertices as ImGui::BulletText
+static void TestBulletText()
+{
+    TestContext context;
+    ImGuiEx::internal::TextSizeMemo memo;
+    const char* const labels[] = { "", "Bullet", "Two\nlines", "\xe4\xb8\xad\xe6\x96\x87" };
+    for (const char* label : labels)
+    {
+        std::vector<ImDrawVert> vertices[2];
+        ImVec2 sizes[2];
+        for (int pass = 0; pass < 2; pass++)
+        {
+            ImGui::NewFrame();
+            ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+            ImGui::SetNextWindowSize(ImVec2(300.0f, 200.0f));
+            ImGui::Begin("Bullets");
+            if (pass == 0)
+                ImGui::BulletText("%s", label);
+            else
+                ImGuiEx::internal::BulletTextCached(label, nullptr, &memo);
+            sizes[pass] = ImGui::GetItemRectSize();
+            ImGui::End();
+            ImGui::Render();
+            const ImVector<ImDrawVert>& vtx = ImGui::FindWindowByName("Bullets")->DrawList->VtxBuffer;
+            vertices[pass].assign(vtx.Data, vtx.Data + vtx.Size);
+        }
+        IMGUI_EX_CHECK(sizes[0].x == sizes[1].x && sizes[0].y == sizes[1].y);
+        IMGUI_EX_CHECK(vertices[0].size() == vertices[1].size()
+            && memcmp(vertices[0].data(), vertices[1].data(), vertices[0].size() * sizeof(ImDrawVert)) == 0);
+    }
+}
+
+int main()
+{
+    IMGUI_EX_TEST(TestMemoRemeasures);
+    IMGUI_EX_TEST(TestAtlasRebuild);
+    IMGUI_EX_TEST(TestTextWidgetFonts);
+    IMGUI_EX_TEST(TestBulletText);
+    return TestExitCode();
+}
@@ -0,0 +1,250 @@
+// Tree: children loaded on the first expand, reloads reusing their slots, stale async loads and the expand events
+#include "imgui_ex_test.h"
+
+#include <chrono>
+
+using Tree = ImGuiEx::Tree<std::string>;
+
+// One frame of the tree inside a window, events run where a caller runs them, before End
+template<class Fn>
+static void Frame(Tree& tree, Fn&& events)
+{
+    ImGui::NewFrame();
+    ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+    ImGui::SetNextWindowSize(ImVec2(300.0f, 400.0f));
+    ImGui::Begin("Tree");
+    tree.Begin();
+    tree.InsertUpdate();
+    events();
+    tree.End();
+    ImGui::End();
+    ImGui::EndFrame();
+}
+
+static void Frame(Tree& tree)
+{
+    Frame(tree, []() {});
+}
+
+// Frames until done() holds, async results are applied in Begin
+template<class Fn>
+static bool FramesUntil(Tree& tree, Fn&& done)
+{
+    for (int i = 0; i < 10000; i++)
+    {
+        Frame(tree);
+        if (done())
+            return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+// Frames for a while, for results that must not change anything
+static void Frames(Tree& tree, int milliseconds)
+{
+    for (int i = 0; i < milliseconds; i++)
+    {
+        Frame(tree);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+// Holds a pool thread inside the loader until the test opens it
+struct Gate
+{
+    std::atomic<bool> open{ false };
+    std::atomic<int> entered{ 0 };
+    std::atomic<int> left{ 0 };
+
+    void Pass()
+    {
+        entered++;
+        while (!open)
+            std::this_thread::yield();
+        left++;
+    }
+};
+
+static std::vector<std::string> Labels(Tree& tree, int index)
+{
+    std::vector<std::string> labels;
+    for (int child : tree.GetChildIndices(index))
+        labels.push_back(tree.GetNode(child));
+    return labels;
+}
+
+static void TestLazyLoad()
+{
+    Tree tree("##tree");
+    int loads = 0;
+    tree.SetChildrenLoader([&loads](const std::string& node) {
+        loads++;
+        return std::vector<std::string>{ node + "/a", node + "/b", node + "/c" };
+    });
+    tree.SetRoots({ "x", "y" });
+    IMGUI_EX_CHECK(tree.GetVisibleCount() == 2 && loads == 0);
+
+    const int x = tree.GetRootIndices()[0];
+    tree.SetExpand(x, true);
+    IMGUI_EX_CHECK(loads == 1 && tree.GetVisibleCount() == 5);
+    IMGUI_EX_CHECK(Labels(tree, x) == std::vector<std::string>({ "x/a", "x/b", "x/c" }));
+    IMGUI_EX_CHECK(tree.GetParentIndex(tree.GetChildIndices(x)[1]) == x);
+
+    // Collapsing keeps the children, the next expand shows them without loading
+    tree.SetExpand(x, false);
+    IMGUI_EX_CHECK(tree.GetVisibleCount() == 2);
+    tree.SetExpand(x, true);
+    IMGUI_EX_CHECK(loads == 1 && tree.GetVisibleCount() == 5);
+
+    // A collapsed node reloads on its next expand
+    tree.SetExpand(x, false);
+    tree.Reload(x);
+    IMGUI_EX_CHECK(loads == 1 && tree.GetChildIndices(x).empty());
+    tree.SetExpand(x, true);
+    IMGUI_EX_CHECK(loads == 2 && tree.GetVisibleCount() == 5);
+}
+
+// Periodic reloads of an expanded node keep the item count flat, a selection they drop is cleared
+static void TestReloadReusesSlots()
+{
+    Tree tree("##tree");
+    tree.SetChildrenLoader([](const std::string& node) {
+        return std::vector<std::string>{ node + "/a", node + "/b", node + "/c" };
+    });
+    tree.SetRoots({ "x", "y" });
+    const int x = tree.GetRootIndices()[0];
+    const int y = tree.GetRootIndices()[1];
+    tree.SetExpand(x, true);
+    const int a = tree.GetChildIndices(x)[0];
+    tree.SetExpand(a, true);
+    IMGUI_EX_CHECK(tree.GetItemCount() == 8 && tree.GetVisibleCount() == 8);
+
+    tree.SetSelectIndex(tree.GetChildIndices(a)[2]);
+    tree.Reload(x);
+    IMGUI_EX_CHECK(tree.GetSelectIndex() == -1);
+    IMGUI_EX_CHECK(tree.GetItemCount() == 5 && tree.GetVisibleCount() == 5);
+    IMGUI_EX_CHECK(Labels(tree, x) == std::vector<std::string>({ "x/a", "x/b", "x/c" }));
+
+    tree.SetSelectIndex(y);
+    for (int i = 0; i < 100; i++)
+        tree.Reload(x);
+    IMGUI_EX_CHECK(tree.GetSelectIndex() == y);
+    IMGUI_EX_CHECK(tree.GetItemCount() == 5);
+    for (int child : tree.GetChildIndices(x))
+        IMGUI_EX_CHECK(child < 8 && tree.GetParentIndex(child) == x);
+}
+
+// Per-node events fire on the frame of the change, for the node that changed
+static void TestExpandEvents()
+{
+    TestContext context;
+    Tree tree("##tree");
+    tree.SetChildrenLoader([](const std::string& node) {
+        return std::vector<std::string>{ node + "/a", node + "/b" };
+    });
+    tree.SetRoots({ "x", "y" });
+    const int x = tree.GetRootIndices()[0];
+    const int y = tree.GetRootIndices()[1];
+    std::vector<std::string> expanded;
+    std::vector<std::string> collapsed;
+    auto events = [&]() {
+        tree.ExpandEvent([&](std::string& node) { expanded.push_back(node); });
+        tree.CollapsingEvent([&](std::string& node) { collapsed.push_back(node); });
+    };
+    Frame(tree, events);
+    IMGUI_EX_CHECK(expanded.empty() && collapsed.empty());
+
+    tree.SetExpand(x, true);
+    tree.SetExpand(y, true);
+    Frame(tree, events);
+    IMGUI_EX_CHECK(expanded == std::vector<std::string>({ "x", "y" }) && collapsed.empty());
+    Frame(tree, events);
+    IMGUI_EX_CHECK(expanded.size() == 2);
+
+    tree.SetExpand(y, false);
+    Frame(tree, events);
+    IMGUI_EX_CHECK(collapsed == std::vector<std::string>({ "y" }) && expanded.size() == 2);
+
+    // Expanded and collapsed again before the events ran: nothing changed
+    tree.SetExpand(y, true);
+    tree.SetExpand(y, false);
+    Frame(tree, events);
+    IMGUI_EX_CHECK(expanded.size() == 2 && collapsed.size() == 1);
+
+    // A change inside a subtree that is reloaded has no event
+    tree.SetExpand(tree.GetChildIndices(x)[0], true);
+    tree.Reload(x);
+    Frame(tree, events);
+    IMGUI_EX_CHECK(expanded.size() == 2 && collapsed.size() == 1);
+}
+
+// A reload while the first load still runs: only the newest load is applied
+static void TestAsyncReloadDropsStaleLoad()
+{
+    TestContext context;
+    Tree tree("##tree");
+    tree.SetAsyncLoad(true);
+    auto gate = std::make_shared<Gate>();
+    tree.SetChildrenLoader([gate](const std::string& node) {
+        gate->Pass();
+        return std::vector<std::string>{ node + "/old" };
+    });
+    tree.SetRoots({ "x" });
+    const int x = tree.GetRootIndices()[0];
+    tree.SetExpand(x, true);
+    // The node shows a placeholder row until its children arrive
+    IMGUI_EX_CHECK(tree.GetVisibleCount() == 2 && tree.GetChildIndices(x).empty());
+    while (gate->entered == 0)
+        std::this_thread::yield();
+
+    tree.SetChildrenLoader([](const std::string& node) {
+        return std::vector<std::string>{ node + "/a", node + "/b" };
+    });
+    tree.Reload(x);
+    IMGUI_EX_CHECK(FramesUntil(tree, [&]() { return !tree.GetChildIndices(x).empty(); }));
+    IMGUI_EX_CHECK(Labels(tree, x) == std::vector<std::string>({ "x/a", "x/b" }));
+
+    gate->open = true;
+    while (gate->left == 0)
+        std::this_thread::yield();
+    Frames(tree, 50);
+    IMGUI_EX_CHECK(Labels(tree, x) == std::vector<std::string>({ "x/a", "x/b" }));
+    IMGUI_EX_CHECK(tree.GetItemCount() == 3 && tree.GetVisibleCount() == 3);
+}
+
+// New roots while a load runs: its result belongs to the old tree and is dropped
+static void TestAsyncLoadAfterSetRoots()
+{
+    TestContext context;
+    Tree tree("##tree");
+    tree.SetAsyncLoad(true);
+    auto gate = std::make_shared<Gate>();
+    tree.SetChildrenLoader([gate](const std::string& node) {
+        gate->Pass();
+        return std::vector<std::string>{ node + "/a" };
+    });
+    tree.SetRoots({ "x" });
+    tree.SetExpand(tree.GetRootIndices()[0], true);
+    while (gate->entered == 0)
+        std::this_thread::yield();
+
+    // The new root takes the same index as the node being loaded
+    tree.SetRoots({ "y" });
+    gate->open = true;
+    while (gate->left == 0)
+        std::this_thread::yield();
+    Frames(tree, 50);
+    IMGUI_EX_CHECK(tree.GetChildIndices(tree.GetRootIndices()[0]).empty());
+    IMGUI_EX_CHECK(tree.GetItemCount() == 1 && tree.GetVisibleCount() == 1);
+}
+
+int main()
+{
+    IMGUI_EX_TEST(TestLazyLoad);
+    IMGUI_EX_TEST(TestReloadReusesSlots);
+    IMGUI_EX_TEST(TestExpandEvents);
+    IMGUI_EX_TEST(TestAsyncReloadDropsStaleLoad);
+    IMGUI_EX_TEST(TestAsyncLoadAfterSetRoots);
+    return TestExitCode();
+}
@@ -0,0 +1,134 @@
+// UiDriver: Button clicks and Window create/close edges, driven through ImGui's test engine hooks
+#define IMGUI_EX_UI_DRIVER
+#include "imgui_ex_test.h"
+
+static void CheckDriver(const ImGuiEx::UiDriver& driver)
+{
+    for (const std::string& failure : driver.GetFailures())
+        fprintf(stderr, "%s\n", failure.c_str());
+    IMGUI_EX_CHECK(driver.GetFailures().empty());
+}
+
+static void TestButtonClick()
+{
+    ImGuiEx::UiDriver driver;
+    ImGuiEx::Window window("Tools");
+    ImGuiEx::Button run("Run");
+    ImGuiEx::Button stop("Stop");
+    auto frame = [&]() {
+        ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+        ImGui::SetNextWindowSize(ImVec2(300.0f, 200.0f));
+        window.Begin();
+        window.ExpandUpdate([&]() {
+            run.Begin();
+            run.End();
+            stop.Begin();
+            stop.End();
+        });
+        window.End();
+        run.ClickEvent([&]() { driver.Fire("run"); });
+        stop.ClickEvent([&]() { driver.Fire("stop"); });
+    };
+    driver.Run(2, frame);
+    IMGUI_EX_CHECK(driver.Find("Run", "Tools") != nullptr);
+    IMGUI_EX_CHECK(driver.Find("Run", "Other") == nullptr);
+
+    // Move, press, release: only the release frame reports the click
+    const int start = driver.GetFrame();
+    driver.Click("Run");
+    driver.Run(4, frame);
+    driver.ExpectNotFired("run", start);
+    driver.ExpectNotFired("run", start + 1);
+    driver.ExpectFired("run", start + 2);
+    driver.ExpectNotFired("run", start + 3);
+    IMGUI_EX_CHECK(driver.GetFireCount("run", start + 2) == 1);
+    for (int f = start; f < driver.GetFrame(); f++)
+        driver.ExpectNotFired("stop", f);
+
+    // Pressed on Run, released over Stop: neither clicks
+    const ImGuiEx::UiDriverItem* run_item = driver.Find("Run");
+    const ImGuiEx::UiDriverItem* stop_item = driver.Find("Stop");
+    IMGUI_EX_CHECK(run_item != nullptr && stop_item != nullptr);
+    if (run_item != nullptr && stop_item != nullptr)
+    {
+        driver.ClearFired();
+        const int drag = driver.GetFrame();
+        driver.MouseMove(run_item->rect.GetCenter());
+        driver.MouseButton(ImGuiMouseButton_Left, true, 1);
+        driver.MouseMove(stop_item->rect.GetCenter(), 2);
+        driver.MouseButton(ImGuiMouseButton_Left, false, 3);
+        driver.Run(5, frame);
+        for (int f = drag; f < driver.GetFrame(); f++)
+        {
+            driver.ExpectNotFired("run", f);
+            driver.ExpectNotFired("stop", f);
+        }
+    }
+
+    // Click() from code fires on the next frame, exactly once
+    driver.ClearFired();
+    run.Click();
+    const int control = driver.GetFrame();
+    driver.Run(2, frame);
+    driver.ExpectFired("run", control);
+    driver.ExpectNotFired("run", control + 1);
+    CheckDriver(driver);
+}
+
+static void TestWindowCreateClose()
+{
+    ImGuiEx::UiDriver driver;
+    ImGuiEx::Window window("Settings", false, false);
+    int close_updates = 0;
+    auto frame = [&]() {
+        window.Begin();
+        window.CreateEvent([&]() { driver.Fire("create"); });
+        window.CloseEvent([&]() { driver.Fire("close"); });
+        window.CloseUpdate([&]() { close_updates++; });
+        window.End();
+    };
+
+    // Not created yet: no edge, the window is not submitted
+    driver.Run(3, frame);
+    for (int f = 0; f < 3; f++)
+    {
+        driver.ExpectNotFired("create", f);
+        driver.ExpectNotFired("close", f);
+    }
+    IMGUI_EX_CHECK(close_updates == 3);
+    IMGUI_EX_CHECK(!window.GetCreate());
+
+    window.Create();
+    const int created = driver.GetFrame();
+    driver.Run(3, frame);
+    driver.ExpectFired("create", created);
+    IMGUI_EX_CHECK(driver.GetFireCount("create", created) == 1);
+    driver.ExpectNotFired("create", created + 1);
+    driver.ExpectNotFired("create", created + 2);
+    IMGUI_EX_CHECK(window.GetCreate());
+    IMGUI_EX_CHECK(close_updates == 3);
+
+    window.Close();
+    const int closed = driver.GetFrame();
+    driver.Run(3, frame);
+    driver.ExpectFired("close", closed);
+    driver.ExpectNotFired("close", closed + 1);
+    driver.ExpectNotFired("create", closed);
+    IMGUI_EX_CHECK(close_updates == 6);
+
+    // Edges on consecutive frames are reported one by one
+    window.Create();
+    driver.Step(frame);
+    window.Close();
+    driver.Step(frame);
+    driver.ExpectFired("create", closed + 3);
+    driver.ExpectFired("close", closed + 4);
+    CheckDriver(driver);
+}
+
+int main()
+{
+    IMGUI_EX_TEST(TestButtonClick);
+    IMGUI_EX_TEST(TestWindowCreateClose);
+    return TestExitCode();
+}